@@ -9,14 +9,21 @@ find_package(GTest)
 if(NOT GTEST_FOUND)
 	message(SEND_ERROR "GoogleTest is required")
 endif()
-# hacktile_add_test(${NAME} FILES ${FILES} LINKS ${LINKS})
-function(hacktile_add_test NAME)
-	# Collect and create test arguments.
+
+# Find Google Benchmark for benchmarking, and benchmarks
+# will be skipped if it is not found.
+find_package(benchmark QUIET)
+if(NOT benchmark_FOUND)
+	message(STATUS "Google Benchmark not found, skip benchmarks")
+endif()
+
+# hacktile_parse_target_args(${ARGN}) collects FILES and LINKS.
+macro(hacktile_parse_target_args)
 	set(CURRENT_FILES_STRIP 0)
 	set(FILES)
 	set(CURRENT_LINKS_STRIP 0)
 	set(LINKS)
-	foreach(arg IN LISTS ARGN)
+	foreach(arg IN ITEMS ${ARGN})
 		if("${arg}" STREQUAL "FILES")
 			set(CURRENT_FILES_STRIP 1)
 			set(CURRENT_LINKS_STRIP 0)
@@ -32,8 +39,27 @@ function(hacktile_add_test NAME)
 			return()
 		endif()
 	endforeach()
+endmacro()
+
+# hacktile_add_test(${NAME} FILES ${FILES} LINKS ${LINKS})
+function(hacktile_add_test NAME)
+	# Collect and create test arguments.
+	hacktile_parse_target_args(${ARGN})
 	add_executable(${NAME} ${FILES})
 	target_link_libraries(${NAME} GTest::GTest GTest::Main ${LINKS})
 	target_include_directories(${NAME} PRIVATE ${GTEST_INCLUDE_DIRS})
 	add_test(${NAME} ${NAME})
 endfunction()
+
+# hacktile_add_bench(${NAME} FILES ${FILES} LINKS ${LINKS})
+function(hacktile_add_bench NAME)
+	if(NOT benchmark_FOUND)
+		return()
+	endif()
+
+	# Collect and create benchmark arguments.
+	hacktile_parse_target_args(${ARGN})
+	add_executable(${NAME} ${FILES})
+	target_link_libraries(${NAME}
+		benchmark::benchmark benchmark::benchmark_main ${LINKS})
+endfunction()
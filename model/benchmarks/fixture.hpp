@@ -0,0 +1,72 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file fixture.hpp
+ * @brief common fixtures of the model benchmarks
+ *
+ * This file provides the tiles and fields used by the model
+ * benchmarks. The fields are filled with garbage lines of a
+ * single hole at deterministic locations, so that results
+ * are comparable between runs.
+ */
+#include "model/tile.hpp"
+#include "model/tetromino.hpp"
+#include <vector>
+
+namespace hacktile {
+namespace model {
+namespace bench {
+
+/// fieldFixture is the argument of the benchmarks to
+/// select the field to run on.
+enum fieldFixture {
+	emptyField = 0,
+	midStackField = 1,
+	nearTopOutField = 2,
+};
+
+/// createTetromino creates the tile of specified tetromino.
+inline tile createTetromino(tetromino typ) {
+	return tetrominoTile(typ);
+}
+
+/// createTetrominoes creates the tiles in the order of enum.
+inline std::vector<tile> createTetrominoes() {
+	std::vector<tile> tiles;
+	for(uint8_t i = 1; i <= 7; ++ i)
+		tiles.push_back(createTetromino(tetromino(i)));
+	return tiles;
+}
+
+/// fixtureHeight returns the number of rows in the field
+/// of the fixture. The spawn location (rows 17 to 20) is
+/// still empty in the field near top out.
+inline int fixtureHeight(int fixture) {
+	switch(fixture) {
+	case midStackField: return 8;
+	case nearTopOutField: return 16;
+	default: return 0;
+	}
+}
+
+/// growField adds the rows of the fixture to the bottom.
+inline void growField(field& f, int fixture) {
+	int numRows = fixtureHeight(fixture);
+	for(int i = 0; i < numRows; ++ i) {
+		fieldRow row;
+		row.fill(8);
+		row[(i * 7 + 3) % 10] = 0;
+		f.grow(row);
+	}
+}
+
+/// createField creates the field of the fixture.
+inline field createField(int fixture) {
+	field f;
+	growField(f, fixture);
+	return f;
+}
+
+} // namespace hacktile::model::bench
+} // namespace hacktile::model
+} // namespace hacktile
@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <benchmark/benchmark.h>
+#include "model/generator.hpp"
+#include "model/benchmarks/fixture.hpp"
+using namespace hacktile::model;
+using namespace hacktile::model::bench;
+
+// TilePermutatorGenerate generates tiles from permutator.
+template<typename permutator>
+static void TilePermutatorGenerate(benchmark::State& state) {
+	std::vector<tile> tiles = createTetrominoes();
+	std::vector<const tile*> pointers;
+	for(const tile& t : tiles) pointers.push_back(&t);
+	permutator generator(pointers.data(), pointers.size(), 0);
+	for(auto _ : state)
+		benchmark::DoNotOptimize(generator.generate());
+}
+BENCHMARK_TEMPLATE(TilePermutatorGenerate, tilePermutator);
+BENCHMARK_TEMPLATE(TilePermutatorGenerate, fastTilePermutator);
+
+// HistoryRollGenerate generates tiles from history roll.
+template<typename roll>
+static void HistoryRollGenerate(benchmark::State& state) {
+	std::vector<tile> tiles = createTetrominoes();
+	std::vector<const tile*> pointers;
+	for(const tile& t : tiles) pointers.push_back(&t);
+	size_t history[4] = { 3, 2, 3, 2 };
+	roll generator(pointers.data(), pointers.size(),
+		state.range(0), history, 4, 0);
+	for(auto _ : state)
+		benchmark::DoNotOptimize(generator.generate());
+}
+BENCHMARK_TEMPLATE(HistoryRollGenerate, historyRoll)->Arg(0)->Arg(4);
+BENCHMARK_TEMPLATE(HistoryRollGenerate, fastHistoryRoll)->Arg(0)->Arg(4);
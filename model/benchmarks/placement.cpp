@@ -0,0 +1,24 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <benchmark/benchmark.h>
+#include "model/placement.hpp"
+#include "model/benchmarks/fixture.hpp"
+#include <memory>
+using namespace hacktile::model;
+using namespace hacktile::model::bench;
+
+// PlacementSearch enumerates the placements of a T tile, the
+// number of placements per second is also reported.
+static void PlacementSearch(benchmark::State& state) {
+	tile t = createTetromino(tetromino::T);
+	field f = createField(state.range(0));
+	std::unique_ptr<placementFinder> finder(new placementFinder);
+	tilePathFinder pfd(&t);
+	f.spawn(pfd);
+	size_t numPlacements = 0;
+	for(auto _ : state)
+		numPlacements += finder->search(f, pfd);
+	state.counters["placements"] = benchmark::Counter(
+		numPlacements, benchmark::Counter::kIsRate);
+}
+BENCHMARK(PlacementSearch)
+	->Arg(emptyField)->Arg(midStackField)->Arg(nearTopOutField);
@@ -0,0 +1,237 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <benchmark/benchmark.h>
+#include "model/tile.hpp"
+#include "model/tetromino.hpp"
+#include "model/fieldops.hpp"
+#include "model/benchmarks/fixture.hpp"
+#include <algorithm>
+#include <vector>
+using namespace hacktile::model;
+using namespace hacktile::model::bench;
+
+// applyFixtures registers the benchmark with every field.
+static void applyFixtures(benchmark::internal::Benchmark* b) {
+	b->Arg(emptyField)->Arg(midStackField)->Arg(nearTopOutField);
+}
+
+// FieldSpawn spawns a tile at the initial location.
+static void FieldSpawn(benchmark::State& state) {
+	tile t = createTetromino(tetromino::T);
+	field f = createField(state.range(0));
+	for(auto _ : state) {
+		tilePathFinder pfd(&t);
+		benchmark::DoNotOptimize(f.spawn(pfd));
+		benchmark::DoNotOptimize(pfd);
+	}
+}
+BENCHMARK(FieldSpawn)->Apply(applyFixtures);
+
+// FieldMove moves the spawned tile by the steps.
+static void FieldMove(benchmark::State& state) {
+	tile t = createTetromino(tetromino::T);
+	field f = createField(state.range(0));
+	int8_t steps = int8_t(state.range(1));
+	tilePathFinder pfd(&t);
+	f.spawn(pfd);
+	for(auto _ : state) {
+		tilePathFinder result;
+		benchmark::DoNotOptimize(f.move(pfd, steps, result));
+		benchmark::DoNotOptimize(result);
+	}
+}
+BENCHMARK(FieldMove)->ArgsProduct({
+	{ emptyField, midStackField, nearTopOutField },
+	{ -1, +1, -10, +10 },
+});
+
+// FieldDrop drops the spawned tile to the bottom.
+static void FieldDrop(benchmark::State& state) {
+	tile t = createTetromino(tetromino::T);
+	field f = createField(state.range(0));
+	tilePathFinder pfd(&t);
+	f.spawn(pfd);
+	for(auto _ : state) {
+		tilePathFinder result;
+		benchmark::DoNotOptimize(f.drop(pfd, 20, result));
+		benchmark::DoNotOptimize(result);
+	}
+}
+BENCHMARK(FieldDrop)->Apply(applyFixtures);
+
+// FieldOpsDrop is FieldDrop specialized for the tile.
+static void FieldOpsDrop(benchmark::State& state) {
+	typedef pieceOps<tetrominoPiece<tetromino::T>> ops;
+	field f = createField(state.range(0));
+	tilePathFinder pfd(&tetrominoTile(tetromino::T));
+	f.spawn(pfd);
+	for(auto _ : state) {
+		tilePathFinder result;
+		benchmark::DoNotOptimize(ops::drop(f, pfd, 20, result));
+		benchmark::DoNotOptimize(result);
+	}
+}
+BENCHMARK(FieldOpsDrop)->Apply(applyFixtures);
+
+// FieldRotate rotates the spawned tile, which is always
+// possible without the rotation table.
+static void FieldRotate(benchmark::State& state) {
+	tile t = createTetromino(tetromino::T);
+	field f = createField(state.range(0));
+	tilePathFinder pfd(&t);
+	f.spawn(pfd);
+	for(auto _ : state) {
+		tilePathFinder result;
+		benchmark::DoNotOptimize(f.rotate(pfd,
+			enumTileDirection::right, result));
+		benchmark::DoNotOptimize(result);
+	}
+}
+BENCHMARK(FieldRotate)->Apply(applyFixtures);
+
+// FieldOpsRotate is FieldRotate specialized for the tile.
+static void FieldOpsRotate(benchmark::State& state) {
+	typedef pieceOps<tetrominoPiece<tetromino::T>> ops;
+	field f = createField(state.range(0));
+	tilePathFinder pfd(&tetrominoTile(tetromino::T));
+	f.spawn(pfd);
+	for(auto _ : state) {
+		tilePathFinder result;
+		benchmark::DoNotOptimize(ops::rotate(f, pfd,
+			enumTileDirection::right, result));
+		benchmark::DoNotOptimize(result);
+	}
+}
+BENCHMARK(FieldOpsRotate)->Apply(applyFixtures);
+
+// FieldRotateWallKick rotates the tile against the wall,
+// where the rotation table must be applied. The first case
+// succeeds at the first wall kick, while in the second case
+// the I tile inside a well cannot turn at all.
+static void FieldRotateWallKick(benchmark::State& state) {
+	bool fail = state.range(0) != 0;
+	tile t = createTetromino(fail? tetromino::I : tetromino::T);
+	field f;
+	tilePathFinder pfd(&t), result;
+	if(!fail) {
+		// The T-spin mini location of Tile.TSpinMini.
+		f.grow({0, 1, 1, 1, 1, 1, 1, 1, 1, 1});
+		f.spawn(pfd);
+		f.drop(pfd, 20, result); pfd = result;
+		f.move(pfd, -10, result); pfd = result;
+	} else {
+		for(int i = 0; i < 12; ++ i)
+			f.grow({0, 1, 1, 1, 1, 1, 1, 1, 1, 1});
+		f.spawn(pfd);
+		f.rotate(pfd, enumTileDirection::right, result); pfd = result;
+		f.move(pfd, -10, result); pfd = result;
+		f.drop(pfd, 20, result); pfd = result;
+	}
+	for(auto _ : state) {
+		benchmark::DoNotOptimize(f.rotate(pfd,
+			pfd.getState().dir.rotateCW(), result));
+		benchmark::DoNotOptimize(result);
+	}
+}
+BENCHMARK(FieldRotateWallKick)->Arg(0)->Arg(1);
+
+// FieldOpsRotateWallKick is FieldRotateWallKick specialized
+// for the tile, where the wall kicks are constants.
+template<tetromino typ>
+static void FieldOpsRotateWallKick(benchmark::State& state) {
+	typedef pieceOps<tetrominoPiece<typ>> ops;
+	bool fail = typ == tetromino::I;
+	field f;
+	tilePathFinder pfd(&tetrominoTile(typ)), result;
+	if(!fail) {
+		f.grow({0, 1, 1, 1, 1, 1, 1, 1, 1, 1});
+		f.spawn(pfd);
+		f.drop(pfd, 20, result); pfd = result;
+		f.move(pfd, -10, result); pfd = result;
+	} else {
+		for(int i = 0; i < 12; ++ i)
+			f.grow({0, 1, 1, 1, 1, 1, 1, 1, 1, 1});
+		f.spawn(pfd);
+		f.rotate(pfd, enumTileDirection::right, result); pfd = result;
+		f.move(pfd, -10, result); pfd = result;
+		f.drop(pfd, 20, result); pfd = result;
+	}
+	for(auto _ : state) {
+		benchmark::DoNotOptimize(ops::rotate(f, pfd,
+			pfd.getState().dir.rotateCW(), result));
+		benchmark::DoNotOptimize(result);
+	}
+}
+BENCHMARK_TEMPLATE(FieldOpsRotateWallKick, tetromino::T);
+BENCHMARK_TEMPLATE(FieldOpsRotateWallKick, tetromino::I);
+
+// FieldCopy copies the field, which is the baseline of the
+// benchmarks that must copy the field in each iteration.
+static void FieldCopy(benchmark::State& state) {
+	field f = createField(state.range(0));
+	for(auto _ : state) {
+		field g = f;
+		benchmark::DoNotOptimize(g);
+	}
+}
+BENCHMARK(FieldCopy)->Apply(applyFixtures);
+
+// FieldLock locks a vertical I tile into the well at the
+// leftmost column, clearing the specified number of lines.
+// The field is copied in each iteration (see FieldCopy).
+static void FieldLock(benchmark::State& state) {
+	int clears = state.range(1);
+	tile t = createTetromino(tetromino::I);
+	field f;
+	for(int i = 0; i < 4; ++ i) {
+		fieldRow row;
+		row.fill(8);
+		row[0] = 0;
+		if(i >= clears) row[5] = 0;
+		f.grow(row);
+	}
+	growField(f, state.range(0));
+
+	// The vertical I tile occupies the column 3 and the
+	// rows 1 to 4 inside its 6x6 square.
+	tileState location;
+	location.dir = enumTileDirection::right;
+	location.x = -3;
+	location.y = fixtureHeight(state.range(0)) - 1;
+	tilePathFinder pfd(&t, location);
+	if(!f.spawn(pfd)) state.SkipWithError("cannot place tile");
+	for(auto _ : state) {
+		field g = f;
+		uint8_t clear;
+		benchmark::DoNotOptimize(g.lock(pfd, clear));
+		benchmark::DoNotOptimize(g);
+		if(clear != clears) state.SkipWithError("mismatched clears");
+	}
+}
+BENCHMARK(FieldLock)->ArgsProduct({
+	{ emptyField, midStackField, nearTopOutField },
+	{ 0, 1, 2, 3, 4 },
+});
+
+// FieldGrow adds garbage lines to the fields, each of which
+// grows 4 rows so that it stays below the spawn location.
+// The fields are grown in batches and reset between batches
+// outside the timing, so each iteration is a single row.
+static void FieldGrow(benchmark::State& state) {
+	const int rowsPerField = 4;
+	const int numFields = 256;
+	field initial = createField(state.range(0));
+	std::vector<field> fields(numFields, initial);
+	fieldRow row;
+	row.fill(8);
+	row[4] = 0;
+	while(state.KeepRunningBatch(numFields * rowsPerField)) {
+		for(field& f : fields)
+			for(int i = 0; i < rowsPerField; ++ i) f.grow(row);
+		benchmark::DoNotOptimize(fields.data());
+		state.PauseTiming();
+		std::fill(fields.begin(), fields.end(), initial);
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(FieldGrow)->Apply(applyFixtures);
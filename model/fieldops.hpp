@@ -0,0 +1,294 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file fieldops.hpp
+ * @brief field operations specialized for each piece
+ * @author aegistudio
+ *
+ * This file provides the field operations instantiated for
+ * the pieces whose shapes are known at compile time, so that
+ * the bounding boxes, masks, bottoms and wall kicks are all
+ * materialized as constant tables of each direction rather
+ * than loaded through the tile. Only drop and rotate are
+ * specialized, where the constant tables pay off.
+ *
+ * The operations behave exactly as the ones of the field,
+ * and could be mixed with them on the same path finder. The
+ * tile of the path finder must have the shape of the piece.
+ * Custom tiles should keep using the generic field methods.
+ */
+#include "model/tile.hpp"
+#include "model/tetromino.hpp"
+#include "model/pentomino.hpp"
+#include <array>
+#include <climits>
+
+namespace hacktile {
+namespace model {
+
+/**
+ * @brief tetrominoPiece is the piece of the tetromino, which
+ * provides the shape to specialize the operations with.
+ */
+template<tetromino typ>
+struct tetrominoPiece {
+	/// shape returns the shape of the piece.
+	static constexpr const tileShape& shape() {
+		return tetrominoTable::shapes[uint8_t(typ) - 1];
+	}
+
+	/// type returns the tile of the piece.
+	static const tile& type() {
+		return tetrominoTile(typ);
+	}
+};
+
+/**
+ * @brief pentominoPiece is the piece of the pentomino, which
+ * provides the shape to specialize the operations with.
+ */
+template<pentomino typ>
+struct pentominoPiece {
+	/// shape returns the shape of the piece.
+	static constexpr const tileShape& shape() {
+		return pentominoTable::shapes[uint8_t(typ) - 1];
+	}
+
+	/// type returns the tile of the piece.
+	static const tile& type() {
+		return pentominoTile(typ);
+	}
+};
+
+/**
+ * @brief fieldOps is the field operations of the piece in
+ * the direction.
+ */
+template<typename piece, int dir>
+struct fieldOps {
+	/// mask is the compact tile in the direction.
+	static constexpr uint64_t mask = piece::shape().compactOf(dir);
+
+	/// minX, minY, maxX and maxY are the bounding box.
+	static constexpr int minX = piece::shape().extremeOf(dir, false, false);
+	static constexpr int minY = piece::shape().extremeOf(dir, true, false);
+	static constexpr int maxX = piece::shape().extremeOf(dir, false, true);
+	static constexpr int maxY = piece::shape().extremeOf(dir, true, true);
+
+	/// bottoms are the lowest pixel of each column, or -1 if
+	/// the column is empty.
+	static constexpr std::array<int8_t, 6> bottoms =
+		piece::shape().bottomsOf(dir, makeTileIndices<6>::type());
+
+	/// kicks are the wall kicks towards each direction, which
+	/// terminate at the first empty kick.
+	static constexpr std::array<std::array<uint8_t,
+		tile::maxNumRotations>, 4> kicks = piece::shape().rotationsOf(
+			dir, makeTileIndices<4>::type(),
+			makeTileIndices<tile::maxNumRotations>::type());
+
+	/// maskAt returns the compact tile moved to the column.
+	static compactField maskAt(int8_t x) {
+		return compactField(mask).tileMove(x);
+	}
+
+	/// isValid judges whether the tile could be at the
+	/// location with the window of the row.
+	static bool isValid(compactField window, int8_t x, int8_t y) {
+		if(x + minX < 0 || x + maxX >= 10) return false;
+		if(y + maxY < 0) return false;
+		return !window.collide(maskAt(x));
+	}
+
+	/// drop is the specialized field::drop.
+	static bool drop(const field& f, const tilePathFinder& pfd,
+		uint8_t numSteps, tilePathFinder& result) {
+		f.assertLegit(pfd);
+		result = tilePathFinder();
+		tileState state = pfd.state;
+
+		// Land on the skyline when every column of the tile
+		// is above it, where the empty columns are folded.
+		bool aboveSkyline = true;
+		int landing = INT_MIN;
+		for(int c = 0; c < 6; ++ c) {
+			int b = bottoms[c];
+			if(b < 0) continue;
+			int height = f.heights[state.x + c];
+			if(state.y + b < height) {
+				aboveSkyline = false;
+				break;
+			}
+			landing = std::max(landing, height - b);
+		}
+		if(aboveSkyline) {
+			int target = std::max(landing, state.y - numSteps);
+			if(target >= state.y) return false;
+			result = tilePathFinder(pfd.typ, state);
+			result.state.y = target;
+			result.current = f.compactWindowAt(target);
+			f.envalidate(result);
+			return true;
+		}
+
+		// Move one line at a time otherwise.
+		result = tilePathFinder(pfd.typ, state);
+		result.current = pfd.current;
+		uint8_t inSteps = numSteps;
+		compactField tile = maskAt(state.x);
+		while(numSteps > 0) {
+			compactField current = result.current.fieldDown(
+				f.compactRowAt(result.state.y - 1));
+			if(current.collide(tile)) break;
+			-- result.state.y;
+			result.current = current;
+			-- numSteps;
+		}
+		if(inSteps == numSteps) {
+			result = tilePathFinder();
+			return false;
+		}
+		f.envalidate(result);
+		return true;
+	}
+
+	/// rotate is the specialized field::rotate towards the
+	/// target direction.
+	template<int target>
+	static bool rotate(const field& f, const tilePathFinder& pfd,
+		tilePathFinder& result) {
+		typedef fieldOps<piece, target> targetOps;
+		f.assertLegit(pfd);
+		tileState state = pfd.state;
+		result = tilePathFinder(pfd.typ, state);
+		result.state.dir = tileDirection(target);
+		result.current = pfd.current;
+		result.previousRotation = true;
+		if(targetOps::isValid(result.current, state.x, state.y)) {
+			f.envalidate(result);
+			return true;
+		}
+
+		// Apply the wall kicks, which are constants and the
+		// loop terminates at the first empty kick.
+		for(int n = 0; n < tile::maxNumRotations; ++ n) {
+			uint8_t value = kicks[target][n];
+			if(value == 0) break;
+			result.state.x = state.x + tileCoordX(value);
+			int8_t newStateY = state.y + tileCoordY(value);
+			if(result.state.y != newStateY) {
+				result.current = f.compactWindowAt(newStateY);
+				result.state.y = newStateY;
+			}
+			if(targetOps::isValid(result.current,
+				result.state.x, result.state.y)) {
+				result.previousKick = value;
+				f.envalidate(result);
+				return true;
+			}
+		}
+		result = tilePathFinder();
+		return false;
+	}
+}; // struct hacktile::model::fieldOps
+
+template<typename piece, int dir>
+constexpr uint64_t fieldOps<piece, dir>::mask;
+template<typename piece, int dir>
+constexpr int fieldOps<piece, dir>::minX;
+template<typename piece, int dir>
+constexpr int fieldOps<piece, dir>::minY;
+template<typename piece, int dir>
+constexpr int fieldOps<piece, dir>::maxX;
+template<typename piece, int dir>
+constexpr int fieldOps<piece, dir>::maxY;
+template<typename piece, int dir>
+constexpr std::array<int8_t, 6> fieldOps<piece, dir>::bottoms;
+template<typename piece, int dir>
+constexpr std::array<std::array<uint8_t, tile::maxNumRotations>, 4>
+	fieldOps<piece, dir>::kicks;
+
+/**
+ * @brief pieceOps dispatches the operations of the piece to
+ * the fieldOps of the direction of the path finder.
+ */
+template<typename piece>
+struct pieceOps {
+	/// move is field::move, since stepping the tile over the
+	/// row is as fast with the tables loaded from the tile.
+	static bool move(const field& f, const tilePathFinder& pfd,
+		int8_t numSteps, tilePathFinder& result) {
+		return f.move(pfd, numSteps, result);
+	}
+
+	/// drop is the specialized field::drop.
+	static bool drop(const field& f, const tilePathFinder& pfd,
+		uint8_t numSteps, tilePathFinder& result) {
+		switch(pfd.getState().dir.getValue()) {
+		case 0: return fieldOps<piece, 0>::drop(f, pfd, numSteps, result);
+		case 1: return fieldOps<piece, 1>::drop(f, pfd, numSteps, result);
+		case 2: return fieldOps<piece, 2>::drop(f, pfd, numSteps, result);
+		default: return fieldOps<piece, 3>::drop(f, pfd, numSteps, result);
+		}
+	}
+
+	/// rotate is the specialized field::rotate.
+	static bool rotate(const field& f, const tilePathFinder& pfd,
+		tileDirection targetDir, tilePathFinder& result) {
+		switch(pfd.getState().dir.getValue()) {
+		case 0: return rotateFrom<0>(f, pfd, targetDir, result);
+		case 1: return rotateFrom<1>(f, pfd, targetDir, result);
+		case 2: return rotateFrom<2>(f, pfd, targetDir, result);
+		default: return rotateFrom<3>(f, pfd, targetDir, result);
+		}
+	}
+private:
+	// rotateFrom dispatches the rotation by the target.
+	template<int dir>
+	static bool rotateFrom(const field& f, const tilePathFinder& pfd,
+		tileDirection targetDir, tilePathFinder& result) {
+		typedef fieldOps<piece, dir> ops;
+		switch(targetDir.getValue()) {
+		case 0: return ops::template rotate<0>(f, pfd, result);
+		case 1: return ops::template rotate<1>(f, pfd, result);
+		case 2: return ops::template rotate<2>(f, pfd, result);
+		default: return ops::template rotate<3>(f, pfd, result);
+		}
+	}
+}; // struct hacktile::model::pieceOps
+
+/**
+ * visitTetromino invokes visitor.visit<tetrominoPiece<...>>()
+ * with the tetromino of the tile, and returns false without
+ * invoking the visitor if the tile is not a tetromino in the
+ * tetrominoTable, so that the caller could dispatch once and
+ * run with the specialized operations.
+ */
+template<typename visitorType>
+bool visitTetromino(const tile* typ, visitorType& visitor) {
+	int index = -1;
+	for(int i = 0; i < 7; ++ i)
+		if(typ == &tetrominoTable::tiles[i]) index = i + 1;
+	switch(tetromino(index)) {
+	case tetromino::J:
+		visitor.template visit<tetrominoPiece<tetromino::J>>(); break;
+	case tetromino::L:
+		visitor.template visit<tetrominoPiece<tetromino::L>>(); break;
+	case tetromino::S:
+		visitor.template visit<tetrominoPiece<tetromino::S>>(); break;
+	case tetromino::Z:
+		visitor.template visit<tetrominoPiece<tetromino::Z>>(); break;
+	case tetromino::T:
+		visitor.template visit<tetrominoPiece<tetromino::T>>(); break;
+	case tetromino::I:
+		visitor.template visit<tetrominoPiece<tetromino::I>>(); break;
+	case tetromino::O:
+		visitor.template visit<tetrominoPiece<tetromino::O>>(); break;
+	default:
+		return false;
+	}
+	return true;
+}
+
+} // namespace hacktile::model
+} // namespace hacktile
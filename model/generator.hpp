@@ -9,10 +9,16 @@
  * providing tiles mainly for the playground. It also provides
  * the well known implementation known as permutator, which always
  * select tiles from a set of tiles and return it to caller.
+ *
+ * The generators are parameterized by the randomizer, and the
+ * ones with mt19937 are bit compatible with the games seeded
+ * before, while the fast ones have a much smaller state.
  */
 #include "model/tile.hpp"
+#include "model/random.hpp"
 #include <memory>
 #include <deque>
+#include <functional>
 
 namespace hacktile {
 namespace model {
@@ -31,35 +37,118 @@ struct tileGenerator {
 	/// generated has been used up, playground will generate
 	/// an tileExhaustEvent.
 	virtual const tile* generate() = 0;
+
+	/// generateN generates the next tiles into the result,
+	/// and returns the number of tiles generated, which is
+	/// less than n only if the tiles are exhausted.
+	///
+	/// The generators override it to generate in bulk, so
+	/// that the virtual dispatch is paid once per batch.
+	virtual size_t generateN(const tile* result[], size_t n);
+
+	/// peek returns the i-th tile to be generated without
+	/// generating it, or nullptr if the generator could not
+	/// tell it in advance or the tiles are exhausted by then.
+	virtual const tile* peek(size_t) {
+		return nullptr;
+	}
+
+	/// stateSize returns the number of bytes required to
+	/// save the state of the generator.
+	virtual size_t stateSize() const = 0;
+
+	/// saveState copies the state of the generator into
+	/// the buffer, which is aligned to 8 bytes.
+	virtual void saveState(void*) const = 0;
+
+	/// restoreState reverts the generator to the state
+	/// saved by the same generator.
+	virtual void restoreState(const void*) = 0;
+};
+
+/// tileSequenceVisitor receives each possible sequence of the
+/// next tiles enumerated, with the probability of generating it.
+typedef std::function<void(const tile* const sequence[],
+	size_t length, double probability)> tileSequenceVisitor;
+
+/**
+ * @brief tileBag is the state of the bag of the permutator that
+ * the players could tell from the tiles generated so far.
+ *
+ * The tiles are identified by their indices in the tiles that
+ * are permuted, so that the bag is at most 64 tiles.
+ */
+struct tileBag {
+	/// remaining is the bits of tiles left in current bag.
+	uint64_t remaining;
+
+	/// numRemaining is the number of tiles left in current bag.
+	size_t numRemaining;
+
+	/// bagSize is the number of tiles in each bag.
+	size_t bagSize;
 };
 
 /**
- * @brief tilePermutator is a tile generator that randomize all
- * tiles but ensures that all tiles appears in the next series.
+ * @brief basicTilePermutator is a tile generator that randomize
+ * all tiles but ensures that all tiles appears in the next series.
  *
- * The tilePermutator has a pseudo randomizer imbued inside and
+ * The permutator has a pseudo randomizer imbued inside and
  * given the same seed it and input series, it will always yield
  * the same result.
  */
-class tilePermutator : public tileGenerator {
+template<typename randomizer>
+class basicTilePermutator : public tileGenerator {
 	std::unique_ptr<const tile*[]> series;
+	std::unique_ptr<const tile*[]> tiles;
 	size_t numTiles;
 	int pointer;
-	char workData[5000];
+	randomizer rng;
 	void permutate();
 public:
 	/// default constructor for the permutator.
-	tilePermutator(const tile* tiles[], size_t numTiles, uint64_t seed);
+	basicTilePermutator(const tile* const tiles[],
+		size_t numTiles, uint64_t seed);
 
 	/// virtual destructor for the permutator.
-	virtual ~tilePermutator();
+	virtual ~basicTilePermutator();
 
 	/// generate method implementation of permutator.
 	virtual const tile* generate();
+	virtual size_t generateN(const tile* result[], size_t n);
+
+	/// getBag returns the tiles left in current bag, and
+	/// throws std::length_error if the bag is over 64 tiles.
+	tileBag getBag() const;
+
+	/// enumerate visits every possible sequence of the next k
+	/// tiles, which are the orders of the tiles left in current
+	/// bag followed by the orders of the new bags, and returns
+	/// the number of sequences visited.
+	///
+	/// The sequences less likely than minProbability are pruned,
+	/// and the sequences of the same tiles at different indices
+	/// are visited separately.
+	size_t enumerate(size_t k, const tileSequenceVisitor& visitor,
+		double minProbability = 0.0) const;
+
+	/// state snapshot implementation of permutator.
+	virtual size_t stateSize() const;
+	virtual void saveState(void*) const;
+	virtual void restoreState(const void*);
 };
 
+/// tilePermutator is the permutator with mt19937.
+typedef basicTilePermutator<mt19937Randomizer> tilePermutator;
+
+/// fastTilePermutator is the permutator with xoshiro256.
+typedef basicTilePermutator<xoshiroRandomizer> fastTilePermutator;
+
+extern template class basicTilePermutator<mt19937Randomizer>;
+extern template class basicTilePermutator<xoshiroRandomizer>;
+
 /**
- * @brief historyRoll is a tile generator that will randomly pick a piece
+ * @brief basicHistoryRoll is a tile generator that will randomly pick a piece
  * and try keeping the new piece different from the older ones.
  * 
  * It will remember `historySize` pieces, and retry `retryTimes` times before
@@ -70,7 +159,8 @@ public:
  * Currently we think `A1` and `A2` are different, but if we change `history`
  * into `tiles *`, `A1` and `A2` will be treated as the same pieces.
  */
-class historyRoll: public tileGenerator {
+template<typename randomizer>
+class basicHistoryRoll: public tileGenerator {
 	std::deque<std::size_t> history;
 	std::unique_ptr<std::size_t[]> counts;
 	// TODO: in fact only a readable *constant* copy of tiles is needed,
@@ -79,7 +169,7 @@ class historyRoll: public tileGenerator {
 	std::unique_ptr<const tile*[]> tiles;
 	std::size_t numTiles;
 	const std::size_t retryTimes, historySize;
-	char workData[5000];
+	randomizer rng;
 public:
 	/**
 	 * @brief Construct a new history Roll object
@@ -94,15 +184,47 @@ public:
 	 * @param historySize size of history
 	 * @param seed seed for the random number generator
 	 */
-	historyRoll(
-		const tile* tiles_[], std::size_t numTiles,
+	basicHistoryRoll(
+		const tile* const tiles_[], std::size_t numTiles,
 		std::size_t retryTimes, std::size_t* initialHistory,
 		std::size_t historySize, uint64_t seed);
 
-	~historyRoll() override;
+	~basicHistoryRoll() override;
 
 	const tile* generate() override;
+	size_t generateN(const tile* result[], size_t n) override;
+
+	/// getHistory returns the indices of tiles in history,
+	/// from oldest to newest.
+	const std::deque<std::size_t>& getHistory() const {
+		return history;
+	}
+
+	/// getProbabilities evaluates the probability of each
+	/// tile being the next tile, by the indices of tiles.
+	void getProbabilities(double probabilities[]) const;
+
+	/// enumerate visits every possible sequence of the next k
+	/// tiles by replaying the rolls against the history, and
+	/// returns the number of sequences visited.
+	///
+	/// The sequences less likely than minProbability are pruned.
+	size_t enumerate(size_t k, const tileSequenceVisitor& visitor,
+		double minProbability = 0.0) const;
+
+	size_t stateSize() const override;
+	void saveState(void*) const override;
+	void restoreState(const void*) override;
 };
 
+/// historyRoll is the history roll with mt19937.
+typedef basicHistoryRoll<mt19937Randomizer> historyRoll;
+
+/// fastHistoryRoll is the history roll with xoshiro256.
+typedef basicHistoryRoll<xoshiroRandomizer> fastHistoryRoll;
+
+extern template class basicHistoryRoll<mt19937Randomizer>;
+extern template class basicHistoryRoll<xoshiroRandomizer>;
+
 } // namespace hacktile::model
 } // namespace hacktile
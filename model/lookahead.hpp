@@ -0,0 +1,66 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file lookahead.hpp
+ * @brief ring buffered lookahead of tile generator
+ * @author aegistudio
+ *
+ * This file provides the lookahead adapter of the generators,
+ * which generates the tiles of the underlying generator in
+ * batches into a ring buffer, so that the tiles could be
+ * peeked arbitrarily far before they're generated.
+ */
+#include "model/generator.hpp"
+#include <vector>
+
+namespace hacktile {
+namespace model {
+
+/**
+ * @brief tileLookahead is the tile generator generating the
+ * same tiles as the underlying generator, with the tiles
+ * generated in advance buffered in the ring.
+ *
+ * The ring grows to hold the farthest tile peeked, and the
+ * underlying generator is advanced by at least the batch
+ * size each time the ring runs out, so both the virtual
+ * dispatch and the randomizer are paid once per batch.
+ *
+ * The underlying generator must outlive the lookahead, and
+ * must not be used by others.
+ */
+class tileLookahead : public tileGenerator {
+	tileGenerator* source;
+	size_t batchSize;
+
+	// The ring of tiles generated in advance, whose capacity
+	// is always a power of 2, and the range of tiles buffered.
+	std::vector<const tile*> ring;
+	size_t head, count;
+
+	// fill generates at least n tiles into the ring, and
+	// returns false if the tiles are exhausted before.
+	bool fill(size_t n);
+public:
+	/// tileLookahead creates the lookahead of the generator,
+	/// advancing the generator by the batch size at least.
+	tileLookahead(tileGenerator* source, size_t batchSize = 256);
+
+	/// getNumBuffered returns the number of tiles buffered.
+	size_t getNumBuffered() const {
+		return count;
+	}
+
+	virtual const tile* generate() override;
+	virtual size_t generateN(const tile* result[], size_t n) override;
+	virtual const tile* peek(size_t i) override;
+
+	/// The state of the lookahead is the tiles buffered and
+	/// the state of the underlying generator.
+	virtual size_t stateSize() const override;
+	virtual void saveState(void*) const override;
+	virtual void restoreState(const void*) override;
+}; // class hacktile::model::tileLookahead
+
+} // namespace hacktile::model
+} // namespace hacktile
@@ -0,0 +1,240 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file pentomino.hpp
+ * @brief pentomino specific definition
+ * @author aegistudio
+ *
+ * This file provides definitions dedicated for pentomino,
+ * whose tiles are generated at compile time. The tiles are
+ * rotated around the center of the 6x6 square, so that all
+ * of their pixels remain inside the square.
+ */
+#include "model/tile.hpp"
+#include "model/tetromino.hpp"
+
+namespace hacktile {
+namespace model {
+
+/**
+ * @brief pentomino is the enumeration of all one-sided
+ * pentominoes, and the reflected ones are suffixed by R.
+ */
+enum class pentomino : uint8_t {
+	F = 1,
+	FR,
+	I,
+	L,
+	LR,
+	N,
+	NR,
+	P,
+	PR,
+	T,
+	U,
+	V,
+	W,
+	X,
+	Y,
+	YR,
+	Z,
+	ZR,
+};
+
+/**
+ * @brief pentominoTable is the tables of the pentominoes,
+ * from which the tiles are generated at compile time.
+ *
+ * There's no standard rotation system of the pentominoes,
+ * so they share the wall kicks of the 3x3 tetrominoes.
+ */
+struct pentominoTable {
+	/// shapes are the shapes of the pentominoes in the
+	/// order of the enum.
+	static constexpr tileShape shapes[18] = {
+		// pentomino::F
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 1, 1, 0 },
+			{ 0, 0, 1, 1, 0, 0 },
+			{ 0, 0, 0, 1, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 6, uint8_t(pentomino::F), tetrominoTable::kicks3x3, {} },
+		// pentomino::FR
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 1, 1, 0, 0 },
+			{ 0, 0, 0, 1, 1, 0 },
+			{ 0, 0, 0, 1, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 6, uint8_t(pentomino::FR), tetrominoTable::kicks3x3, {} },
+		// pentomino::I
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 1, 1, 1, 1, 1 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 6, uint8_t(pentomino::I), tetrominoTable::kicks3x3, {} },
+		// pentomino::L
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 1, 0 },
+			{ 0, 1, 1, 1, 1, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 6, uint8_t(pentomino::L), tetrominoTable::kicks3x3, {} },
+		// pentomino::LR
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 1, 0, 0, 0, 0 },
+			{ 0, 1, 1, 1, 1, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 6, uint8_t(pentomino::LR), tetrominoTable::kicks3x3, {} },
+		// pentomino::N
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 1, 1, 0, 0, 0 },
+			{ 0, 0, 1, 1, 1, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 6, uint8_t(pentomino::N), tetrominoTable::kicks3x3, {} },
+		// pentomino::NR
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 1, 1, 0 },
+			{ 0, 1, 1, 1, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 6, uint8_t(pentomino::NR), tetrominoTable::kicks3x3, {} },
+		// pentomino::P
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 1, 1, 0, 0 },
+			{ 0, 0, 1, 1, 0, 0 },
+			{ 0, 0, 1, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 6, uint8_t(pentomino::P), tetrominoTable::kicks3x3, {} },
+		// pentomino::PR
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 1, 1, 0, 0 },
+			{ 0, 0, 1, 1, 0, 0 },
+			{ 0, 0, 0, 1, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 6, uint8_t(pentomino::PR), tetrominoTable::kicks3x3, {} },
+		// pentomino::T
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 1, 1, 1, 0 },
+			{ 0, 0, 0, 1, 0, 0 },
+			{ 0, 0, 0, 1, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 6, uint8_t(pentomino::T), tetrominoTable::kicks3x3, {} },
+		// pentomino::U
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 1, 0, 1, 0 },
+			{ 0, 0, 1, 1, 1, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 6, uint8_t(pentomino::U), tetrominoTable::kicks3x3, {} },
+		// pentomino::V
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 1, 0, 0, 0 },
+			{ 0, 0, 1, 0, 0, 0 },
+			{ 0, 0, 1, 1, 1, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 6, uint8_t(pentomino::V), tetrominoTable::kicks3x3, {} },
+		// pentomino::W
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 1, 0, 0, 0 },
+			{ 0, 0, 1, 1, 0, 0 },
+			{ 0, 0, 0, 1, 1, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 6, uint8_t(pentomino::W), tetrominoTable::kicks3x3, {} },
+		// pentomino::X
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 1, 0, 0 },
+			{ 0, 0, 1, 1, 1, 0 },
+			{ 0, 0, 0, 1, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 6, uint8_t(pentomino::X), tetrominoTable::kicks3x3, {} },
+		// pentomino::Y
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 1, 0, 0 },
+			{ 0, 1, 1, 1, 1, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 6, uint8_t(pentomino::Y), tetrominoTable::kicks3x3, {} },
+		// pentomino::YR
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 1, 0, 0, 0 },
+			{ 0, 1, 1, 1, 1, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 6, uint8_t(pentomino::YR), tetrominoTable::kicks3x3, {} },
+		// pentomino::Z
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 1, 1, 0, 0 },
+			{ 0, 0, 0, 1, 0, 0 },
+			{ 0, 0, 0, 1, 1, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 6, uint8_t(pentomino::Z), tetrominoTable::kicks3x3, {} },
+		// pentomino::ZR
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 1, 1, 0 },
+			{ 0, 0, 0, 1, 0, 0 },
+			{ 0, 0, 1, 1, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 6, uint8_t(pentomino::ZR), tetrominoTable::kicks3x3, {} },
+	};
+
+	/// tiles are the pentominoes generated from the shapes,
+	/// in the order of the enum.
+	static constexpr tile tiles[18] = {
+		tile(shapes[0]), tile(shapes[1]), tile(shapes[2]),
+		tile(shapes[3]), tile(shapes[4]), tile(shapes[5]),
+		tile(shapes[6]), tile(shapes[7]), tile(shapes[8]),
+		tile(shapes[9]), tile(shapes[10]), tile(shapes[11]),
+		tile(shapes[12]), tile(shapes[13]), tile(shapes[14]),
+		tile(shapes[15]), tile(shapes[16]), tile(shapes[17]),
+	};
+}; // struct hacktile::model::pentominoTable
+
+/**
+ * pentominoTile returns the tile of the pentomino, which
+ * is generated at compile time and requires no setup.
+ */
+inline const tile& pentominoTile(pentomino typ) {
+	return pentominoTable::tiles[uint8_t(typ) - 1];
+}
+
+} // namespace hacktile::model
+} // namespace hacktile
@@ -0,0 +1,163 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file placement.hpp
+ * @brief reachable placement enumeration of a tile
+ * @author aegistudio
+ *
+ * This file provides the placement finder, which performs a
+ * breadth first search over every (x, y, direction) state a
+ * tile could reach in the field through the inputs accepted
+ * by the playground, and reports every distinct placement
+ * that the tile could be locked at, together with the
+ * shortest input path leading to it.
+ *
+ * The finder evaluates the same compact field collision and
+ * rotation table as hacktile::model::field does, so a path
+ * replayed through field::move, field::drop and field::rotate
+ * will always end up at the reported placement.
+ */
+#include "model/tile.hpp"
+
+namespace hacktile {
+namespace model {
+
+/**
+ * @brief tileInput is the elementary input that could be
+ * applied on a tile, each corresponds to a single call to
+ * the hacktile::model::playground.
+ */
+enum class tileInput : uint8_t {
+	moveLeft,  // playground::move(-1)
+	moveRight, // playground::move(+1)
+	rotateCW,  // playground::rotateCW()
+	rotateCCW, // playground::rotateCCW()
+	halfTurn,  // playground::halfTurn()
+	dropOne,   // playground::drop(1)
+	softDrop,  // playground::drop(20)
+};
+
+/**
+ * @brief tilePlacement is a lockable state of the tile that
+ * has been found by the placement finder.
+ */
+struct tilePlacement {
+	/// state is where the tile will be locked at.
+	tileState state;
+
+	/// node is the internal search node of the placement,
+	/// which is used to retrieve the input path.
+	uint16_t node;
+
+	/// numInputs is the length of the shortest input path.
+	uint16_t numInputs;
+
+	/// wallKick indicates the last input of the path is a
+	/// rotation that has applied the rotation table.
+	bool wallKick;
+};
+
+/**
+ * @brief placementFinder enumerates every distinct lockable
+ * placement of a tile in the field.
+ *
+ * All working memory is held inside the finder, so that
+ * the same instance could be reused for consecutive searches
+ * without any allocation. The finder is quite large (tens of
+ * kilobytes) and is intended to be reused by bots.
+ *
+ * Placements occupying the same cells are considered the
+ * same (e.g. all directions of tetromino::O), and only the
+ * one with the shortest input path will be reported.
+ */
+class placementFinder {
+public:
+	/// minX and minY are the smallest coordinates of the
+	/// tile state that could be searched.
+	static constexpr int minX = -6, minY = -8;
+
+	/// numColumns and numRows are the extent of the tile
+	/// state coordinates that could be searched.
+	static constexpr int numColumns = 16, numRows = 64;
+
+	/// numNodes is the number of possible search states.
+	static constexpr int numNodes = numRows * numColumns * 4;
+private:
+	// Search context of the current tile.
+	const tile* typ;
+	int8_t lowX[4], highX[4], lowY[4];
+	int8_t canonicalDir[4], canonicalX[4], canonicalY[4];
+	compactField masks[4][numColumns];
+	compactField windows[numRows];
+
+	// Visited and placed states are stored in flat bitset,
+	// while the path is stored as parent link of each node.
+	uint64_t visited[numNodes / 64];
+	uint64_t placed[numNodes / 64];
+	uint16_t parent[numNodes];
+	uint16_t depth[numNodes];
+	tileInput input[numNodes];
+	bool kicked[numNodes];
+	uint16_t queue[numNodes];
+
+	// The lowest row that the tile could drop to from the
+	// state, which is evaluated on demand while searching.
+	int8_t landing[numNodes];
+
+	// The placements found in the previous search.
+	size_t numPlacements;
+	tilePlacement placements[numNodes];
+
+	/// prepare initializes the search context of the tile.
+	void prepare(const field&, const tile*);
+
+	/// isValid judges whether the tile could be at state.
+	bool isValid(int8_t x, int8_t y, uint8_t dir) const;
+
+	/// visit attempts to mark the state as visited and
+	/// pushes it into the search queue.
+	void visit(int8_t x, int8_t y, uint8_t dir, uint16_t from,
+		tileInput how, bool wallKick, size_t& tail);
+
+	/// land evaluates the lowest row that the tile could
+	/// drop to from the (valid) state.
+	int8_t land(int8_t x, int8_t y, uint8_t dir);
+
+	/// rotate evaluates the state after applying rotation
+	/// table, returning whether the rotation is possible.
+	bool rotate(int8_t& x, int8_t& y, uint8_t srcDir,
+		uint8_t dstDir, bool& wallKick) const;
+public:
+	/// placementFinder creates an empty placement finder.
+	placementFinder(): typ(nullptr), numPlacements(0) {}
+
+	/// search enumerates all placements reachable from the
+	/// state of the (spawned) path finder in the field,
+	/// and returns the number of placements found.
+	size_t search(const field&, const tilePathFinder&);
+
+	/// getNumPlacements returns the number of placements
+	/// found in the previous search.
+	size_t getNumPlacements() const {
+		return numPlacements;
+	}
+
+	/// getPlacement returns the placement at index.
+	const tilePlacement& getPlacement(size_t i) const {
+		return placements[i];
+	}
+
+	/// retrievePath retrieves the shortest input path
+	/// to the placement into the buffer, and returns the
+	/// length of the path. The buffer must be able to hold
+	/// placement.numInputs inputs.
+	size_t retrievePath(const tilePlacement&, tileInput rinput[]) const;
+
+	/// isPlaced returns whether the tile could be locked at
+	/// the state, or a state occupying the same cells, in
+	/// the previous search.
+	bool isPlaced(const tileState&) const;
+}; // class hacktile::model::placementFinder
+
+} // namespace hacktile::model
+} // namespace hacktile
@@ -12,6 +12,8 @@
 #include "util/event.hpp"
 #include "model/tile.hpp"
 #include "model/generator.hpp"
+#include "model/placement.hpp"
+#include "model/snapshot.hpp"
 #include <memory>
 
 namespace hacktile {
@@ -58,6 +60,10 @@ struct tileLockEvent {
 	const tile& type;
 	tileState location;
 	uint8_t clear;
+
+	/// spin is the kind of spin that the tile is locked
+	/// with, classified under the rule of the playground.
+	tileSpin spin;
 };
 
 /**
@@ -96,6 +102,29 @@ struct gameEndEvent {
 	playgroundState endState;
 };
 
+/**
+ * @brief playgroundSnapshot is the trivially copyable state
+ * of the playground, with the field rows and the state of
+ * the generator stored in the snapshot arena.
+ *
+ * The listeners are not part of the snapshot, and restoring
+ * a snapshot will not notify the listeners.
+ */
+struct playgroundSnapshot {
+	/// maxNumPreviews is the maximum number of previews of
+	/// the playground that could be saved.
+	static constexpr int maxNumPreviews = 16;
+
+	fieldSnapshot fieldState;
+	const tile* current;
+	tileState currentState, shadowState;
+	const tile* swap;
+	bool swapEnabled;
+	playgroundState state;
+	const tile* preview[maxNumPreviews];
+	uint32_t generatorState;
+}; // struct hacktile::model::playgroundSnapshot
+
 /**
  * @brief playgroundListener is the decoupled event handler
  * that is registered to the playground and notified once
@@ -120,8 +149,9 @@ struct playgroundListener {
 
 	/// tileBeforeLock is triggered when a tile has reached
 	/// locked condition but not yet locked. This is exposed
-	/// by the playground for listeners to evaluate current
-	/// type of erasure.
+	/// by the playground for listeners to inspect the field
+	/// before locking, while the spin has been classified by
+	/// the playground and will be carried by tileLock.
 	virtual void tileBeforeLock(const tileBeforeLockEvent&) {}
 
 	/// tileLock is triggered when a tile has locked and
@@ -162,6 +192,13 @@ class playground :
 	std::unique_ptr<const tile*[]> preview;
 	int previewCursor;
 	playgroundState state;
+	spinRule rule;
+
+	// generatorHandle is the handle of the generator state
+	// saved in the arena of generatorEpoch, or 0 if a tile
+	// has been generated since then.
+	uint32_t generatorHandle;
+	uint64_t generatorEpoch;
 
 	// spawnNextTile will attempt to spawn the next tile into
 	// the game and update the preview series.
@@ -198,6 +235,17 @@ public:
 	/// remains in their location.
 	void complete();
 
+	/// getSpinRule returns the rule of spin classification.
+	spinRule getSpinRule() const {
+		return rule;
+	}
+
+	/// setSpinRule updates the rule of spin classification,
+	/// which is spinRule::tSpin by default.
+	void setSpinRule(spinRule newRule) {
+		rule = newRule;
+	}
+
 	/// getState returns the current game state.
 	playgroundState getState() const {
 		return state;
@@ -249,6 +297,20 @@ public:
 		return preview[(previewCursor + i) % numPreviews];
 	}
 
+	/// peekTile returns the tile coming at index, which is
+	/// the preview within the previews, or peeked from the
+	/// generator beyond them, e.g. through tileLookahead.
+	/// It returns nullptr if the tile could not be told.
+	///
+	/// Though the playground is not modified, peeking beyond
+	/// the previews may advance the generator into its own
+	/// buffer, so it must not race with other uses of the
+	/// generator, and the tiles generated stay the same.
+	const tile* peekTile(size_t i) const {
+		if(i < size_t(numPreviews)) return getPreview(int(i));
+		return generator->peek(i - size_t(numPreviews));
+	}
+
 	/// move will attempt to move the tile.
 	bool move(int8_t dx);
 
@@ -285,6 +347,20 @@ public:
 
 	/// swapTile will attempt to swap the current tile.
 	bool swapTile();
+
+	/// input will apply the elementary input to the tile,
+	/// which is handy for replaying input paths.
+	bool input(tileInput);
+
+	/// save takes the snapshot of the playground, and the
+	/// field rows and generator state are copied into the
+	/// arena only if they have changed since last snapshot.
+	void save(playgroundSnapshot&, snapshotArena&);
+
+	/// restore reverts the playground to the snapshot taken
+	/// by this playground, or any playground sharing the
+	/// same type of generator and number of previews.
+	void restore(const playgroundSnapshot&, const snapshotArena&);
 }; // struct hacktile::model::playground
 
 } // namespace hacktile::model
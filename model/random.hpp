@@ -0,0 +1,140 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file random.hpp
+ * @brief pseudo randomizers of the tile generators
+ * @author aegistudio
+ *
+ * This file provides the randomizers plugged into the tile
+ * generators, which shuffle the tiles and pick a tile from
+ * the tiles. The mt19937 randomizer is bit compatible with
+ * the generators seeded before, while the xoshiro randomizer
+ * takes only 32 bytes of state and is much faster.
+ */
+#include <cstdint>
+#include <cstddef>
+#include <random>
+#include <algorithm>
+#include <utility>
+
+namespace hacktile {
+namespace model {
+
+/**
+ * @brief xoshiro256 is the xoshiro256** pseudo randomizer,
+ * which satisfies the UniformRandomBitGenerator.
+ *
+ * The state is initialized from the seed by splitmix64, so
+ * that any seed including 0 makes a valid state.
+ */
+class xoshiro256 {
+	uint64_t s[4];
+
+	static uint64_t rotl(uint64_t x, int k) {
+		return (x << k) | (x >> (64 - k));
+	}
+
+	// applyJump advances the state by the jump polynomial.
+	void applyJump(const uint64_t polynomial[4]);
+public:
+	typedef uint64_t result_type;
+
+	/// xoshiro256 creates the randomizer with the seed.
+	explicit xoshiro256(uint64_t seed = 0);
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return UINT64_MAX; }
+
+	/// operator() generates the next 64 random bits.
+	result_type operator()() {
+		uint64_t result = rotl(s[1] * 5, 7) * 9;
+		uint64_t t = s[1] << 17;
+		s[2] ^= s[0];
+		s[3] ^= s[1];
+		s[1] ^= s[2];
+		s[0] ^= s[3];
+		s[2] ^= t;
+		s[3] = rotl(s[3], 45);
+		return result;
+	}
+
+	/// jump advances the randomizer by 2^128 calls, which
+	/// could be used to make 2^128 non-overlapping streams.
+	void jump();
+
+	/// longJump advances the randomizer by 2^192 calls.
+	void longJump();
+
+	/// below returns an unbiased random number in [0, n),
+	/// by the multiply and shift range reduction, which only
+	/// divides when the product falls into the biased range.
+	uint32_t below(uint32_t n) {
+		uint64_t m = uint64_t(uint32_t((*this)() >> 32)) * n;
+		uint32_t low = uint32_t(m);
+		if(low < n) {
+			uint32_t threshold = uint32_t(-n) % n;
+			while(low < threshold) {
+				m = uint64_t(uint32_t((*this)() >> 32)) * n;
+				low = uint32_t(m);
+			}
+		}
+		return uint32_t(m >> 32);
+	}
+
+	bool operator==(const xoshiro256& r) const {
+		return std::equal(s, s + 4, r.s);
+	}
+
+	bool operator!=(const xoshiro256& r) const {
+		return !(*this == r);
+	}
+}; // class hacktile::model::xoshiro256
+
+/**
+ * @brief mt19937Randomizer shuffles and picks with mt19937
+ * and the distributions of the standard library, which is
+ * bit compatible with the generators seeded before.
+ */
+struct mt19937Randomizer {
+	std::mt19937 engine;
+
+	explicit mt19937Randomizer(uint64_t seed): engine(seed) {}
+
+	/// shuffle shuffles the range uniformly.
+	template<typename T>
+	void shuffle(T* first, T* last) {
+		std::shuffle(first, last, engine);
+	}
+
+	/// below returns a random number in [0, n).
+	size_t below(size_t n) {
+		std::uniform_int_distribution<size_t> sampler{0, n - 1};
+		return sampler(engine);
+	}
+};
+
+/**
+ * @brief xoshiroRandomizer shuffles and picks with xoshiro256
+ * and the unbiased range reduction.
+ */
+struct xoshiroRandomizer {
+	xoshiro256 engine;
+
+	explicit xoshiroRandomizer(uint64_t seed): engine(seed) {}
+
+	/// shuffle shuffles the range uniformly, by swapping
+	/// each element with one of the elements before it.
+	template<typename T>
+	void shuffle(T* first, T* last) {
+		for(size_t i = size_t(last - first); i > 1; -- i)
+			std::swap(first[i - 1], first[engine.below(uint32_t(i))]);
+	}
+
+	/// below returns a random number in [0, n).
+	size_t below(size_t n) {
+		return engine.below(uint32_t(n));
+	}
+};
+
+} // namespace hacktile::model
+} // namespace hacktile
@@ -0,0 +1,281 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file replay.hpp
+ * @brief compact binary replay of the games
+ * @author aegistudio
+ *
+ * This file provides the recorder and the reader of replays,
+ * which store the seed of the generator and the placements
+ * of the tiles locked, bit packed with a few bits each.
+ *
+ * A replay file begins with a 24 byte header:
+ *
+ *   offset 0:  magic "HTRP"
+ *   offset 4:  version, which is 2
+ *   offset 5:  generator, see replayGenerator
+ *   offset 6:  number of tiles in the tile set
+ *   offset 7:  number of previews
+ *   offset 8:  seed of the generator, little endian
+ *   offset 16: randomizer, see replayRandomizer
+ *   offset 17: initial history, see replayHistory
+ *   offset 18: reserved, which are zeros
+ *
+ * The placements follow with the bits from the least to the
+ * most significant bit of each byte, and each placement is:
+ *
+ *   type:    index of the tile in the tile set, in the least
+ *            bits holding the number of tiles, where the
+ *            number of tiles marks the end of the replay
+ *   swapped: whether the tile is swapped before locking
+ *   dir:     2 bits of the direction
+ *   x:       4 bits of the column offset by 6
+ *   depth:   rows below the landing row of dropping from
+ *            above the skyline, as a single 0 bit for 0, or
+ *            a 1 bit and the Elias gamma code otherwise
+ *
+ * Most placements are dropped onto the skyline and take 11
+ * bits for the tetrominoes. The bits not ending a placement
+ * are ignored, so the replay truncated by a crash could
+ * still be read until the last complete placement.
+ */
+#include "model/playground.hpp"
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace hacktile {
+namespace model {
+
+/**
+ * @brief replayGenerator is the generator of the replay.
+ */
+enum class replayGenerator : uint8_t {
+	permutator,
+	historyRoll,
+};
+
+/**
+ * @brief replayRandomizer is the randomizer of the generator.
+ */
+enum class replayRandomizer : uint8_t {
+	mt19937,
+	xoshiro256,
+};
+
+/**
+ * @brief replayHistory is the initial history of the history
+ * roll, which is none for the other generators.
+ */
+enum class replayHistory : uint8_t {
+	none,
+
+	/// zszs is the history of Z S Z S tetrominoes, rolled
+	/// 4 times before giving up.
+	zszs,
+};
+
+/**
+ * @brief replayHeader is the header of the replay.
+ */
+struct replayHeader {
+	/// magic is the magic of the replay file.
+	static constexpr uint32_t magic = 0x50525448;
+
+	/// currentVersion is the version of the format.
+	static constexpr uint8_t currentVersion = 2;
+
+	/// size is the number of bytes of the header.
+	static constexpr size_t size = 24;
+
+	uint8_t version;
+	replayGenerator generator;
+	uint8_t numTiles;
+	uint8_t numPreviews;
+	uint64_t seed;
+	replayRandomizer randomizer;
+	replayHistory history;
+
+	replayHeader(): version(currentVersion),
+		generator(replayGenerator::permutator),
+		numTiles(0), numPreviews(0), seed(0),
+		randomizer(replayRandomizer::mt19937),
+		history(replayHistory::none) {}
+
+	/// typeBits returns the bits of the tile type.
+	int typeBits() const;
+};
+
+/**
+ * @brief replayPlacement is a placement in the replay.
+ */
+struct replayPlacement {
+	/// type is the index of the tile in the tile set.
+	uint8_t type;
+
+	/// swapped is whether the tile is swapped in before
+	/// it is locked.
+	bool swapped;
+
+	/// dir and x are the direction and column locked at.
+	uint8_t dir;
+	int8_t x;
+
+	/// depth is the rows below the landing row of dropping
+	/// from above the skyline, which is 0 unless the tile
+	/// is tucked under the overhangs.
+	uint8_t depth;
+};
+
+/// landingOf evaluates the row the tile lands at when it is
+/// dropped from above the skyline of the field.
+int landingOf(const field&, const tile&, tileDirection, int8_t x);
+
+/// placementOf evaluates the placement of the tile at the
+/// state in the field, prior to locking it.
+replayPlacement placementOf(const field&, const tile&,
+	uint8_t type, bool swapped, tileState);
+
+/// stateOf evaluates the state of the placement in the field.
+tileState stateOf(const field&, const tile&, const replayPlacement&);
+
+/// replayLock locks the tile of the placement in the field,
+/// and returns false without modifying the field if the tile
+/// could not be at the placement, or is not on the ground.
+bool replayLock(field&, const tile&, const replayPlacement&, uint8_t& clear);
+
+/**
+ * @brief replayRecorder records the game of the playground
+ * into the file descriptor as it is played.
+ *
+ * The recorder must be created before the playground starts,
+ * and the bytes are written in blocks, with the remaining
+ * bytes and the end of the replay written once the game
+ * ends or the recorder is finished.
+ *
+ * Nothing is thrown while the events are dispatched. The
+ * recording stops at the first failure, which is thrown by
+ * the next flush or finish instead.
+ */
+class replayRecorder : public playgroundListener {
+	const playground& play;
+	const tile* const* tiles;
+	int fd;
+	replayHeader header;
+	hacktile::util::eventSubscription<playgroundListener> subscription;
+	std::vector<uint8_t> buffer;
+	uint64_t bits;
+	int numBits;
+	bool swapped, finished;
+	size_t numPlacements;
+	std::string failure;
+
+	// append appends the bits of the value.
+	void append(uint64_t value, int n);
+
+	// fail stops the recording with the failure.
+	void fail(const std::string& reason);
+
+	// writeOut writes the complete bytes to the file, and
+	// stops the recording if they could not be written.
+	void writeOut();
+
+	// terminate writes the end of the replay.
+	void terminate();
+
+	// check throws the failure of the recording if any.
+	void check() const;
+public:
+	/// replayRecorder creates the recorder of the playground
+	/// with the tiles of the header, and writes the header.
+	/// The tiles must outlive the recorder.
+	replayRecorder(playground& play, int fd,
+		const replayHeader& header, const tile* const tiles[]);
+	~replayRecorder();
+
+	/// getNumPlacements returns the placements recorded.
+	size_t getNumPlacements() const {
+		return numPlacements;
+	}
+
+	/// flush writes the complete bytes recorded so far, and
+	/// throws runtime_error if the recording has failed.
+	void flush();
+
+	/// finish writes the end of the replay, and no more
+	/// placements will be recorded. It throws runtime_error
+	/// if the recording has failed.
+	void finish();
+
+	virtual void tileBeforeLock(const tileBeforeLockEvent&) override;
+	virtual void tileSwap(const tileSwapEvent&) override;
+	virtual void gameEnd(const gameEndEvent&) override;
+}; // class hacktile::model::replayRecorder
+
+/**
+ * @brief replayCursor decodes the placements of a replay in
+ * the memory, without allocating.
+ */
+class replayCursor {
+	const uint8_t* data;
+	size_t numBits, bit;
+	uint8_t numTiles;
+	int typeBits;
+	bool ended;
+
+	// read reads the bits of the value, or returns false if
+	// there're not enough bits.
+	bool read(int n, uint32_t& value);
+public:
+	replayCursor(): data(nullptr), numBits(0), bit(0),
+		numTiles(0), typeBits(0), ended(false) {}
+
+	/// replayCursor creates the cursor of the placements
+	/// following the header.
+	replayCursor(const replayHeader&, const uint8_t* data, size_t size);
+
+	/// next decodes the next placement, or returns false at
+	/// the end of the replay.
+	bool next(replayPlacement&);
+
+	/// isEnded returns whether the end of the replay has been
+	/// decoded, rather than the replay being truncated.
+	bool isEnded() const {
+		return ended;
+	}
+}; // class hacktile::model::replayCursor
+
+/**
+ * @brief replayReader maps the replay file into memory and
+ * provides the cursor of the placements.
+ */
+class replayReader {
+	const uint8_t* data;
+	size_t size;
+	replayHeader header;
+public:
+	/// replayReader maps the replay file, and it throws
+	/// runtime_error if the file is not a replay.
+	replayReader(const char* path);
+	~replayReader();
+	replayReader(const replayReader&) = delete;
+	replayReader& operator=(const replayReader&) = delete;
+
+	/// parseHeader parses the header of the replay in the
+	/// memory, and returns false if it is not a replay.
+	static bool parseHeader(const uint8_t* data, size_t size, replayHeader&);
+
+	/// getHeader returns the header of the replay.
+	const replayHeader& getHeader() const {
+		return header;
+	}
+
+	/// placements returns the cursor of the placements.
+	replayCursor placements() const {
+		return replayCursor(header, data, size);
+	}
+}; // class hacktile::model::replayReader
+
+} // namespace hacktile::model
+} // namespace hacktile
@@ -0,0 +1,112 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file snapshot.hpp
+ * @brief copy-on-write snapshots of the field
+ * @author aegistudio
+ *
+ * This file provides the snapshot arena and the snapshot of
+ * the field. Snapshots are trivially copyable, and refer to
+ * the rows and other bulky states stored in the arena by
+ * their handles, so that rows unchanged between snapshots
+ * are stored only once, and restoring a snapshot will only
+ * copy the rows that differ from the field.
+ */
+#include "model/tile.hpp"
+#include <vector>
+#include <cstddef>
+
+namespace hacktile {
+namespace model {
+
+/**
+ * @brief snapshotArena is the append-only storage of the
+ * rows and states referred by the snapshots.
+ *
+ * The handle 0 is never allocated, so it could be used to
+ * indicate that there's no copy in the arena. The arena
+ * could be rewound to a previous mark to reclaim the space
+ * used by speculative snapshots, and the snapshots taken
+ * after the mark are invalidated then.
+ */
+class snapshotArena {
+	std::vector<fieldRow> rows;
+	std::vector<uint64_t> words;
+	uint64_t epoch;
+
+	// newEpoch allocates a globally unique epoch, which
+	// identifies the arena and the handles allocated in it.
+	static uint64_t newEpoch();
+public:
+	/// mark is the location that the arena is rewound to.
+	struct mark {
+		size_t numRows, numWords;
+	};
+
+	/// snapshotArena initializes an empty arena.
+	snapshotArena();
+
+	/// getEpoch returns the epoch of the arena, which will
+	/// be changed when the arena is rewound.
+	uint64_t getEpoch() const {
+		return epoch;
+	}
+
+	/// pushRow copies the row into the arena.
+	uint32_t pushRow(const fieldRow& row) {
+		rows.push_back(row);
+		return uint32_t(rows.size() - 1);
+	}
+
+	/// rowAt retrieves the row with specified handle.
+	const fieldRow& rowAt(uint32_t handle) const {
+		return rows[handle];
+	}
+
+	/// pushState allocates the space for a state of
+	/// specified number of bytes, aligned to 8 bytes.
+	uint32_t pushState(size_t size) {
+		size_t handle = words.size();
+		words.resize(handle + (size + 7) / 8);
+		return uint32_t(handle);
+	}
+
+	/// stateAt retrieves the state with specified handle.
+	/// The pointer is invalidated by the next pushState.
+	void* stateAt(uint32_t handle) {
+		return &words[handle];
+	}
+
+	/// stateAt retrieves the state with specified handle.
+	const void* stateAt(uint32_t handle) const {
+		return &words[handle];
+	}
+
+	/// getMark returns the current mark of the arena.
+	mark getMark() const {
+		return mark{rows.size(), words.size()};
+	}
+
+	/// rewind discards the content pushed after the mark.
+	void rewind(const mark&);
+
+	/// clear discards all content in the arena.
+	void clear() {
+		rewind(mark{1, 1});
+	}
+}; // class hacktile::model::snapshotArena
+
+/**
+ * @brief fieldSnapshot is the state of the field, with the
+ * rows referred by their handles in the arena.
+ */
+struct fieldSnapshot {
+	fieldCompactStorage compactFields;
+	uint32_t rows[field::maxHeight];
+	uint64_t hash;
+	uint8_t heights[10];
+	uint8_t numRows;
+}; // struct hacktile::model::fieldSnapshot
+
+} // namespace hacktile::model
+} // namespace hacktile
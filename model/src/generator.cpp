@@ -4,46 +4,54 @@
  * @author aegistudio
  * @brief Implementation of some tile generator.
  *
- * This file implements the tile permutator, with C++ pseudo
- * randomizer and full permutate algorithm.
+ * This file implements the tile permutator and history roll,
+ * which are instantiated with every randomizer provided, so
+ * that they're still compiled here rather than in headers.
  */
 #include "model/generator.hpp"
 #include <algorithm>
-#include <random>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 namespace hacktile {
 namespace model {
 
-// forward the definition of the commonly used randomizer.
-typedef std::mt19937 randomizer;
+size_t tileGenerator::generateN(const tile* result[], size_t n) {
+	for(size_t i = 0; i < n; ++ i)
+		if((result[i] = generate()) == nullptr) return i;
+	return n;
+}
 
-void tilePermutator::permutate() {
+template<typename randomizer>
+void basicTilePermutator<randomizer>::permutate() {
 	// Randomize the series for the first round.
-	std::shuffle(&series[0], &series[numTiles],
-		*reinterpret_cast<randomizer*>(workData));
+	rng.shuffle(&series[0], &series[numTiles]);
 }
 
-tilePermutator::tilePermutator(
-	const tile* tiles[], size_t numTiles, uint64_t seed):
-	series(new const tile*[numTiles]),
-	numTiles(numTiles), pointer(0) {
+template<typename randomizer>
+basicTilePermutator<randomizer>::basicTilePermutator(
+	const tile* const tiles[], size_t numTiles, uint64_t seed):
+	series(new const tile*[numTiles]), tiles(new const tile*[numTiles]),
+	numTiles(numTiles), pointer(0), rng(seed) {
+	static_assert(std::is_trivially_copyable<randomizer>::value,
+		"randomizer must be saved by copying its bytes");
 
 	// Initialize the series and random generator.
 	for(size_t i = 0; i < numTiles; ++ i)
-		series[i] = tiles[i];
-	static_assert(sizeof(randomizer) <= sizeof(workData),
-		"not enough space to hold the random generator");
-	new (workData) randomizer(seed);
+		series[i] = this->tiles[i] = tiles[i];
 
 	// Randomize the series for the first round.
 	permutate();
 }
 
-tilePermutator::~tilePermutator() {
-	reinterpret_cast<randomizer*>(workData)->~randomizer();
-}
+template<typename randomizer>
+basicTilePermutator<randomizer>::~basicTilePermutator() {}
 
-const tile* tilePermutator::generate() {
+template<typename randomizer>
+const tile* basicTilePermutator<randomizer>::generate() {
 	const tile* result = series[pointer];
 	++ pointer;
 	if(pointer >= numTiles) {
@@ -53,33 +61,164 @@ const tile* tilePermutator::generate() {
 	return result;
 }
 
-historyRoll::historyRoll(
-	const tile* tiles_[], std::size_t numTiles,
+template<typename randomizer>
+size_t basicTilePermutator<randomizer>::generateN(
+	const tile* result[], size_t n) {
+	// Copy the rest of the series at once, and permutate
+	// for the next round whenever it is used up.
+	size_t generated = 0;
+	while(generated < n) {
+		size_t available = std::min(
+			numTiles - size_t(pointer), n - generated);
+		std::copy(&series[pointer], &series[pointer] + available,
+			result + generated);
+		generated += available;
+		pointer += int(available);
+		if(size_t(pointer) >= numTiles) {
+			pointer = 0;
+			permutate();
+		}
+	}
+	return n;
+}
+
+template<typename randomizer>
+tileBag basicTilePermutator<randomizer>::getBag() const {
+	if(numTiles > 64)
+		throw std::length_error("bag is over 64 tiles");
+
+	// Match each tile left to the first index of the same
+	// tile that is not matched yet, since a tile might be
+	// permuted more than once in a bag.
+	tileBag bag;
+	bag.remaining = 0;
+	bag.numRemaining = numTiles - size_t(pointer);
+	bag.bagSize = numTiles;
+	for(size_t i = size_t(pointer); i < numTiles; ++ i) {
+		size_t j = 0;
+		while(tiles[j] != series[i] ||
+			(bag.remaining & (uint64_t(1) << j))) ++ j;
+		bag.remaining |= uint64_t(1) << j;
+	}
+	return bag;
+}
+
+namespace {
+
+// bagEnumeration is the depth first search of the orders of
+// the tiles in the bags, where every order of the tiles left
+// is equally likely.
+struct bagEnumeration {
+	const tile* const* tiles;
+	uint64_t full;
+	size_t numTiles, k;
+	const tileSequenceVisitor& visitor;
+	double minProbability;
+	std::vector<const tile*> sequence;
+	size_t numVisited;
+
+	bagEnumeration(const tile* const* tiles, size_t numTiles,
+		size_t k, const tileSequenceVisitor& visitor,
+		double minProbability):
+		tiles(tiles), full(numTiles >= 64? ~uint64_t(0) :
+			(uint64_t(1) << numTiles) - 1),
+		numTiles(numTiles), k(k), visitor(visitor),
+		minProbability(minProbability), sequence(k),
+		numVisited(0) {}
+
+	void visit(size_t depth, uint64_t remaining,
+		size_t numRemaining, double probability) {
+		if(depth == k) {
+			visitor(sequence.data(), k, probability);
+			++ numVisited;
+			return;
+		}
+		if(remaining == 0) {
+			remaining = full;
+			numRemaining = numTiles;
+		}
+		probability /= double(numRemaining);
+		if(probability < minProbability) return;
+		for(size_t j = 0; j < numTiles; ++ j) {
+			uint64_t bit = uint64_t(1) << j;
+			if(!(remaining & bit)) continue;
+			sequence[depth] = tiles[j];
+			visit(depth + 1, remaining & ~bit,
+				numRemaining - 1, probability);
+		}
+	}
+};
+
+} // namespace
+
+template<typename randomizer>
+size_t basicTilePermutator<randomizer>::enumerate(size_t k,
+	const tileSequenceVisitor& visitor, double minProbability) const {
+	tileBag bag = getBag();
+	if(numTiles == 0) return 0;
+	bagEnumeration search(tiles.get(), numTiles,
+		k, visitor, minProbability);
+	search.visit(0, bag.remaining, bag.numRemaining, 1.0);
+	return search.numVisited;
+}
+
+// The state of the permutator is laid out as the randomizer,
+// the series and the pointer.
+template<typename randomizer>
+size_t basicTilePermutator<randomizer>::stateSize() const {
+	return sizeof(randomizer) + numTiles * sizeof(const tile*)
+		+ sizeof(pointer);
+}
+
+template<typename randomizer>
+void basicTilePermutator<randomizer>::saveState(void* buffer) const {
+	char* data = reinterpret_cast<char*>(buffer);
+	std::memcpy(data, &rng, sizeof(randomizer));
+	data += sizeof(randomizer);
+	std::memcpy(data, series.get(), numTiles * sizeof(const tile*));
+	data += numTiles * sizeof(const tile*);
+	std::memcpy(data, &pointer, sizeof(pointer));
+}
+
+template<typename randomizer>
+void basicTilePermutator<randomizer>::restoreState(const void* buffer) {
+	const char* data = reinterpret_cast<const char*>(buffer);
+	std::memcpy(&rng, data, sizeof(randomizer));
+	data += sizeof(randomizer);
+	std::memcpy(series.get(), data, numTiles * sizeof(const tile*));
+	data += numTiles * sizeof(const tile*);
+	std::memcpy(&pointer, data, sizeof(pointer));
+}
+
+template class basicTilePermutator<mt19937Randomizer>;
+template class basicTilePermutator<xoshiroRandomizer>;
+
+template<typename randomizer>
+basicHistoryRoll<randomizer>::basicHistoryRoll(
+	const tile* const tiles_[], std::size_t numTiles,
 	std::size_t retryTimes, std::size_t* initialHistory,
 	std::size_t historySize, uint64_t seed):
 	history(initialHistory, initialHistory + historySize),
 	counts(new std::size_t[numTiles]),
 	tiles(new const tile*[numTiles]), numTiles(numTiles),
-	retryTimes(retryTimes), historySize(historySize) {
+	retryTimes(retryTimes), historySize(historySize), rng(seed) {
+	static_assert(std::is_trivially_copyable<randomizer>::value,
+		"randomizer must be saved by copying its bytes");
 	std::copy(tiles_, tiles_ + numTiles, tiles.get());
 	std::fill_n(counts.get(), numTiles, 0);
 	for (std::size_t i : history)
 		if (i < numTiles)
 			counts[i]++;
-	static_assert(sizeof(randomizer) <= sizeof(workData),
-		"not enough space to hold the random generator");
-	new (workData) randomizer(seed);
 }
 
-historyRoll::~historyRoll() {
-	reinterpret_cast<randomizer*>(workData)->~randomizer();
-}
+template<typename randomizer>
+basicHistoryRoll<randomizer>::~basicHistoryRoll() {}
 
-const tile* historyRoll::generate() {
-	std::uniform_int_distribution<std::size_t> sampler{0, numTiles - 1};
-	std::size_t result = sampler(*reinterpret_cast<randomizer*>(workData));
+template<typename randomizer>
+const tile* basicHistoryRoll<randomizer>::generate() {
+	std::size_t result = rng.below(numTiles);
 	for (std::size_t i = 0; i < retryTimes && counts[result] > 0; ++i)
-		result = sampler(*reinterpret_cast<randomizer*>(workData));
+		result = rng.below(numTiles);
 	history.push_back(result);
 	counts[result]++;
 	if (history.front() < numTiles)
@@ -88,5 +227,144 @@ const tile* historyRoll::generate() {
 	return tiles[result];
 }
 
+template<typename randomizer>
+size_t basicHistoryRoll<randomizer>::generateN(
+	const tile* result[], size_t n) {
+	for(size_t i = 0; i < n; ++ i)
+		result[i] = basicHistoryRoll::generate();
+	return n;
+}
+
+namespace {
+
+// rollProbabilities evaluates the probability of rolling each
+// tile in and out of history, given the number of tiles in
+// history. A tile out of history is taken by any roll before
+// one in history is hit, while a tile in history is taken only
+// when all rolls hit the history.
+void rollProbabilities(size_t numInHistory, size_t numTiles,
+	size_t retryTimes, double& inHistory, double& outOfHistory) {
+	double n = double(numTiles);
+	double q = double(numInHistory) / n;
+	inHistory = std::pow(q, double(retryTimes)) / n;
+	outOfHistory = numInHistory == numTiles? inHistory :
+		(1.0 - std::pow(q, double(retryTimes + 1))) / (1.0 - q) / n;
+}
+
+// rollEnumeration is the depth first search of the rolls,
+// where the history at each depth is the window of the
+// indices starting at the depth.
+struct rollEnumeration {
+	const tile* const* tiles;
+	size_t numTiles, retryTimes, historySize, k;
+	const tileSequenceVisitor& visitor;
+	double minProbability;
+	std::vector<std::size_t> window, counts;
+	size_t numInHistory;
+	std::vector<const tile*> sequence;
+	size_t numVisited;
+
+	rollEnumeration(const tile* const* tiles, size_t numTiles,
+		size_t retryTimes, const std::deque<std::size_t>& history,
+		size_t k, const tileSequenceVisitor& visitor,
+		double minProbability):
+		tiles(tiles), numTiles(numTiles), retryTimes(retryTimes),
+		historySize(history.size()), k(k), visitor(visitor),
+		minProbability(minProbability), window(history.begin(),
+		history.end()), counts(numTiles, 0), numInHistory(0),
+		sequence(k), numVisited(0) {
+		window.resize(historySize + k);
+		for(std::size_t i : history)
+			if(i < numTiles && counts[i]++ == 0) ++ numInHistory;
+	}
+
+	void visit(size_t depth, double probability) {
+		if(depth == k) {
+			visitor(sequence.data(), k, probability);
+			++ numVisited;
+			return;
+		}
+		double inHistory, outOfHistory;
+		rollProbabilities(numInHistory, numTiles,
+			retryTimes, inHistory, outOfHistory);
+		for(size_t t = 0; t < numTiles; ++ t) {
+			double next = probability *
+				(counts[t] > 0? inHistory : outOfHistory);
+			if(next <= 0.0 || next < minProbability) continue;
+
+			// Push the tile into history and pop the oldest,
+			// and revert them after the search.
+			std::size_t oldest = window[depth];
+			window[historySize + depth] = t;
+			if(counts[t]++ == 0) ++ numInHistory;
+			if(oldest < numTiles && -- counts[oldest] == 0)
+				-- numInHistory;
+			sequence[depth] = tiles[t];
+			visit(depth + 1, next);
+			if(oldest < numTiles && counts[oldest]++ == 0)
+				++ numInHistory;
+			if(-- counts[t] == 0) -- numInHistory;
+		}
+	}
+};
+
+} // namespace
+
+template<typename randomizer>
+void basicHistoryRoll<randomizer>::getProbabilities(
+	double probabilities[]) const {
+	size_t numInHistory = 0;
+	for(size_t i = 0; i < numTiles; ++ i)
+		if(counts[i] > 0) ++ numInHistory;
+	double inHistory, outOfHistory;
+	rollProbabilities(numInHistory, numTiles,
+		retryTimes, inHistory, outOfHistory);
+	for(size_t i = 0; i < numTiles; ++ i)
+		probabilities[i] = counts[i] > 0? inHistory : outOfHistory;
+}
+
+template<typename randomizer>
+size_t basicHistoryRoll<randomizer>::enumerate(size_t k,
+	const tileSequenceVisitor& visitor, double minProbability) const {
+	if(numTiles == 0) return 0;
+	rollEnumeration search(tiles.get(), numTiles, retryTimes,
+		history, k, visitor, minProbability);
+	search.visit(0, 1.0);
+	return search.numVisited;
+}
+
+// The state of the history roll is laid out as the
+// randomizer and the history from oldest to newest, and the
+// counts are evaluated from the history again.
+template<typename randomizer>
+size_t basicHistoryRoll<randomizer>::stateSize() const {
+	return sizeof(randomizer) + historySize * sizeof(std::size_t);
+}
+
+template<typename randomizer>
+void basicHistoryRoll<randomizer>::saveState(void* buffer) const {
+	char* data = reinterpret_cast<char*>(buffer);
+	std::memcpy(data, &rng, sizeof(randomizer));
+	std::size_t* saved = reinterpret_cast<std::size_t*>(
+		data + sizeof(randomizer));
+	std::copy(history.begin(), history.end(), saved);
+}
+
+template<typename randomizer>
+void basicHistoryRoll<randomizer>::restoreState(const void* buffer) {
+	const char* data = reinterpret_cast<const char*>(buffer);
+	std::memcpy(&rng, data, sizeof(randomizer));
+	const std::size_t* saved = reinterpret_cast<const std::size_t*>(
+		data + sizeof(randomizer));
+	history.assign(saved, saved + historySize);
+	std::fill_n(counts.get(), numTiles, 0);
+	for (std::size_t i : history)
+		if (i < numTiles)
+			counts[i]++;
+}
+
+template class basicHistoryRoll<mt19937Randomizer>;
+template class basicHistoryRoll<xoshiroRandomizer>;
+
 } // namespace hacktile::model
 } // namespace hacktile
@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file lookahead.cpp
+ * @author aegistudio
+ * @brief Implementation of the tile lookahead.
+ *
+ * This file implements the lookahead adapter. The tiles are
+ * generated into the free space of the ring in at most two
+ * contiguous chunks, so that they're generated by the bulk
+ * generation of the underlying generator directly.
+ */
+#include "model/lookahead.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace hacktile {
+namespace model {
+
+tileLookahead::tileLookahead(tileGenerator* source, size_t batchSize):
+	source(source), batchSize(std::max(batchSize, size_t(1))),
+	ring(), head(0), count(0) {
+	size_t capacity = 1;
+	while(capacity < this->batchSize) capacity <<= 1;
+	ring.resize(capacity);
+}
+
+bool tileLookahead::fill(size_t n) {
+	if(count >= n) return true;
+
+	// Grow the ring to hold the tiles requested, and the
+	// tiles buffered are moved to the front of the ring.
+	size_t target = std::max(n, count + batchSize);
+	if(target > ring.size()) {
+		size_t capacity = ring.size();
+		while(capacity < target) capacity <<= 1;
+		std::vector<const tile*> grown(capacity);
+		for(size_t i = 0; i < count; ++ i)
+			grown[i] = ring[(head + i) & (ring.size() - 1)];
+		ring.swap(grown);
+		head = 0;
+	}
+
+	// Generate into the free space after the buffered tiles
+	// which wraps around the ring at most once.
+	size_t mask = ring.size() - 1;
+	while(count < target) {
+		size_t tail = (head + count) & mask;
+		size_t chunk = std::min(target - count, ring.size() - tail);
+		size_t generated = source->generateN(&ring[tail], chunk);
+		count += generated;
+		if(generated < chunk) break;
+	}
+	return count >= n;
+}
+
+const tile* tileLookahead::generate() {
+	if(count == 0 && !fill(1)) return nullptr;
+	const tile* result = ring[head];
+	head = (head + 1) & (ring.size() - 1);
+	-- count;
+	return result;
+}
+
+size_t tileLookahead::generateN(const tile* result[], size_t n) {
+	// Take the tiles buffered first, and the rest of tiles
+	// are generated by the underlying generator directly.
+	size_t taken = std::min(n, count);
+	size_t first = std::min(taken, ring.size() - head);
+	std::copy(&ring[head], &ring[head] + first, result);
+	std::copy(&ring[0], &ring[0] + (taken - first), result + first);
+	head = (head + taken) & (ring.size() - 1);
+	count -= taken;
+	if(taken == n) return n;
+	return taken + source->generateN(result + taken, n - taken);
+}
+
+const tile* tileLookahead::peek(size_t i) {
+	if(!fill(i + 1)) return nullptr;
+	return ring[(head + i) & (ring.size() - 1)];
+}
+
+// The state of the lookahead is laid out as the number of
+// tiles buffered, the tiles buffered and the state of the
+// underlying generator, which is aligned to 8 bytes.
+size_t tileLookahead::stateSize() const {
+	return sizeof(uint64_t) + count * sizeof(const tile*)
+		+ source->stateSize();
+}
+
+void tileLookahead::saveState(void* buffer) const {
+	char* data = reinterpret_cast<char*>(buffer);
+	uint64_t numBuffered = count;
+	std::memcpy(data, &numBuffered, sizeof(numBuffered));
+	data += sizeof(numBuffered);
+	for(size_t i = 0; i < count; ++ i) {
+		const tile* t = ring[(head + i) & (ring.size() - 1)];
+		std::memcpy(data, &t, sizeof(t));
+		data += sizeof(t);
+	}
+	source->saveState(data);
+}
+
+void tileLookahead::restoreState(const void* buffer) {
+	const char* data = reinterpret_cast<const char*>(buffer);
+	uint64_t numBuffered;
+	std::memcpy(&numBuffered, data, sizeof(numBuffered));
+	data += sizeof(numBuffered);
+	if(numBuffered > ring.size()) {
+		size_t capacity = ring.size();
+		while(capacity < numBuffered) capacity <<= 1;
+		ring.resize(capacity);
+	}
+	head = 0;
+	count = size_t(numBuffered);
+	std::memcpy(ring.data(), data, count * sizeof(const tile*));
+	data += count * sizeof(const tile*);
+	source->restoreState(data);
+}
+
+} // namespace hacktile::model
+} // namespace hacktile
@@ -0,0 +1,20 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file pentomino.cpp
+ * @author aegistudio
+ * @brief Definition of the pentomino tables.
+ *
+ * This file defines the pentomino tables generated at
+ * compile time, so that they have a unique address in
+ * the program.
+ */
+#include "model/pentomino.hpp"
+
+namespace hacktile {
+namespace model {
+
+constexpr tileShape pentominoTable::shapes[18];
+constexpr tile pentominoTable::tiles[18];
+
+} // namespace hacktile::model
+} // namespace hacktile
@@ -0,0 +1,257 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file placement.cpp
+ * @author aegistudio
+ * @brief Implementation of the placement finder.
+ *
+ * This file implements the breadth first search of tile
+ * placements. Every compact field window of the rows that
+ * could be searched is evaluated once before the search, so
+ * that each collision detection in the search is a single
+ * bit operation, and no field row is accessed afterwards.
+ */
+#include "model/placement.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <climits>
+
+namespace hacktile {
+namespace model {
+
+// unknownLanding marks the landing row not evaluated yet.
+static constexpr int8_t unknownLanding = INT8_MIN;
+
+// nodeOf evaluates the search node index of the state.
+static inline uint16_t nodeOf(int8_t x, int8_t y, uint8_t dir) {
+	return uint16_t((((y - placementFinder::minY)
+		* placementFinder::numColumns)
+		+ (x - placementFinder::minX)) * 4 + dir);
+}
+
+void placementFinder::prepare(const field& f, const tile* t) {
+	typ = t;
+
+	// Evaluate the moved tile and horizontal boundaries of
+	// each direction, and see whether the direction shares
+	// the same shape with a previous one.
+	for(uint8_t dir = 0; dir < 4; ++ dir) {
+		tileCoord min; min.value = typ->min[dir];
+		tileCoord max; max.value = typ->max[dir];
+		lowX[dir] = -min.x;
+		highX[dir] = 9 - max.x;
+		lowY[dir] = std::max<int8_t>(minY, -max.y);
+		compactField tile(typ->compactTile[dir]);
+		for(int8_t x = lowX[dir]; x <= highX[dir]; ++ x)
+			masks[dir][x - minX] = tile.tileMove(x);
+
+		canonicalDir[dir] = dir;
+		canonicalX[dir] = 0;
+		canonicalY[dir] = 0;
+		uint64_t shape = typ->compactTile[dir];
+		shape >>= 10 * min.y + min.x;
+		for(uint8_t prev = 0; prev < dir; ++ prev) {
+			tileCoord pmin; pmin.value = typ->min[prev];
+			uint64_t prevShape = typ->compactTile[prev];
+			prevShape >>= 10 * pmin.y + pmin.x;
+			if(shape != prevShape) continue;
+			canonicalDir[dir] = prev;
+			canonicalX[dir] = min.x - pmin.x;
+			canonicalY[dir] = min.y - pmin.y;
+			break;
+		}
+	}
+
+	// Evaluate the compact field window of each row, by
+	// moving the window upward row by row.
+	compactField window;
+	for(int i = 5; i >= 0; -- i)
+		window = window.fieldDown(f.compactRowAt(minY + i));
+	windows[0] = window;
+	for(int i = 1; i < numRows; ++ i) {
+		window = window.fieldUp(f.compactRowAt(minY + i + 5));
+		windows[i] = window;
+	}
+}
+
+bool placementFinder::isValid(int8_t x, int8_t y, uint8_t dir) const {
+	// Bounding box checking, which is the same as the one
+	// performed by the field.
+	if(x < lowX[dir] || x > highX[dir]) return false;
+	if(y < lowY[dir] || y >= minY + numRows) return false;
+
+	// Collision checking with the window at the row.
+	return !windows[y - minY].collide(masks[dir][x - minX]);
+}
+
+void placementFinder::visit(int8_t x, int8_t y, uint8_t dir,
+	uint16_t from, tileInput how, bool wallKick, size_t& tail) {
+	uint16_t node = nodeOf(x, y, dir);
+	uint64_t bit = uint64_t(1) << (node & 63);
+	if((visited[node >> 6] & bit) != 0) return;
+	visited[node >> 6] |= bit;
+	parent[node] = from;
+	depth[node] = depth[from] + 1;
+	input[node] = how;
+	kicked[node] = wallKick;
+	queue[tail ++] = node;
+}
+
+int8_t placementFinder::land(int8_t x, int8_t y, uint8_t dir) {
+	// Walk down until we reach the ground, or a state
+	// whose landing row has been evaluated.
+	int8_t bottom = y, result;
+	while(true) {
+		int8_t known = landing[nodeOf(x, bottom, dir)];
+		if(known != unknownLanding) {
+			result = known;
+			break;
+		}
+		if(!isValid(x, bottom - 1, dir)) {
+			result = bottom;
+			break;
+		}
+		-- bottom;
+	}
+
+	// Fill the states that we have walked through, so
+	// that each state is walked through at most once.
+	for(int8_t i = y; i >= bottom; -- i)
+		landing[nodeOf(x, i, dir)] = result;
+	return result;
+}
+
+bool placementFinder::rotate(int8_t& x, int8_t& y,
+	uint8_t srcDir, uint8_t dstDir, bool& wallKick) const {
+
+	// Judge whether the initial state is valid.
+	wallKick = false;
+	if(isValid(x, y, dstDir)) return true;
+
+	// Apply the rotation table in order, which is the
+	// same as what field::rotate does.
+	const auto& table = typ->rotateTable[srcDir][dstDir];
+	for(int n = 0; n < tile::maxNumRotations; ++ n) {
+		uint8_t value = table[n];
+		if(value == 0) break;
+		tileCoord coord; coord.value = value;
+		if(isValid(x + coord.x, y + coord.y, dstDir)) {
+			x += coord.x;
+			y += coord.y;
+			wallKick = true;
+			return true;
+		}
+	}
+	return false;
+}
+
+size_t placementFinder::search(const field& f, const tilePathFinder& pfd) {
+	if(pfd.getType() == nullptr)
+		throw std::runtime_error("tile not specified");
+	prepare(f, pfd.getType());
+	memset(visited, 0, sizeof(visited));
+	memset(placed, 0, sizeof(placed));
+	memset(landing, uint8_t(unknownLanding), sizeof(landing));
+	numPlacements = 0;
+
+	// Initialize the search with the initial state.
+	tileState state = pfd.getState();
+	uint8_t initialDir = state.dir.getValue();
+	if(!isValid(state.x, state.y, initialDir)) return 0;
+	size_t head = 0, tail = 0;
+	uint16_t root = nodeOf(state.x, state.y, initialDir);
+	visited[root >> 6] |= uint64_t(1) << (root & 63);
+	parent[root] = root;
+	depth[root] = 0;
+	kicked[root] = pfd.isPreviousWallKick();
+	queue[tail ++] = root;
+
+	// Perform the breadth first search so that the first
+	// time a state is visited, it is visited with one of
+	// the shortest paths.
+	while(head < tail) {
+		uint16_t node = queue[head ++];
+		uint8_t dir = node & 3;
+		int8_t x = int8_t((node >> 2) % numColumns) + minX;
+		int8_t y = int8_t((node >> 2) / numColumns) + minY;
+
+		// Record the placement if the tile cannot drop,
+		// unless a tile of the same shape is placed there.
+		bool grounded = !isValid(x, y - 1, dir);
+		if(grounded) {
+			uint16_t canonical = nodeOf(
+				x + canonicalX[dir], y + canonicalY[dir],
+				canonicalDir[dir]);
+			uint64_t bit = uint64_t(1) << (canonical & 63);
+			if((placed[canonical >> 6] & bit) == 0) {
+				placed[canonical >> 6] |= bit;
+				tilePlacement& placement =
+					placements[numPlacements ++];
+				placement.state.dir = dir;
+				placement.state.x = x;
+				placement.state.y = y;
+				placement.node = node;
+				placement.numInputs = depth[node];
+				placement.wallKick = kicked[node];
+			}
+		}
+
+		// Expand the node with horizontal movements.
+		if(isValid(x - 1, y, dir)) visit(x - 1, y, dir,
+			node, tileInput::moveLeft, false, tail);
+		if(isValid(x + 1, y, dir)) visit(x + 1, y, dir,
+			node, tileInput::moveRight, false, tail);
+
+		// Expand the node with rotations.
+		tileDirection current(dir);
+		const struct {
+			tileInput how;
+			tileDirection target;
+		} rotations[3] = {
+			{ tileInput::rotateCW,  current.rotateCW()  },
+			{ tileInput::rotateCCW, current.rotateCCW() },
+			{ tileInput::halfTurn,  current.halfTurn()  },
+		};
+		for(const auto& rotation : rotations) {
+			int8_t nx = x, ny = y;
+			bool wallKick;
+			uint8_t target = rotation.target.getValue();
+			if(rotate(nx, ny, dir, target, wallKick))
+				visit(nx, ny, target, node,
+					rotation.how, wallKick, tail);
+		}
+
+		// Expand the node with drops, where the soft drop
+		// must stop after the same steps as playground.
+		if(grounded) continue;
+		visit(x, y - 1, dir, node,
+			tileInput::dropOne, false, tail);
+		int8_t ny = std::max<int8_t>(land(x, y, dir), y - 20);
+		visit(x, ny, dir, node, tileInput::softDrop, false, tail);
+	}
+	return numPlacements;
+}
+
+size_t placementFinder::retrievePath(
+	const tilePlacement& placement, tileInput rinput[]) const {
+	uint16_t node = placement.node;
+	size_t length = depth[node];
+	for(size_t i = length; i > 0; -- i) {
+		rinput[i - 1] = input[node];
+		node = parent[node];
+	}
+	return length;
+}
+
+bool placementFinder::isPlaced(const tileState& state) const {
+	if(typ == nullptr) return false;
+	uint8_t dir = state.dir.getValue();
+	int x = state.x + canonicalX[dir], y = state.y + canonicalY[dir];
+	if(x < minX || x >= minX + numColumns) return false;
+	if(y < minY || y >= minY + numRows) return false;
+	uint16_t canonical = nodeOf(int8_t(x), int8_t(y), canonicalDir[dir]);
+	return (placed[canonical >> 6] & (uint64_t(1) << (canonical & 63))) != 0;
+}
+
+} // namespace hacktile::model
+} // namespace hacktile
@@ -9,6 +9,8 @@
  * notifies renderer and controller about updates.
  */
 #include "model/playground.hpp"
+#include <stdexcept>
+#include <type_traits>
 
 namespace hacktile {
 namespace model {
@@ -17,7 +19,8 @@ playground::playground(tileGenerator* generator, int numPreviews):
 	f(), generator(generator), swap(nullptr), swapEnabled(true),
 	current(), shadow(), preview(new const tile*[numPreviews]),
 	numPreviews(numPreviews), previewCursor(0),
-	state(playgroundState::notStarted) {
+	state(playgroundState::notStarted), rule(spinRule::tSpin),
+	generatorHandle(0), generatorEpoch(0) {
 
 	// Initalize the initial preview tiles in the playground.
 	for(int i = 0; i < numPreviews; ++ i)
@@ -46,8 +49,10 @@ void playground::spawnNextTile() {
 		previous = preview[numPreviews-1];
 	else previous = preview[previewCursor-1];
 	const tile* next = nullptr;
-	if(previous != nullptr)
+	if(previous != nullptr) {
 		next = generator->generate();
+		generatorHandle = 0;
+	}
 	preview[previewCursor] = next;
 	++previewCursor;
 	if(previewCursor >= numPreviews) previewCursor = 0;
@@ -166,6 +171,7 @@ bool playground::hardDrop() {
 	drop(20);
 	const tile& type = *current.getType();
 	tileState location = current.getState();
+	tileSpin spin = f.spinOf(current, rule);
 
 	// Now the tile is moved and is on the ground, dispatch
 	// the before lock event to trigger calculation.
@@ -187,6 +193,7 @@ bool playground::hardDrop() {
 		.type     = type,
 		.location = location,
 		.clear    = clear,
+		.spin     = spin,
 	};
 	dispatch(&playgroundListener::tileLock, afterEvent);
 
@@ -225,5 +232,72 @@ bool playground::swapTile() {
 	return true;
 }
 
+bool playground::input(tileInput in) {
+	switch(in) {
+	case tileInput::moveLeft:  return move(-1);
+	case tileInput::moveRight: return move(+1);
+	case tileInput::rotateCW:  return rotateCW();
+	case tileInput::rotateCCW: return rotateCCW();
+	case tileInput::halfTurn:  return halfTurn();
+	case tileInput::dropOne:   return drop(1);
+	case tileInput::softDrop:  return drop(20);
+	}
+	return false;
+}
+
+static_assert(std::is_trivially_copyable<playgroundSnapshot>::value,
+	"playground snapshot must be trivially copyable");
+
+void playground::save(playgroundSnapshot& snapshot, snapshotArena& arena) {
+	if(numPreviews > playgroundSnapshot::maxNumPreviews)
+		throw std::runtime_error("too many previews to save");
+	f.save(snapshot.fieldState, arena);
+	snapshot.current = current.getType();
+	snapshot.currentState = current.getState();
+	snapshot.shadowState = shadow.getState();
+	snapshot.swap = swap;
+	snapshot.swapEnabled = swapEnabled;
+	snapshot.state = state;
+	for(int i = 0; i < numPreviews; ++ i)
+		snapshot.preview[i] = getPreview(i);
+
+	// The generator state is large, so it is saved only
+	// when a tile has been generated since last snapshot.
+	if(generatorHandle == 0 || generatorEpoch != arena.getEpoch()) {
+		generatorHandle = arena.pushState(generator->stateSize());
+		generatorEpoch = arena.getEpoch();
+		generator->saveState(arena.stateAt(generatorHandle));
+	}
+	snapshot.generatorState = generatorHandle;
+}
+
+void playground::restore(
+	const playgroundSnapshot& snapshot, const snapshotArena& arena) {
+	f.restore(snapshot.fieldState, arena);
+	swap = snapshot.swap;
+	swapEnabled = snapshot.swapEnabled;
+	state = snapshot.state;
+	for(int i = 0; i < numPreviews; ++ i)
+		preview[i] = snapshot.preview[i];
+	previewCursor = 0;
+	if(generatorHandle != snapshot.generatorState ||
+		generatorEpoch != arena.getEpoch()) {
+		generator->restoreState(arena.stateAt(snapshot.generatorState));
+		generatorHandle = snapshot.generatorState;
+		generatorEpoch = arena.getEpoch();
+	}
+
+	// The path finders must be validated against the field
+	// again, since the field version has been changed.
+	current = tilePathFinder();
+	shadow = tilePathFinder();
+	if(snapshot.current != nullptr) {
+		current = tilePathFinder(snapshot.current, snapshot.currentState);
+		shadow = tilePathFinder(snapshot.current, snapshot.shadowState);
+		f.spawn(current);
+		f.spawn(shadow);
+	}
+}
+
 } // namespace hacktile::model
 } // namespace hacktile
@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file random.cpp
+ * @author aegistudio
+ * @brief Implementation of the pseudo randomizers.
+ *
+ * This file implements the seeding and jumping of xoshiro256,
+ * following the reference implementation by David Blackman
+ * and Sebastiano Vigna.
+ */
+#include "model/random.hpp"
+
+namespace hacktile {
+namespace model {
+
+xoshiro256::xoshiro256(uint64_t seed) {
+	// Expand the seed by splitmix64, which never yields the
+	// all-zero state out of 4 consecutive outputs.
+	for(int i = 0; i < 4; ++ i) {
+		uint64_t z = (seed += 0x9e3779b97f4a7c15ull);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		s[i] = z ^ (z >> 31);
+	}
+}
+
+void xoshiro256::applyJump(const uint64_t polynomial[4]) {
+	uint64_t t[4] = { 0, 0, 0, 0 };
+	for(int i = 0; i < 4; ++ i)
+		for(int b = 0; b < 64; ++ b) {
+			if(polynomial[i] & (uint64_t(1) << b))
+				for(int j = 0; j < 4; ++ j) t[j] ^= s[j];
+			(*this)();
+		}
+	std::copy(t, t + 4, s);
+}
+
+void xoshiro256::jump() {
+	static const uint64_t polynomial[4] = {
+		0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull,
+		0xa9582618e03fc9aaull, 0x39abdc4529b1661cull,
+	};
+	applyJump(polynomial);
+}
+
+void xoshiro256::longJump() {
+	static const uint64_t polynomial[4] = {
+		0x76e15d3efefdcbbfull, 0xc5004e441c522fb3ull,
+		0x77710069854ee241ull, 0x39109bb02acbe635ull,
+	};
+	applyJump(polynomial);
+}
+
+} // namespace hacktile::model
+} // namespace hacktile
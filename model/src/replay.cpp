@@ -0,0 +1,324 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file replay.cpp
+ * @author aegistudio
+ * @brief Implementation of the replay recorder and reader.
+ *
+ * This file implements the bit packing of the placements,
+ * and the mapping of the replay files. The placements are
+ * evaluated against the skyline of the field, so that the
+ * replay is played back by locking the tiles, without the
+ * inputs that have moved them there.
+ */
+#include "model/replay.hpp"
+#include <algorithm>
+#include <climits>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace hacktile {
+namespace model {
+
+constexpr uint32_t replayHeader::magic;
+constexpr uint8_t replayHeader::currentVersion;
+constexpr size_t replayHeader::size;
+
+// xOffset is the offset of the column to encode, which is
+// the leftmost column of the tiles inside the field.
+static constexpr int xOffset = 6;
+
+// blockSize is the bytes to buffer before writing.
+static constexpr size_t blockSize = 4096;
+
+int replayHeader::typeBits() const {
+	int n = 1;
+	while((1 << n) <= numTiles) ++ n;
+	return n;
+}
+
+int landingOf(const field& f, const tile& typ, tileDirection dir, int8_t x) {
+	int landing = INT_MIN;
+	for(uint8_t c = 0; c < 6; ++ c) {
+		int8_t b = typ.bottomAt(dir, c);
+		if(b < 0) continue;
+		int column = x + c;
+		if(column < 0 || column >= 10) continue;
+		landing = std::max(landing, int(f.columnHeight(column)) - b);
+	}
+	return landing;
+}
+
+replayPlacement placementOf(const field& f, const tile& typ,
+	uint8_t type, bool swapped, tileState state) {
+	replayPlacement placement;
+	placement.type = type;
+	placement.swapped = swapped;
+	placement.dir = state.dir.getValue();
+	placement.x = state.x;
+	int depth = landingOf(f, typ, state.dir, state.x) - state.y;
+	placement.depth = uint8_t(std::max(0, std::min(depth, 255)));
+	return placement;
+}
+
+tileState stateOf(const field& f, const tile& typ,
+	const replayPlacement& placement) {
+	tileState state;
+	state.dir = tileDirection(placement.dir);
+	state.x = placement.x;
+	state.y = int8_t(landingOf(f, typ, state.dir,
+		placement.x) - placement.depth);
+	return state;
+}
+
+bool replayLock(field& f, const tile& typ,
+	const replayPlacement& placement, uint8_t& clear) {
+	tilePathFinder pfd(&typ, stateOf(f, typ, placement));
+	if(!f.spawn(pfd)) return false;
+	tilePathFinder below;
+	if(f.drop(pfd, 1, below)) return false;
+	return f.lock(pfd, clear);
+}
+
+replayRecorder::replayRecorder(playground& play, int fd,
+	const replayHeader& header, const tile* const tiles[]):
+	play(play), tiles(tiles), fd(fd), header(header),
+	subscription(play.subscribe(this)), buffer(), bits(0),
+	numBits(0), swapped(false), finished(false), numPlacements(0),
+	failure() {
+	buffer.reserve(blockSize + 16);
+	uint8_t data[replayHeader::size];
+	for(int i = 0; i < 4; ++ i)
+		data[i] = uint8_t(replayHeader::magic >> (8 * i));
+	data[4] = header.version;
+	data[5] = uint8_t(header.generator);
+	data[6] = header.numTiles;
+	data[7] = header.numPreviews;
+	for(int i = 0; i < 8; ++ i)
+		data[8 + i] = uint8_t(header.seed >> (8 * i));
+	data[16] = uint8_t(header.randomizer);
+	data[17] = uint8_t(header.history);
+	for(size_t i = 18; i < replayHeader::size; ++ i) data[i] = 0;
+	buffer.insert(buffer.end(), data, data + replayHeader::size);
+}
+
+replayRecorder::~replayRecorder() {
+	try {
+		finish();
+	} catch(...) {}
+}
+
+void replayRecorder::append(uint64_t value, int n) {
+	bits |= (value & ((uint64_t(1) << n) - 1)) << numBits;
+	numBits += n;
+	while(numBits >= 8) {
+		buffer.push_back(uint8_t(bits));
+		bits >>= 8;
+		numBits -= 8;
+	}
+}
+
+void replayRecorder::fail(const std::string& reason) {
+	if(failure.empty()) failure = reason;
+	finished = true;
+}
+
+void replayRecorder::writeOut() {
+	if(!failure.empty()) return;
+	size_t written = 0;
+	while(written < buffer.size()) {
+		ssize_t n = ::write(fd, buffer.data() + written,
+			buffer.size() - written);
+		if(n < 0) {
+			if(errno == EINTR) continue;
+			fail(std::string("cannot write replay: ") + ::strerror(errno));
+			break;
+		}
+		written += size_t(n);
+	}
+	buffer.erase(buffer.begin(), buffer.begin() + written);
+}
+
+void replayRecorder::terminate() {
+	if(finished) return;
+	finished = true;
+	append(header.numTiles, header.typeBits());
+	if(numBits > 0) append(0, 8 - numBits);
+	writeOut();
+}
+
+void replayRecorder::check() const {
+	if(!failure.empty()) throw std::runtime_error(failure);
+}
+
+void replayRecorder::flush() {
+	writeOut();
+	check();
+}
+
+void replayRecorder::finish() {
+	terminate();
+	check();
+}
+
+void replayRecorder::tileBeforeLock(const tileBeforeLockEvent& event) {
+	if(finished) return;
+	uint8_t type = 0;
+	while(type < header.numTiles && tiles[type] != &event.type) ++ type;
+	if(type == header.numTiles) {
+		fail("tile not in the replay");
+		return;
+	}
+	replayPlacement placement = placementOf(play.getField(),
+		event.type, type, swapped, event.location);
+	swapped = false;
+
+	append(placement.type, header.typeBits());
+	append(placement.swapped? 1 : 0, 1);
+	append(placement.dir, 2);
+	append(uint64_t(placement.x + xOffset), 4);
+	if(placement.depth == 0) append(0, 1);
+	else {
+		// The Elias gamma code is the bits of the depth
+		// from the most significant bit, after the zeros
+		// as many as the bits following it.
+		int n = 0;
+		while((placement.depth >> (n + 1)) != 0) ++ n;
+		append(1, 1);
+		append(0, n);
+		for(int i = n; i >= 0; -- i)
+			append((placement.depth >> i) & 1, 1);
+	}
+	++ numPlacements;
+	if(buffer.size() >= blockSize) writeOut();
+}
+
+void replayRecorder::tileSwap(const tileSwapEvent&) {
+	swapped = true;
+}
+
+void replayRecorder::gameEnd(const gameEndEvent&) {
+	terminate();
+}
+
+replayCursor::replayCursor(const replayHeader& header,
+	const uint8_t* data, size_t size): data(data),
+	numBits(size > replayHeader::size?
+		(size - replayHeader::size) * 8 : 0),
+	bit(0), numTiles(header.numTiles),
+	typeBits(header.typeBits()), ended(false) {
+	this->data += std::min(size, replayHeader::size);
+}
+
+bool replayCursor::read(int n, uint32_t& value) {
+	if(numBits - bit < size_t(n)) return false;
+	value = 0;
+	for(int i = 0; i < n; ++ i, ++ bit)
+		value |= uint32_t((data[bit >> 3] >> (bit & 7)) & 1) << i;
+	return true;
+}
+
+bool replayCursor::next(replayPlacement& placement) {
+	// The cursor is rewound on the truncated placement, so
+	// that it stays at the end of the replay.
+	size_t start = bit;
+	uint32_t type, swapped, dir, x, tucked;
+	if(!read(typeBits, type)) return false;
+	if(type >= numTiles) {
+		ended = type == numTiles;
+		bit = start;
+		return false;
+	}
+	if(!read(1, swapped) || !read(2, dir) ||
+		!read(4, x) || !read(1, tucked)) {
+		bit = start;
+		return false;
+	}
+	uint32_t depth = 0;
+	if(tucked) {
+		int n = 0;
+		uint32_t b = 0;
+		while(read(1, b) && b == 0) ++ n;
+		if(b == 0 || n > 7 || !read(n, depth)) {
+			bit = start;
+			return false;
+		}
+
+		// The bits following the leading 1 are read with
+		// the least significant bit first, reverse them.
+		uint32_t value = 1;
+		for(int i = 0; i < n; ++ i)
+			value = (value << 1) | ((depth >> i) & 1);
+		depth = value;
+	}
+	placement.type = uint8_t(type);
+	placement.swapped = swapped != 0;
+	placement.dir = uint8_t(dir);
+	placement.x = int8_t(int(x) - xOffset);
+	placement.depth = uint8_t(depth);
+	return true;
+}
+
+bool replayReader::parseHeader(const uint8_t* data,
+	size_t size, replayHeader& header) {
+	if(size < replayHeader::size) return false;
+	uint32_t magic = 0;
+	for(int i = 0; i < 4; ++ i) magic |= uint32_t(data[i]) << (8 * i);
+	if(magic != replayHeader::magic) return false;
+	if(data[4] != replayHeader::currentVersion) return false;
+	if(data[5] > uint8_t(replayGenerator::historyRoll)) return false;
+	if(data[6] == 0) return false;
+	if(data[16] > uint8_t(replayRandomizer::xoshiro256)) return false;
+	if(data[17] > uint8_t(replayHistory::zszs)) return false;
+	header.version = data[4];
+	header.generator = replayGenerator(data[5]);
+	header.numTiles = data[6];
+	header.numPreviews = data[7];
+	header.seed = 0;
+	for(int i = 0; i < 8; ++ i)
+		header.seed |= uint64_t(data[8 + i]) << (8 * i);
+	header.randomizer = replayRandomizer(data[16]);
+	header.history = replayHistory(data[17]);
+	return true;
+}
+
+replayReader::replayReader(const char* path):
+	data(nullptr), size(0), header() {
+	int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+	if(fd < 0) throw std::runtime_error(std::string(
+		"cannot open replay: ") + ::strerror(errno));
+	struct stat st;
+	if(::fstat(fd, &st) < 0) {
+		int err = errno;
+		::close(fd);
+		throw std::runtime_error(std::string(
+			"cannot stat replay: ") + ::strerror(err));
+	}
+	size = size_t(st.st_size);
+	void* mapped = size > 0? ::mmap(nullptr, size,
+		PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+	int err = errno;
+	::close(fd);
+	if(mapped == MAP_FAILED) {
+		if(size == 0) throw std::runtime_error("not a replay");
+		throw std::runtime_error(std::string(
+			"cannot map replay: ") + ::strerror(err));
+	}
+	data = (const uint8_t*)mapped;
+	if(!parseHeader(data, size, header)) {
+		::munmap((void*)data, size);
+		throw std::runtime_error("not a replay");
+	}
+}
+
+replayReader::~replayReader() {
+	::munmap((void*)data, size);
+}
+
+} // namespace hacktile::model
+} // namespace hacktile
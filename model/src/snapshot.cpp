@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file snapshot.cpp
+ * @author aegistudio
+ * @brief Implementation of the field snapshots.
+ *
+ * This file implements the snapshot arena, and the saving
+ * and restoring of the field. The field tracks the handles
+ * of its rows in the arena, which are reset to 0 once the
+ * row is modified, so that both operations only need to
+ * copy the rows modified since the last snapshot.
+ */
+#include "model/snapshot.hpp"
+#include <atomic>
+
+namespace hacktile {
+namespace model {
+
+uint64_t snapshotArena::newEpoch() {
+	static std::atomic<uint64_t> nextEpoch(1);
+	return nextEpoch.fetch_add(1, std::memory_order_relaxed);
+}
+
+snapshotArena::snapshotArena(): rows(1), words(1), epoch(newEpoch()) {}
+
+void snapshotArena::rewind(const mark& m) {
+	// The handles after the mark will be reused, so the
+	// handles tracked with the previous epoch are invalid.
+	rows.resize(std::max(m.numRows, size_t(1)));
+	words.resize(std::max(m.numWords, size_t(1)));
+	epoch = newEpoch();
+}
+
+void field::save(fieldSnapshot& snapshot, snapshotArena& arena) {
+	if(handleEpoch != arena.getEpoch()) {
+		for(int y = 0; y < rowHandles.size(); ++ y) rowHandles[y] = 0;
+		handleEpoch = arena.getEpoch();
+	}
+	snapshot.compactFields = compactFields;
+	snapshot.hash = hash;
+	std::copy(heights, heights + 10, snapshot.heights);
+	snapshot.numRows = uint8_t(fields.size());
+	for(int y = 0; y < fields.size(); ++ y) {
+		if(rowHandles[y] == 0) rowHandles[y] = arena.pushRow(fields[y]);
+		snapshot.rows[y] = rowHandles[y];
+	}
+}
+
+void field::restore(const fieldSnapshot& snapshot, const snapshotArena& arena) {
+	if(handleEpoch != arena.getEpoch()) {
+		for(int y = 0; y < rowHandles.size(); ++ y) rowHandles[y] = 0;
+		handleEpoch = arena.getEpoch();
+	}
+	compactFields = snapshot.compactFields;
+	hash = snapshot.hash;
+	std::copy(snapshot.heights, snapshot.heights + 10, heights);
+	fields.resize(snapshot.numRows);
+	rowHandles.resize(snapshot.numRows);
+	for(int y = 0; y < snapshot.numRows; ++ y) {
+		if(rowHandles[y] == snapshot.rows[y]) continue;
+		fields[y] = arena.rowAt(snapshot.rows[y]);
+		rowHandles[y] = snapshot.rows[y];
+	}
+
+	// The version must never be reused, or the path finders
+	// of other snapshots might be considered valid.
+	++ version;
+}
+
+} // namespace hacktile::model
+} // namespace hacktile
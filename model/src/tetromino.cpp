@@ -7,7 +7,9 @@
  *
  * This file implements the logic of tetromino, including the
  * initialization of certain tile data, commonly used wall
- * kick table, and so on.
+ * kick table, and so on. The tables generated at compile
+ * time are also defined here, so that they have a unique
+ * address in the program.
  */
 #include "model/tetromino.hpp"
 #include <stdexcept>
@@ -16,6 +18,13 @@
 namespace hacktile {
 namespace model {
 
+constexpr uint8_t tetrominoTable::kicks3x3[4][tile::maxNumRotations];
+constexpr uint8_t tetrominoTable::kicksNone[4][tile::maxNumRotations];
+constexpr uint8_t tetrominoTable::kicksI[4][tile::maxNumRotations];
+constexpr tileShape tetrominoTable::shapes[7];
+constexpr tile tetrominoTable::tiles[7];
+constexpr const tile* tetrominoTable::pointers[7];
+
 void createTetrominoTileData(
 	tileData result, tetromino typ, uint8_t value) {
 
@@ -369,17 +378,48 @@ void createTetrominoRotation(
 		throw std::runtime_error("invalid tetromino type");
 	}
 
-	// Inverse transform for the reversed operations.
+	// Inverse transform for the reversed operations, which
+	// must only be applied to the clockwise rotations, or
+	// the empty ones will overwrite the reversed ones.
+	for(int i = 0; i < 4; ++ i) {
+		int j = (i + 1) & 0x03;
+		for(int k = 0; k < 5; ++ k) {
+			tileCoord coord;
+			coord.value = result[i][j][k];
+			if(coord.value == 0) {
+				result[j][i][k] = 0;
+				break;
+			}
+			coord.x = -coord.x;
+			coord.y = -coord.y;
+			result[j][i][k] = coord.value;
+		}
+	}
+}
+
+void createTetrominoSpinCorners(
+	tileSpinCorners result, tetromino typ) {
+
+	// Initialize all corners with 0 value.
 	for(int i = 0; i < 4; ++ i)
 		for(int j = 0; j < 4; ++ j)
-			for(int k = 0; k < 5; ++ k) {
-				tileCoord coord;
-				coord.value = result[i][j][k];
-				if(coord.value == 0) break;
-				coord.x = -coord.x;
-				coord.y = -coord.y;
-				result[j][i][k] = coord.value;
-			}
+			result[i][j] = 0;
+	if(typ != tetromino::T) return;
+
+	// The corners are around the center of tetromino::T,
+	// which is always at (2, 2), and the front corners are
+	// the ones beside the pixel pointed to by the tile.
+	const uint8_t topLeft     = tileCoordAt(1, 3);
+	const uint8_t topRight    = tileCoordAt(3, 3);
+	const uint8_t bottomLeft  = tileCoordAt(1, 1);
+	const uint8_t bottomRight = tileCoordAt(3, 1);
+	const uint8_t corners[4][4] = {
+		{ topLeft,     topRight,    bottomLeft,  bottomRight },
+		{ topRight,    bottomRight, topLeft,     bottomLeft  },
+		{ bottomLeft,  bottomRight, topLeft,     topRight    },
+		{ topLeft,     bottomLeft,  topRight,    bottomRight },
+	};
+	memcpy(result, corners, sizeof(corners));
 }
 
 } // namespace hacktile::model
@@ -16,17 +16,20 @@
 #include "model/tile.hpp"
 #include <stdexcept>
 #include <type_traits>
+#include <climits>
 
 namespace hacktile {
 namespace model {
 
-tile::tile(tile::dataType input, tile::rotationType rotation) {
+tile::tile(tile::dataType input, tile::rotationType rotation,
+	tile::spinCornerType corners) {
 	// Initialize coordinate data of the tile.
 	for(uint8_t i = 0; i < 4; ++ i) {
 		uint8_t numPixels = 0;
 		tileCoord vmin; vmin.value = 0;
 		tileCoord vmax; vmax.value = 0;
 		compactTile[i] = 0;
+		for(uint8_t x = 0; x < 6; ++ x) bottom[i][x] = -1;
 		for(uint8_t y = 0; y < 6; ++ y) {
 			for(uint8_t x = 0; x < 6; ++ x) {
 				uint8_t v = input[i][5-y][x];
@@ -37,6 +40,7 @@ tile::tile(tile::dataType input, tile::rotationType rotation) {
 				data[i][numPixels] = v;
 				loc[i][numPixels] = tileCoordAt(x, y);
 				compactTile[i] |= (uint64_t(1)<<x) << (10*y);
+				if(bottom[i][x] < 0) bottom[i][x] = y;
 				if(vmin.x == 0 || vmin.x > x) vmin.x = x;
 				if(vmin.y == 0 || vmin.y > y) vmin.y = y;
 				if(vmax.x == 0 || vmax.x < x) vmax.x = x;
@@ -67,6 +71,12 @@ tile::tile(tile::dataType input, tile::rotationType rotation) {
 				rotateTable[i][j][numRotations] = 0;
 		}
 	}
+
+	// Initialize spin corners of the tile, which are all 0
+	// when the tile is not recognized by its corners.
+	for(uint8_t i = 0; i < 4; ++ i)
+		for(uint8_t j = 0; j < 4; ++ j)
+			spinCorners[i][j] = corners != nullptr? corners[i][j] : 0;
 }
 
 tileState tile::initTileState() const {
@@ -111,10 +121,7 @@ bool field::spawn(tilePathFinder& pfd) const {
 	if(pfd.typ == nullptr)
 		throw std::runtime_error("tile not specified");
 	tileState state = pfd.state;
-	pfd.current = compactField();
-	for(int i = 6; i > 0; -- i) pfd.current =
-		pfd.current.fieldDown(
-			compactRowAt(state.y + i - 1));
+	pfd.current = compactWindowAt(state.y);
 	if(!isValid(pfd)) return false;
 	envalidate(pfd);
 	return true;
@@ -175,18 +182,40 @@ bool field::drop(const tilePathFinder& pfd,
 	uint8_t numSteps, tilePathFinder& result) const {
 	assertLegit(pfd);
 	result = tilePathFinder();
+	tileState state = pfd.getState();
+	uint8_t dir = state.dir.getValue();
+	const auto& typ = *pfd.typ;
 
-	// TODO: skip over empty lines so that we will only
-	// need to consider lines with tile.
+	// If every column of the tile is above the skyline,
+	// the tile will land when any of its column reaches
+	// the skyline, and we could skip over empty lines.
+	bool aboveSkyline = true;
+	int landing = INT_MIN;
+	for(uint8_t c = 0; c < 6; ++ c) {
+		int8_t b = typ.bottom[dir][c];
+		if(b < 0) continue;
+		int height = heights[state.x + c];
+		if(state.y + b < height) {
+			aboveSkyline = false;
+			break;
+		}
+		landing = std::max(landing, height - b);
+	}
+	if(aboveSkyline) {
+		int target = std::max(landing, state.y - numSteps);
+		if(target >= state.y) return false;
+		result = tilePathFinder(pfd.typ, state);
+		result.state.y = target;
+		result.current = compactWindowAt(target);
+		envalidate(result);
+		return true;
+	}
 
 	// From now on, move one line at a time until there's
 	// no more step to move or next step will collide with
 	// the current line.
-	tileState state = pfd.getState();
-	uint8_t dir = state.dir.getValue();
 	result = tilePathFinder(pfd.typ, state);
 	result.current = pfd.current;
-	const auto& typ = *pfd.typ;
 	uint8_t inSteps = numSteps;
 	compactField tile = typ.compactTile[dir];
 	tile = tile.tileMove(state.x);
@@ -222,6 +251,7 @@ bool field::rotate(const tilePathFinder& pfd,
 	result = tilePathFinder(pfd.typ, state);
 	result.state.dir = targetDir;
 	result.current = pfd.current;
+	result.previousRotation = true;
 
 	// Judge whether the initial state is valid.
 	if(isValid(result)) {
@@ -244,21 +274,15 @@ bool field::rotate(const tilePathFinder& pfd,
 		// specified rotation state.
 		result.state.x = state.x + coord.x;
 		int8_t newStateY = state.y + coord.y;
-		while(result.state.y < newStateY) {
-			result.current = result.current.fieldUp(
-				compactRowAt(result.state.y + 6));
-			++ result.state.y;
-		}
-		while(result.state.y > newStateY) {
-			result.current = result.current.fieldDown(
-				compactRowAt(result.state.y - 1));
-			-- result.state.y;
+		if(result.state.y != newStateY) {
+			result.current = compactWindowAt(newStateY);
+			result.state.y = newStateY;
 		}
 
 		// Terminate the attempt once we've found a
 		// valid rotation state.
 		if(isValid(result)) {
-			result.previousWallKick = true;
+			result.previousKick = value;
 			envalidate(result);
 			return true;
 		}
@@ -270,6 +294,55 @@ bool field::rotate(const tilePathFinder& pfd,
 	return false;
 }
 
+tileSpin field::spinOf(const tilePathFinder& pfd, spinRule rule) const {
+	assertLegit(pfd);
+	if(!pfd.previousRotation) return tileSpin::none;
+	tileState state = pfd.getState();
+	uint8_t dir = state.dir.getValue();
+	const auto& typ = *pfd.typ;
+	uint64_t window = pfd.current.getValue();
+
+	// The corners are tested against the window of the
+	// path finder, where the rows below the floor are solid
+	// and the columns outside the walls are filled.
+	if(typ.spinCorners[dir][0] != 0) {
+		int numCorners = 0, numFront = 0;
+		for(int i = 0; i < 4; ++ i) {
+			tileCoord coord; coord.value = typ.spinCorners[dir][i];
+			int x = state.x + coord.x;
+			bool filled = x < 0 || x >= 10 ||
+				((window >> (10 * coord.y + x)) & 1) != 0;
+			if(!filled) continue;
+			++ numCorners;
+			if(i < 2) ++ numFront;
+		}
+		if(numCorners < 3) return tileSpin::none;
+		tileCoord kick = pfd.getPreviousKick();
+		if(numFront == 2 || kick.y == 2 || kick.y == -2)
+			return tileSpin::full;
+		return tileSpin::mini;
+	}
+	if(rule == spinRule::tSpin) return tileSpin::none;
+
+	// Other tiles must be unable to move left, right or up.
+	// Moving up is tested by moving the window down, unless
+	// the tile reaches the top row of the window.
+	compactField tile(typ.compactTile[dir]);
+	tileCoord min; min.value = typ.min[dir];
+	tileCoord max; max.value = typ.max[dir];
+	if(state.x + min.x > 0 &&
+		!pfd.current.collide(tile.tileMove(state.x - 1)))
+		return tileSpin::none;
+	if(state.x + max.x < 9 &&
+		!pfd.current.collide(tile.tileMove(state.x + 1)))
+		return tileSpin::none;
+	compactField above = max.y < 5? compactField(window >> 10)
+		: compactWindowAt(state.y + 1);
+	if(!above.collide(tile.tileMove(state.x)))
+		return tileSpin::none;
+	return rule == spinRule::allSpin? tileSpin::full : tileSpin::mini;
+}
+
 bool field::lock(const tilePathFinder& pfd, uint8_t& clear) {
 	assertLegit(pfd);
 	clear = 0;
@@ -286,10 +359,13 @@ bool field::lock(const tilePathFinder& pfd, uint8_t& clear) {
 	uint8_t dir = state.dir.getValue();
 	tileCoord min; min.value = typ.min[dir];
 	tileCoord max; max.value = typ.max[dir];
-	while(state.y + max.y >= fields.size()) {
-		fields.push_back(fieldRow());
-		compactFields.push_back(0);
+	if(state.y + max.y >= fields.size()) {
+		fields.resize(std::min(state.y + max.y + 1, int(maxHeight)));
+		rowHandles.resize(fields.size());
 	}
+	int lowest = state.y + min.y;
+	int highest = std::min(state.y + max.y + 1, int(maxHeight));
+	hash ^= hashRows(lowest, highest);
 	for(uint8_t n = 0; n < tile::maxNumPixels; ++ n) {
 		uint8_t data = typ.data[dir][n];
 		if(data == 0) break;
@@ -297,19 +373,34 @@ bool field::lock(const tilePathFinder& pfd, uint8_t& clear) {
 		uint8_t x = state.x + loc.x;
 		uint8_t y = state.y + loc.y;
 
-		// Add data of current tile to the field.
+		// Add data of current tile to the field, and the
+		// cells above the maximum height are dropped.
+		if(y >= maxHeight) continue;
 		fields[y][x] = data;
-		compactFields[y] |= (1<<x);
+		rowHandles[y] = 0;
+		compactFields.fill(y, 1<<x);
+		if(heights[x] <= y) heights[x] = y + 1;
 	}
 
-	// Erase the rows that has already been occupied.
+	hash ^= hashRows(lowest, highest);
+
+	// Erase the rows that has already been occupied, all
+	// at once so that each row is moved at most once.
+	uint8_t erased[6];
 	for(uint8_t j = min.y; j <= max.y; ++ j) {
-		uint8_t row = state.y + j - clear;
-		if(compactFields[row] == solidRow) {
-			fields.erase(fields.begin() + row);
-			compactFields.erase(compactFields.begin() + row);
-			++ clear;
-		}
+		uint8_t row = state.y + j;
+		if(compactFields.rowAt(row) == solidRow)
+			erased[clear ++] = row;
+	}
+	if(clear > 0) {
+		// The keys of the rows above the lowest erased row
+		// are changed since they are moved down.
+		hash ^= hashRows(erased[0], fields.size());
+		fields.erase(erased, clear);
+		rowHandles.erase(erased, clear);
+		compactFields.erase(erased, clear);
+		hash ^= hashRows(erased[0], fields.size());
+		evaluateHeights();
 	}
 	++ version;
 	return true;
@@ -319,10 +410,51 @@ void field::grow(fieldRow row) {
 	uint16_t compactLine = 0;
 	for(int i = 0; i < 10; ++ i) 
 		compactLine |= (row[i] != 0)? (1<<i) : 0;
-	fields.insert(fields.begin(), std::move(row));
-	compactFields.insert(compactFields.begin(), compactLine);
+	bool overflow = fields.size() >= maxHeight;
+
+	// Raising all rows rotates their keys by one bit, after
+	// the key of the highest row dropped is excluded.
+	if(overflow)
+		hash ^= rowKey(maxHeight - 1, compactRowAt(maxHeight - 1));
+	hash = rotateKey(hash, 1) ^ rowKey(0, compactLine);
+	fields.insertBottom(row);
+	rowHandles.insertBottom(0);
+	compactFields.insertBottom(compactLine);
+
+	// Every column is raised by the new row, unless the
+	// highest row is dropped, which requires evaluation.
+	if(overflow) {
+		fields.resize(maxHeight);
+		rowHandles.resize(maxHeight);
+		evaluateHeights();
+	} else for(int i = 0; i < 10; ++ i) {
+		if(heights[i] > 0) ++ heights[i];
+		else if((compactLine & (1<<i)) != 0) heights[i] = 1;
+	}
 	++ version;
 }
 
+uint64_t field::hashRows(int from, int to) const {
+	uint64_t result = 0;
+	for(int y = from; y < to; ++ y)
+		result ^= rowKey(y, compactFields.rowAt(y));
+	return result;
+}
+
+void field::evaluateHeights() {
+	// Scan from the top row downward, until every column
+	// has found its highest cell.
+	uint16_t found = 0;
+	for(int i = 0; i < 10; ++ i) heights[i] = 0;
+	for(int y = fields.size() - 1; y >= 0; -- y) {
+		uint16_t row = compactRowAt(y) & ~found;
+		if(row == 0) continue;
+		for(int i = 0; i < 10; ++ i)
+			if((row & (1<<i)) != 0) heights[i] = y + 1;
+		found |= row;
+		if(found == solidRow) break;
+	}
+}
+
 } // namespace hacktile::model
 } // namespace hacktile
@@ -0,0 +1,192 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file timing.cpp
+ * @author aegistudio
+ * @brief Implementation of the timing engine.
+ *
+ * This file implements the timing engine, which schedules
+ * the shift, fall and lock of the tile by the ticks, and
+ * reschedules them whenever the tile is spawned or moved,
+ * no matter whether it is moved by the engine or the caller.
+ */
+#include "model/timing.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace hacktile {
+namespace model {
+
+constexpr uint64_t timingEngine::never;
+
+uint64_t gravityOfLevel(int level) {
+	if(level < 1) level = 1;
+	double seconds = std::pow(0.8 - (level - 1) * 0.007, level - 1);
+	return std::max(uint64_t(seconds * ticksPerSecond + 0.5), uint64_t(1));
+}
+
+timingEngine::timingEngine(playground& play, const timingConfig& config):
+	play(play), config(config), subscription(play.subscribe(this)),
+	now(0), leftHeld(false), rightHeld(false), softDropHeld(false),
+	shift(0), shiftCharged(false), lockResets(config.maxLockResets),
+	lowestY(0), nextShift(never), nextFall(never), lockDeadline(never) {
+	if(play.isInGame() && play.getCurrentTile() != nullptr) {
+		lowestY = play.getCurrentState().y;
+		reschedule();
+	}
+}
+
+uint64_t timingEngine::fallInterval() const {
+	return softDropHeld? config.softDropGravity : config.gravity;
+}
+
+bool timingEngine::isGrounded() const {
+	return play.getCurrentState().y == play.getShadowState().y;
+}
+
+uint64_t timingEngine::nextDeadline() const {
+	return std::min(nextShift, std::min(nextFall, lockDeadline));
+}
+
+void timingEngine::reschedule() {
+	if(!play.isInGame() || play.getCurrentTile() == nullptr) {
+		nextFall = never;
+		lockDeadline = never;
+		return;
+	}
+
+	// The tile on the ground waits for locking, which will
+	// not be delayed by falling onto the ground again.
+	if(isGrounded()) {
+		nextFall = never;
+		if(lockDeadline == never) lockDeadline = now + config.lockDelay;
+		return;
+	}
+	lockDeadline = never;
+	if(softDropHeld && config.softDropGravity == 0) nextFall = now;
+	else if(fallInterval() == 0) nextFall = never;
+	else if(nextFall == never) nextFall = now + fallInterval();
+}
+
+void timingEngine::step(uint64_t tick) {
+	now = tick;
+	if(nextShift == tick) {
+		// The shift without repeat rate moves to the end,
+		// and will be scheduled again once the tile moves.
+		shiftCharged = true;
+		if(config.arr == 0) {
+			nextShift = never;
+			play.move(int8_t(shift * 10));
+		} else {
+			nextShift = tick + config.arr;
+			play.move(int8_t(shift));
+		}
+		return;
+	}
+	if(nextFall == tick) {
+		bool instant = softDropHeld && config.softDropGravity == 0;
+		nextFall = instant? never : tick + fallInterval();
+		play.drop(instant? 20 : 1);
+		reschedule();
+		return;
+	}
+	if(lockDeadline == tick) {
+		lockDeadline = never;
+		play.hardDrop();
+	}
+}
+
+void timingEngine::advance(uint64_t tick) {
+	if(tick < now) tick = now;
+	for(;;) {
+		uint64_t next = nextDeadline();
+		if(next > tick) break;
+		step(next);
+	}
+	now = tick;
+}
+
+void timingEngine::press(timingInput input, uint64_t tick) {
+	advance(tick);
+	switch(input) {
+	case timingInput::left:
+	case timingInput::right:
+		if(input == timingInput::left) leftHeld = true;
+		else rightHeld = true;
+		shift = input == timingInput::left? -1 : +1;
+		shiftCharged = false;
+		nextShift = now + config.das;
+		play.move(int8_t(shift));
+		break;
+	case timingInput::softDrop:
+		softDropHeld = true;
+		nextFall = never;
+		reschedule();
+		break;
+	}
+}
+
+void timingEngine::release(timingInput input, uint64_t tick) {
+	advance(tick);
+	switch(input) {
+	case timingInput::left:
+	case timingInput::right:
+		if(input == timingInput::left) leftHeld = false;
+		else rightHeld = false;
+		if(shift != (input == timingInput::left? -1 : +1)) break;
+
+		// Shift towards the direction still held, which
+		// must be charged again.
+		shiftCharged = false;
+		if(leftHeld || rightHeld) {
+			shift = leftHeld? -1 : +1;
+			nextShift = now + config.das;
+		} else {
+			shift = 0;
+			nextShift = never;
+		}
+		break;
+	case timingInput::softDrop:
+		softDropHeld = false;
+		if(nextFall != never) {
+			nextFall = never;
+			reschedule();
+		}
+		break;
+	}
+}
+
+void timingEngine::tileSpawn(const tileSpawnEvent& event) {
+	lowestY = event.location.y;
+	lockResets = config.maxLockResets;
+	nextFall = never;
+	lockDeadline = never;
+	if(shiftCharged && config.arr == 0) nextShift = now;
+	reschedule();
+}
+
+void timingEngine::tileMove(const tileMoveEvent& event) {
+	// Reaching a lower row refills the lock delay resets,
+	// while moving or rotating on the ground consumes one.
+	if(event.after.y < lowestY) {
+		lowestY = event.after.y;
+		lockResets = config.maxLockResets;
+	}
+	bool falling = event.after.x == event.before.x &&
+		event.after.dir == event.before.dir;
+	if(!falling && lockDeadline != never &&
+		isGrounded() && lockResets > 0) {
+		-- lockResets;
+		lockDeadline = now + config.lockDelay;
+	}
+	if(shiftCharged && config.arr == 0) nextShift = now;
+	reschedule();
+}
+
+void timingEngine::gameEnd(const gameEndEvent&) {
+	nextShift = never;
+	nextFall = never;
+	lockDeadline = never;
+}
+
+} // namespace hacktile::model
+} // namespace hacktile
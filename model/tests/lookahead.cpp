@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <gtest/gtest.h>
+#include "model/generator.hpp"
+#include "model/lookahead.hpp"
+#include "model/playground.hpp"
+#include "model/tetromino.hpp"
+#include <vector>
+using namespace hacktile::model;
+
+// finiteGenerator generates the tiles in turn, until the
+// number of tiles is exhausted.
+struct finiteGenerator : public tileGenerator {
+	const tile* const* tiles;
+	size_t numGenerated, numTiles;
+
+	finiteGenerator(const tile* const* tiles, size_t numTiles):
+		tiles(tiles), numGenerated(0), numTiles(numTiles) {}
+
+	const tile* generate() override {
+		if(numGenerated >= numTiles) return nullptr;
+		return tiles[numGenerated ++ % 7];
+	}
+
+	size_t stateSize() const override { return sizeof(size_t); }
+	void saveState(void* p) const override {
+		*reinterpret_cast<size_t*>(p) = numGenerated;
+	}
+	void restoreState(const void* p) override {
+		numGenerated = *reinterpret_cast<const size_t*>(p);
+	}
+};
+
+// Lookahead.GenerateN checks the bulk generation generates
+// the same tiles as generating one at a time.
+TEST(Lookahead, GenerateN) {
+	size_t history[4] = { 3, 2, 3, 2 };
+	tilePermutator permutator(tetrominoTiles(), 7, 5);
+	tilePermutator expectPermutator(tetrominoTiles(), 7, 5);
+	historyRoll roll(tetrominoTiles(), 7, 4, history, 4, 5);
+	historyRoll expectRoll(tetrominoTiles(), 7, 4, history, 4, 5);
+	const tile* tiles[100];
+	for(size_t n : { 1, 3, 7, 10, 100 }) {
+		ASSERT_EQ(permutator.generateN(tiles, n), n);
+		for(size_t i = 0; i < n; ++ i)
+			ASSERT_EQ(tiles[i], expectPermutator.generate());
+		ASSERT_EQ(roll.generateN(tiles, n), n);
+		for(size_t i = 0; i < n; ++ i)
+			ASSERT_EQ(tiles[i], expectRoll.generate());
+	}
+
+	// The generation stops once the tiles are exhausted.
+	finiteGenerator finite(tetrominoTiles(), 5);
+	EXPECT_EQ(finite.generateN(tiles, 3), 3);
+	EXPECT_EQ(finite.generateN(tiles, 3), 2);
+	EXPECT_EQ(finite.generateN(tiles, 3), 0);
+}
+
+// Lookahead.Peek checks the tiles peeked and generated from
+// the lookahead are the tiles of the underlying generator.
+TEST(Lookahead, Peek) {
+	tilePermutator source(tetrominoTiles(), 7, 9), expect(tetrominoTiles(), 7, 9);
+	tileLookahead lookahead(&source, 4);
+	std::vector<const tile*> sequence;
+	for(int i = 0; i < 2000; ++ i) sequence.push_back(expect.generate());
+
+	// Peek far ahead so that the ring must grow, and then
+	// consume the tiles in all ways to wrap around the ring.
+	EXPECT_EQ(lookahead.peek(999), sequence[999]);
+	EXPECT_GE(lookahead.getNumBuffered(), 1000);
+	size_t cursor = 0;
+	const tile* tiles[13];
+	while(cursor < 1900) {
+		ASSERT_EQ(lookahead.peek(7), sequence[cursor + 7]);
+		ASSERT_EQ(lookahead.generate(), sequence[cursor ++]);
+		ASSERT_EQ(lookahead.generateN(tiles, 13), 13);
+		for(size_t i = 0; i < 13; ++ i)
+			ASSERT_EQ(tiles[i], sequence[cursor ++]);
+	}
+
+	// The snapshot holds the tiles buffered.
+	std::vector<uint64_t> state((lookahead.stateSize() + 7) / 8);
+	lookahead.saveState(state.data());
+	const tile* first = lookahead.generate();
+	lookahead.peek(50);
+	lookahead.restoreState(state.data());
+	EXPECT_EQ(lookahead.generate(), first);
+	EXPECT_EQ(first, sequence[cursor ++]);
+	for(; cursor < 2000; ++ cursor)
+		ASSERT_EQ(lookahead.generate(), sequence[cursor]);
+
+	// The exhausted tiles could not be peeked.
+	finiteGenerator finite(tetrominoTiles(), 10);
+	tileLookahead finiteLookahead(&finite, 4);
+	EXPECT_EQ(finiteLookahead.peek(9), tetrominoTiles()[2]);
+	EXPECT_EQ(finiteLookahead.peek(10), nullptr);
+	EXPECT_EQ(finiteLookahead.generateN(tiles, 13), 10);
+	EXPECT_EQ(finiteLookahead.generate(), nullptr);
+}
+
+// Lookahead.Playground checks the tiles peeked beyond the
+// previews of the playground are the tiles to be spawned.
+TEST(Lookahead, Playground) {
+	tilePermutator source(tetrominoTiles(), 7, 3);
+	tileLookahead lookahead(&source);
+	playground play(&lookahead, 3);
+	play.start();
+	std::vector<const tile*> peeked;
+	for(size_t i = 0; i < 20; ++ i) peeked.push_back(play.peekTile(i));
+	EXPECT_EQ(peeked[0], play.getPreview(0));
+	EXPECT_EQ(peeked[2], play.getPreview(2));
+	for(size_t i = 0; i < 20 && play.isInGame(); ++ i) {
+		play.hardDrop();
+		ASSERT_EQ(play.getCurrentTile(), peeked[i]);
+	}
+
+	// The tiles beyond could not be told without lookahead.
+	tilePermutator plain(tetrominoTiles(), 7, 3);
+	playground plainPlay(&plain, 3);
+	plainPlay.start();
+	EXPECT_EQ(plainPlay.peekTile(2), plainPlay.getPreview(2));
+	EXPECT_EQ(plainPlay.peekTile(3), nullptr);
+}
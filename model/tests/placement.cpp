@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <gtest/gtest.h>
+#include "model/tile.hpp"
+#include "model/tetromino.hpp"
+#include "model/placement.hpp"
+#include <memory>
+using namespace hacktile::model;
+
+// createTetromino creates the tile of specified tetromino.
+static tile createTetromino(tetromino typ) {
+	tileData data;
+	createTetrominoTileData(data, typ);
+	tileRotationTable kick;
+	createTetrominoRotation(kick, typ);
+	return tile(data, kick);
+}
+
+// applyInput applies a single input of the path to the field.
+static bool applyInput(const field& f, tileInput input,
+	const tilePathFinder& pfd, tilePathFinder& result) {
+	tileDirection dir = pfd.getState().dir;
+	switch(input) {
+	case tileInput::moveLeft:  return f.move(pfd, -1, result);
+	case tileInput::moveRight: return f.move(pfd, +1, result);
+	case tileInput::rotateCW:
+		return f.rotate(pfd, dir.rotateCW(), result);
+	case tileInput::rotateCCW:
+		return f.rotate(pfd, dir.rotateCCW(), result);
+	case tileInput::halfTurn:
+		return f.rotate(pfd, dir.halfTurn(), result);
+	case tileInput::dropOne:   return f.drop(pfd, 1, result);
+	case tileInput::softDrop:  return f.drop(pfd, 20, result);
+	}
+	return false;
+}
+
+// Placement.EmptyField counts the distinct placements of
+// every tetromino in an empty field.
+TEST(Placement, EmptyField) {
+	const struct {
+		tetromino typ;
+		size_t numPlacements;
+	} expected[] = {
+		{ tetromino::J, 34 }, { tetromino::L, 34 },
+		{ tetromino::S, 17 }, { tetromino::Z, 17 },
+		{ tetromino::T, 34 }, { tetromino::I, 17 },
+		{ tetromino::O,  9 },
+	};
+	std::unique_ptr<placementFinder> finder(new placementFinder);
+	field f;
+	for(const auto& item : expected) {
+		tile t = createTetromino(item.typ);
+		tilePathFinder pfd(&t);
+		ASSERT_TRUE(f.spawn(pfd));
+		ASSERT_EQ(finder->search(f, pfd), item.numPlacements);
+	}
+}
+
+// Placement.PathReplay replays the path of every placement
+// through the field, and checks whether the tile arrives at
+// the placement and could be locked there.
+TEST(Placement, PathReplay) {
+	tile t = createTetromino(tetromino::T);
+	field f;
+	f.grow({1, 1, 1, 1, 1, 1, 1, 0, 0, 0});
+	f.grow({1, 1, 1, 1, 1, 1, 0, 0, 0, 1});
+	f.grow({1, 1, 1, 1, 1, 1, 1, 0, 1, 1});
+
+	std::unique_ptr<placementFinder> finder(new placementFinder);
+	tilePathFinder spawn(&t);
+	ASSERT_TRUE(f.spawn(spawn));
+	size_t numPlacements = finder->search(f, spawn);
+	ASSERT_GT(numPlacements, 0);
+
+	bool foundTSpin = false;
+	for(size_t i = 0; i < numPlacements; ++ i) {
+		const tilePlacement& placement = finder->getPlacement(i);
+		std::unique_ptr<tileInput[]> path(
+			new tileInput[placement.numInputs]);
+		ASSERT_EQ(finder->retrievePath(placement, path.get()),
+			placement.numInputs);
+
+		tilePathFinder pfd = spawn;
+		for(size_t j = 0; j < placement.numInputs; ++ j) {
+			tilePathFinder npfd;
+			ASSERT_TRUE(applyInput(f, path[j], pfd, npfd));
+			pfd = npfd;
+		}
+		tileState state = pfd.getState();
+		ASSERT_EQ(state.x, placement.state.x);
+		ASSERT_EQ(state.y, placement.state.y);
+		ASSERT_TRUE(state.dir == placement.state.dir);
+		ASSERT_EQ(pfd.isPreviousWallKick(), placement.wallKick);
+
+		// The tile at the placement must be lockable.
+		field g = f;
+		uint8_t clear = 0;
+		ASSERT_TRUE(g.lock(pfd, clear));
+		if(state.dir == enumTileDirection::halfTurned &&
+			state.x == 5 && state.y == -1) {
+			ASSERT_EQ(clear, 2);
+			foundTSpin = true;
+		}
+	}
+	ASSERT_TRUE(foundTSpin);
+}
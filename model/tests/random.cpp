@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <gtest/gtest.h>
+#include "model/random.hpp"
+#include "model/generator.hpp"
+#include "model/tetromino.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+using namespace hacktile::model;
+
+// indexOf returns the index of the tetromino in the tiles.
+static int indexOf(const tile* t) {
+	int k = 0;
+	while(tetrominoTiles()[k] != t) ++ k;
+	return k;
+}
+
+// describe generates the tiles as the indices.
+static std::string describe(tileGenerator& generator, int n) {
+	std::string result;
+	for(int i = 0; i < n; ++ i)
+		result += char('0' + indexOf(generator.generate()));
+	return result;
+}
+
+// Random.Xoshiro checks the outputs and jumps of xoshiro256
+// against the reference implementation.
+TEST(Random, Xoshiro) {
+	xoshiro256 rng(0);
+	EXPECT_EQ(rng(), 0x99ec5f36cb75f2b4ull);
+	EXPECT_EQ(rng(), 0xbf6e1f784956452aull);
+	EXPECT_EQ(rng(), 0x1a5f849d4933e6e0ull);
+
+	xoshiro256 jumped(0);
+	jumped.jump();
+	EXPECT_EQ(jumped(), 0x376215edc846d62cull);
+	xoshiro256 longJumped(0);
+	longJumped.longJump();
+	EXPECT_EQ(longJumped(), 0xe704a522a72937ebull);
+	EXPECT_NE(jumped, longJumped);
+}
+
+// Random.Below checks the range reduction is uniform.
+TEST(Random, Below) {
+	xoshiro256 rng(42);
+	const uint32_t n = 7;
+	const int numSamples = 70000;
+	int counts[n] = {};
+	for(int i = 0; i < numSamples; ++ i) {
+		uint32_t value = rng.below(n);
+		ASSERT_LT(value, n);
+		++ counts[value];
+	}
+	for(uint32_t i = 0; i < n; ++ i) {
+		EXPECT_GT(counts[i], numSamples / n * 95 / 100);
+		EXPECT_LT(counts[i], numSamples / n * 105 / 100);
+	}
+	for(int i = 0; i < 100; ++ i) EXPECT_EQ(rng.below(1), 0);
+}
+
+// Random.Compatible checks the generators with mt19937
+// generate the same tiles as they did with the same seed.
+TEST(Random, Compatible) {
+	tilePermutator permutator(tetrominoTiles(), 7, 42);
+	EXPECT_EQ(describe(permutator, 28), "4023651023416561402353642501");
+	size_t history[4] = { 3, 2, 3, 2 };
+	historyRoll roll(tetrominoTiles(), 7, 4, history, 4, 42);
+	EXPECT_EQ(describe(roll, 28), "5614306241065142304621305412");
+}
+
+// Random.Fast checks the generators with xoshiro256, which
+// have much smaller snapshots.
+TEST(Random, Fast) {
+	fastTilePermutator permutator(tetrominoTiles(), 7, 1);
+	EXPECT_LT(permutator.stateSize(), 128);
+	std::vector<char> state(permutator.stateSize());
+	permutator.saveState(state.data());
+	std::string bags = describe(permutator, 70);
+	for(int i = 0; i < 70; i += 7) {
+		std::string bag = bags.substr(i, 7);
+		std::sort(bag.begin(), bag.end());
+		EXPECT_EQ(bag, "0123456");
+	}
+	permutator.restoreState(state.data());
+	EXPECT_EQ(describe(permutator, 70), bags);
+
+	size_t history[4] = { 3, 2, 3, 2 };
+	fastHistoryRoll roll(tetrominoTiles(), 7, 4, history, 4, 1);
+	EXPECT_LT(roll.stateSize(), 128);
+	std::string rolled = describe(roll, 100);
+	for(char c = '0'; c < '7'; ++ c)
+		EXPECT_NE(rolled.find(c), std::string::npos);
+}
+
+// Generator.Bag checks the bag of the permutator and the
+// sequences enumerated from the tiles left in the bag.
+TEST(Generator, Bag) {
+	tilePermutator permutator(tetrominoTiles(), 7, 42);
+	ASSERT_EQ(describe(permutator, 3), "402");
+	tileBag bag = permutator.getBag();
+	EXPECT_EQ(bag.remaining, 0x6aull);
+	EXPECT_EQ(bag.numRemaining, 4);
+	EXPECT_EQ(bag.bagSize, 7);
+
+	// The orders of the tiles left are equally likely.
+	double total = 0.0;
+	bool found = false;
+	EXPECT_EQ(permutator.enumerate(3, [&](const tile* const seq[],
+		size_t length, double probability) {
+		ASSERT_EQ(length, 3);
+		EXPECT_DOUBLE_EQ(probability, 1.0 / 24);
+		total += probability;
+		found = found || (indexOf(seq[0]) == 3 &&
+			indexOf(seq[1]) == 6 && indexOf(seq[2]) == 5);
+	}), 24);
+	EXPECT_DOUBLE_EQ(total, 1.0);
+	EXPECT_TRUE(found);
+
+	// The sequences run into the next bag, which must begin
+	// with the tiles not in the rest of current bag.
+	total = 0.0;
+	EXPECT_EQ(permutator.enumerate(6, [&](const tile* const seq[],
+		size_t, double probability) {
+		total += probability;
+		EXPECT_NE(seq[4], seq[5]);
+	}), 24 * 7 * 6);
+	EXPECT_NEAR(total, 1.0, 1e-9);
+	EXPECT_EQ(permutator.enumerate(3, [](const tile* const[],
+		size_t, double) {}, 0.5), 0);
+
+	// The enumeration must not advance the permutator.
+	EXPECT_EQ(describe(permutator, 25), "3651023416561402353642501");
+}
+
+// Generator.Roll checks the sequences enumerated from the
+// history roll against the probabilities and the samples.
+TEST(Generator, Roll) {
+	size_t history[4] = { 3, 2, 3, 2 };
+	historyRoll roll(tetrominoTiles(), 7, 4, history, 4, 42);
+	double probabilities[7];
+	roll.getProbabilities(probabilities);
+	double q = 2.0 / 7;
+	EXPECT_DOUBLE_EQ(probabilities[2], q * q * q * q / 7);
+	EXPECT_DOUBLE_EQ(probabilities[0],
+		(1 - q * q * q * q * q) / (1 - q) / 7);
+	double total = 0.0;
+	for(int i = 0; i < 7; ++ i) total += probabilities[i];
+	EXPECT_DOUBLE_EQ(total, 1.0);
+
+	// Sample the pairs of tiles from the rolls of different
+	// seeds, which must match the pairs enumerated.
+	const int numSamples = 20000;
+	double frequencies[7][7] = {};
+	for(int seed = 0; seed < numSamples; ++ seed) {
+		fastHistoryRoll sampled(tetrominoTiles(), 7, 4, history, 4, seed);
+		std::string pair = describe(sampled, 2);
+		frequencies[pair[0] - '0'][pair[1] - '0'] += 1.0 / numSamples;
+	}
+	total = 0.0;
+	EXPECT_EQ(roll.enumerate(2, [&](const tile* const seq[],
+		size_t, double probability) {
+		int first = indexOf(seq[0]), second = indexOf(seq[1]);
+		EXPECT_NEAR(frequencies[first][second], probability, 0.01);
+		total += probability;
+	}), 49);
+	EXPECT_DOUBLE_EQ(total, 1.0);
+	EXPECT_LT(roll.enumerate(3, [](const tile* const[],
+		size_t, double) {}, 1e-3), 343);
+	EXPECT_EQ(describe(roll, 28), "5614306241065142304621305412");
+}
@@ -0,0 +1,236 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <gtest/gtest.h>
+#include "model/tile.hpp"
+#include "model/tetromino.hpp"
+#include "model/generator.hpp"
+#include "model/playground.hpp"
+#include "model/placement.hpp"
+#include "model/replay.hpp"
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+using namespace hacktile::model;
+
+// replayFile is the temporary file removed on destruction.
+struct replayFile {
+	std::string path;
+	int fd;
+
+	replayFile() {
+		char name[] = "/tmp/hacktileReplayXXXXXX";
+		fd = ::mkstemp(name);
+		path = name;
+	}
+
+	~replayFile() {
+		if(fd >= 0) ::close(fd);
+		::unlink(path.c_str());
+	}
+};
+
+// replayGame plays the game by the placements found, and
+// keeps the placements and clears locked.
+struct replayGame : public playgroundListener {
+	tilePermutator permutator;
+	playground play;
+	hacktile::util::eventSubscription<playgroundListener> subscription;
+	std::vector<tileState> locations;
+	std::vector<const tile*> types;
+	std::vector<uint8_t> clears;
+
+	replayGame(uint64_t seed):
+		permutator(tetrominoTiles(), 7, seed), play(&permutator),
+		subscription(play.subscribe(this)) {}
+
+	void tileLock(const tileLockEvent& event) override {
+		types.push_back(&event.type);
+		locations.push_back(event.location);
+		clears.push_back(event.clear);
+	}
+
+	// run plays the game until it ends or enough tiles have
+	// been locked, preferring the lowest placements.
+	void run(uint64_t seed, size_t numLocks) {
+		std::mt19937 rng(seed);
+		std::unique_ptr<placementFinder> finder(new placementFinder);
+		std::vector<tileInput> path(placementFinder::numNodes);
+		while(play.isInGame() && types.size() < numLocks) {
+			if(rng() % 5 == 0 && play.swapTile()) continue;
+			tilePathFinder pfd(play.getCurrentTile(),
+				play.getCurrentState());
+			ASSERT_TRUE(play.getField().spawn(pfd));
+			size_t n = finder->search(play.getField(), pfd);
+			ASSERT_GT(n, 0);
+			size_t chosen = rng() % n;
+			for(size_t i = 0; i < n; ++ i) {
+				if(rng() % 2 != 0) continue;
+				const tilePlacement& p = finder->getPlacement(i);
+				if(p.state.y < finder->getPlacement(chosen).state.y)
+					chosen = i;
+			}
+			size_t len = finder->retrievePath(
+				finder->getPlacement(chosen), path.data());
+			for(size_t i = 0; i < len; ++ i)
+				ASSERT_TRUE(play.input(path[i]));
+			play.hardDrop();
+		}
+	}
+};
+
+TEST(Replay, RecordAndPlayback) {
+	replayFile file;
+	ASSERT_GE(file.fd, 0);
+	replayGame game(42);
+	replayHeader header;
+	header.generator = replayGenerator::permutator;
+	header.numTiles = 7;
+	header.numPreviews = uint8_t(game.play.getNumPreviews());
+	header.seed = 42;
+	size_t numPlacements;
+	{
+		replayRecorder recorder(game.play, file.fd,
+			header, tetrominoTiles());
+		game.play.start();
+		game.run(7, 300);
+		numPlacements = recorder.getNumPlacements();
+	}
+	ASSERT_GT(game.types.size(), 20);
+	ASSERT_EQ(numPlacements, game.types.size());
+
+	// The placements are packed into a few bits each.
+	off_t size = ::lseek(file.fd, 0, SEEK_END);
+	EXPECT_LT(size_t(size), replayHeader::size + 2 * numPlacements);
+
+	replayReader reader(file.path.c_str());
+	EXPECT_EQ(reader.getHeader().seed, 42);
+	EXPECT_EQ(reader.getHeader().numTiles, 7);
+	EXPECT_EQ(reader.getHeader().generator, replayGenerator::permutator);
+	replayCursor cursor = reader.placements();
+	replayPlacement placement;
+	field f;
+	size_t i = 0;
+	int numTucks = 0;
+	while(cursor.next(placement)) {
+		ASSERT_LT(i, game.types.size());
+		const tile& typ = *tetrominoTiles()[placement.type];
+		EXPECT_EQ(&typ, game.types[i]);
+		tileState state = stateOf(f, typ, placement);
+		EXPECT_EQ(state.x, game.locations[i].x);
+		EXPECT_EQ(state.y, game.locations[i].y);
+		EXPECT_EQ(state.dir.getValue(), game.locations[i].dir.getValue());
+		if(placement.depth > 0) ++ numTucks;
+		uint8_t clear;
+		ASSERT_TRUE(replayLock(f, typ, placement, clear));
+		EXPECT_EQ(clear, game.clears[i]);
+		++ i;
+	}
+	EXPECT_EQ(i, game.types.size());
+	EXPECT_GT(numTucks, 0);
+	EXPECT_EQ(f.getHash(), game.play.getField().getHash());
+}
+
+TEST(Replay, Truncated) {
+	replayFile file;
+	ASSERT_GE(file.fd, 0);
+	replayGame game(7);
+	replayHeader header;
+	header.numTiles = 7;
+	header.seed = 7;
+	{
+		replayRecorder recorder(game.play, file.fd,
+			header, tetrominoTiles());
+		game.play.start();
+		game.run(11, 40);
+	}
+
+	// The replay cut in the middle of a placement is still
+	// read until the last complete placement.
+	off_t size = ::lseek(file.fd, 0, SEEK_END);
+	ASSERT_EQ(::ftruncate(file.fd, size / 2), 0);
+	replayReader reader(file.path.c_str());
+	replayCursor cursor = reader.placements();
+	replayPlacement placement;
+	size_t numPlacements = 0;
+	while(cursor.next(placement)) ++ numPlacements;
+	EXPECT_GT(numPlacements, 0);
+	EXPECT_LT(numPlacements, game.types.size());
+	EXPECT_FALSE(cursor.next(placement));
+
+	// The files not beginning with the header are rejected.
+	ASSERT_EQ(::ftruncate(file.fd, 8), 0);
+	EXPECT_THROW(replayReader(file.path.c_str()), std::runtime_error);
+	ASSERT_EQ(::ftruncate(file.fd, 0), 0);
+	EXPECT_THROW(replayReader(file.path.c_str()), std::runtime_error);
+}
+
+TEST(Replay, Header) {
+	replayFile file;
+	ASSERT_GE(file.fd, 0);
+	replayGame game(3);
+	replayHeader header;
+	header.generator = replayGenerator::historyRoll;
+	header.numTiles = 7;
+	header.numPreviews = 3;
+	header.seed = 0x0123456789abcdefull;
+	header.randomizer = replayRandomizer::xoshiro256;
+	header.history = replayHistory::zszs;
+	replayRecorder(game.play, file.fd, header, tetrominoTiles()).finish();
+
+	// The generator of the header is read back as recorded.
+	{
+		replayReader reader(file.path.c_str());
+		const replayHeader& read = reader.getHeader();
+		EXPECT_EQ(read.version, replayHeader::currentVersion);
+		EXPECT_EQ(read.generator, replayGenerator::historyRoll);
+		EXPECT_EQ(read.numTiles, 7);
+		EXPECT_EQ(read.numPreviews, 3);
+		EXPECT_EQ(read.seed, 0x0123456789abcdefull);
+		EXPECT_EQ(read.randomizer, replayRandomizer::xoshiro256);
+		EXPECT_EQ(read.history, replayHistory::zszs);
+		replayPlacement placement;
+		replayCursor cursor = reader.placements();
+		EXPECT_FALSE(cursor.next(placement));
+		EXPECT_TRUE(cursor.isEnded());
+	}
+
+	// The headers of other versions or unknown generators
+	// are rejected.
+	uint8_t data[replayHeader::size + 1];
+	ASSERT_EQ(::pread(file.fd, data, sizeof(data), 0), ssize_t(sizeof(data)));
+	replayHeader parsed;
+	EXPECT_TRUE(replayReader::parseHeader(data, sizeof(data), parsed));
+	data[4] = 1;
+	EXPECT_FALSE(replayReader::parseHeader(data, sizeof(data), parsed));
+	data[4] = replayHeader::currentVersion;
+	data[16] = 2;
+	EXPECT_FALSE(replayReader::parseHeader(data, sizeof(data), parsed));
+	data[16] = 0;
+	data[17] = 2;
+	EXPECT_FALSE(replayReader::parseHeader(data, sizeof(data), parsed));
+}
+
+TEST(Replay, WriteFailure) {
+	int fd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+	ASSERT_GE(fd, 0);
+	replayGame game(5);
+	replayHeader header;
+	header.numTiles = 7;
+	header.seed = 5;
+	replayRecorder recorder(game.play, fd, header, tetrominoTiles());
+	game.play.start();
+	game.run(5, 20);
+
+	// The failure is thrown by flushing rather than while
+	// the tiles are locked, and nothing is recorded after.
+	EXPECT_THROW(recorder.flush(), std::runtime_error);
+	size_t numPlacements = recorder.getNumPlacements();
+	EXPECT_GT(numPlacements, 0);
+	game.run(5, 40);
+	EXPECT_EQ(recorder.getNumPlacements(), numPlacements);
+	EXPECT_THROW(recorder.finish(), std::runtime_error);
+	::close(fd);
+}
@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <gtest/gtest.h>
+#include "model/tile.hpp"
+#include "model/tetromino.hpp"
+#include "model/generator.hpp"
+#include "model/playground.hpp"
+#include "model/snapshot.hpp"
+#include <random>
+#include <cstring>
+#include <string>
+#include <vector>
+using namespace hacktile::model;
+
+// describe renders the observable state of the playground.
+static std::string describe(const playground& play) {
+	std::string result;
+	for(int y = 0; y < field::maxHeight; ++ y) {
+		fieldRow row = play.getField().rowAt(y);
+		for(int x = 0; x < 10; ++ x) result += char('0' + row[x]);
+		result += char('0' + play.getField().columnHeight(y % 10));
+	}
+	auto index = [](const tile* t) -> std::string {
+		return t == nullptr? "-" : std::to_string(uintptr_t(t) % 4093);
+	};
+	result += "|" + index(play.getCurrentTile());
+	result += "|" + std::to_string(play.getCurrentState().x);
+	result += "," + std::to_string(play.getCurrentState().y);
+	result += "|" + index(play.getSwapTile());
+	result += play.isSwapEnabled()? "|swap" : "|noswap";
+	for(int i = 0; i < play.getNumPreviews(); ++ i)
+		result += "|" + index(play.getPreview(i));
+	result += "|" + std::to_string(int(play.getState()));
+	return result;
+}
+
+// playRandom plays the pieces with random inputs, and
+// records the state of the playground after each piece.
+static void playRandom(playground& play, uint64_t seed,
+	int numPieces, std::vector<std::string>& trace) {
+	std::mt19937 rng(seed);
+	for(int n = 0; n < numPieces && play.isInGame(); ++ n) {
+		if(rng() % 5 == 0) play.swapTile();
+		int numInputs = rng() % 6;
+		for(int i = 0; i < numInputs; ++ i)
+			play.input(tileInput(rng() % 7));
+		play.hardDrop();
+		trace.push_back(describe(play));
+	}
+}
+
+// Snapshot.Restore checks whether the playground plays the
+// same game after restoring, for every kind of generator.
+TEST(Snapshot, Restore) {
+	size_t history[4] = {6, 5, 6, 5};
+	std::unique_ptr<tileGenerator> generators[] = {
+		std::unique_ptr<tileGenerator>(new tilePermutator(
+			tetrominoTiles(), 7, 1)),
+		std::unique_ptr<tileGenerator>(new historyRoll(
+			tetrominoTiles(), 7, 4, history, 4, 1)),
+	};
+	for(auto& generator : generators) {
+		playground play(generator.get());
+		play.start();
+		std::vector<std::string> warmup;
+		playRandom(play, 7, 6, warmup);
+		ASSERT_TRUE(play.isInGame());
+
+		snapshotArena arena;
+		playgroundSnapshot snapshot;
+		play.save(snapshot, arena);
+		std::string initial = describe(play);
+		for(int i = 0; i < 3; ++ i) {
+			std::vector<std::string> expected, actual;
+			playRandom(play, 11, 30, expected);
+			play.restore(snapshot, arena);
+			ASSERT_EQ(describe(play), initial);
+			playRandom(play, 11, 30, actual);
+			ASSERT_EQ(expected, actual);
+
+			// Restore into a copy of the snapshot, which is
+			// trivially copyable.
+			playgroundSnapshot copied;
+			std::memcpy(&copied, &snapshot, sizeof(snapshot));
+			play.restore(copied, arena);
+			ASSERT_EQ(describe(play), initial);
+		}
+	}
+}
+
+// Snapshot.CopyOnWrite checks whether only the modified rows
+// are copied into the arena by the next snapshot.
+TEST(Snapshot, CopyOnWrite) {
+	field f;
+	for(int i = 0; i < 12; ++ i) {
+		fieldRow row;
+		row.fill(8);
+		row[i % 10] = 0;
+		row[(i + 3) % 10] = 0;
+		f.grow(row);
+	}
+
+	snapshotArena arena;
+	fieldSnapshot first, second;
+	f.save(first, arena);
+	snapshotArena::mark before = arena.getMark();
+	ASSERT_EQ(before.numRows, 13);
+
+	// The tile touches 2 rows and clears none.
+	tilePathFinder pfd(&tetrominoTile(tetromino::O)), result;
+	ASSERT_TRUE(f.spawn(pfd));
+	ASSERT_TRUE(f.drop(pfd, 20, result));
+	uint8_t clear;
+	ASSERT_TRUE(f.lock(result, clear));
+	ASSERT_EQ(clear, 0);
+	f.save(second, arena);
+	snapshotArena::mark after = arena.getMark();
+	EXPECT_EQ(after.numRows, before.numRows + 2);
+
+	// Restoring the first snapshot and then the second
+	// snapshot does not push anything into the arena.
+	f.restore(first, arena);
+	EXPECT_EQ(f.columnHeight(4), 12);
+	f.restore(second, arena);
+	EXPECT_EQ(f.columnHeight(4), 14);
+	f.save(second, arena);
+	EXPECT_EQ(arena.getMark().numRows, after.numRows);
+
+	// Rewinding the arena discards the second snapshot, and
+	// the rows of first snapshot are copied into the field.
+	arena.rewind(before);
+	f.restore(first, arena);
+	EXPECT_EQ(f.columnHeight(4), 12);
+	f.save(first, arena);
+	EXPECT_EQ(arena.getMark().numRows, before.numRows);
+}
@@ -2,6 +2,9 @@
 #include <gtest/gtest.h>
 #include "model/tile.hpp"
 #include "model/tetromino.hpp"
+#include "model/pentomino.hpp"
+#include "model/fieldops.hpp"
+#include <random>
 using namespace hacktile::model;
 
 // Tile.TSpinMini is the testing for dropping a tetromino::T
@@ -13,7 +16,9 @@ TEST(Tile, TSpinMini) {
 	createTetrominoTileData(data, tetromino::T);
 	tileRotationTable kick;
 	createTetrominoRotation(kick, tetromino::T);
-	tile t(data, kick);
+	tileSpinCorners corners;
+	createTetrominoSpinCorners(corners, tetromino::T);
+	tile t(data, kick, corners);
 
 	// Initialize the field data with single line with hole.
 	field f;
@@ -63,6 +68,10 @@ TEST(Tile, TSpinMini) {
 		ASSERT_EQ(state.y, -1);
 	}
 
+	// The tile is kicked against the wall with only one
+	// front corner filled, which is a T-spin mini.
+	ASSERT_EQ(f.spinOf(pfd), tileSpin::mini);
+
 	// Attempt to lock the tile, and a single line erase
 	// will be expected.
 	uint8_t clear = 0;
@@ -71,3 +80,488 @@ TEST(Tile, TSpinMini) {
 	ASSERT_EQ(f.compactRowAt(0), 3);
 	ASSERT_EQ(f.compactRowAt(1), 1);
 }
+
+// Tile.KickLeftInitial checks the kicks between the left and
+// initial directions, which are the last clockwise kicks and
+// must survive the inverse transform.
+TEST(Tile, KickLeftInitial) {
+	tileRotationTable kick;
+	createTetrominoRotation(kick, tetromino::T);
+	const uint8_t expected[4] = {
+		tileCoordAt(-1,  0), tileCoordAt(-1, -1),
+		tileCoordAt( 0, +2), tileCoordAt(-1, +2),
+	};
+	for(int k = 0; k < 4; ++ k) {
+		EXPECT_EQ(kick[3][0][k], expected[k]);
+		tileCoord coord;
+		coord.value = expected[k];
+		EXPECT_EQ(kick[0][3][k], tileCoordAt(-coord.x, -coord.y));
+	}
+	EXPECT_EQ(kick[3][0][4], 0);
+	EXPECT_EQ(kick[0][3][4], 0);
+}
+
+// Tile.CompactStorage applies the same series of operations
+// onto both compact storages and see whether they agree on
+// every row and window.
+TEST(Tile, CompactStorage) {
+	fieldCompactRows rows;
+	fieldBitboard bitboard;
+	std::mt19937 random(0);
+	for(int n = 0; n < 1000; ++ n) {
+		int y = random() % 40;
+		uint16_t mask = random() & field::solidRow;
+		switch(random() % 4) {
+		case 0:
+		case 1:
+			rows.fill(y, mask);
+			bitboard.fill(y, mask);
+			break;
+		case 2: {
+			uint8_t erased[2] = { uint8_t(y), uint8_t(y + 2) };
+			int numErased = random() % 2 + 1;
+			rows.erase(erased, numErased);
+			bitboard.erase(erased, numErased);
+		} break;
+		case 3:
+			// Rows pushed above the bitboard are dropped,
+			// and we won't compare in that case.
+			if(rows.rowAt(fieldBitboard::numRows - 1) != 0)
+				break;
+			rows.insertBottom(mask);
+			bitboard.insertBottom(mask);
+			break;
+		}
+		for(int i = -8; i < fieldBitboard::numRows; ++ i)
+			ASSERT_EQ(rows.rowAt(i), bitboard.rowAt(i));
+		for(int i = -12; i <= fieldBitboard::numRows - 6; ++ i)
+			ASSERT_EQ(rows.window(i).getValue(),
+				bitboard.window(i).getValue());
+	}
+}
+
+// Tile.Skyline locks random tiles into the field, and checks
+// whether the skyline and the dropped location agree with
+// the ones evaluated row by row.
+TEST(Tile, Skyline) {
+	std::vector<tile> tiles;
+	for(uint8_t i = 1; i <= 7; ++ i) {
+		tileData data;
+		createTetrominoTileData(data, tetromino(i));
+		tileRotationTable kick;
+		createTetrominoRotation(kick, tetromino(i));
+		tiles.emplace_back(data, kick);
+	}
+
+	// collide checks whether the tile collides with the
+	// cells of the field, pixel by pixel.
+	field f;
+	auto collide = [&f](const tilePathFinder& pfd, int dy) {
+		uint8_t rdata[tile::maxNumPixels];
+		tileCoord rloc[tile::maxNumPixels];
+		tileState state = pfd.getState();
+		int numPixels = pfd.getType()->retrieveTileData(
+			state.dir, rdata, rloc);
+		for(int i = 0; i < numPixels; ++ i) {
+			int x = state.x + rloc[i].x;
+			int y = state.y + rloc[i].y + dy;
+			if((f.compactRowAt(y) & (1<<x)) != 0) return true;
+		}
+		return false;
+	};
+
+	std::mt19937 random(0);
+	for(int n = 0; n < 2000; ++ n) {
+		// Garbage lines are added to create overhangs.
+		if(random() % 8 == 0) {
+			fieldRow row;
+			for(int i = 0; i < 10; ++ i) row[i] = random() % 2;
+			row[random() % 10] = 0;
+			f.grow(row);
+		}
+
+		// Spawn a tile and place it at random location.
+		tilePathFinder pfd(&tiles[random() % 7]);
+		if(!f.spawn(pfd)) {
+			f = field();
+			continue;
+		}
+		tilePathFinder npfd;
+		if(f.rotate(pfd, tileDirection(random() % 4), npfd))
+			pfd = npfd;
+		if(f.move(pfd, int8_t(random() % 10) - 5, npfd))
+			pfd = npfd;
+
+		// Drop the tile to the bottom, and compare with the
+		// location when it is dropped row by row.
+		tilePathFinder fast = pfd, slow = pfd;
+		if(f.drop(pfd, 20, npfd)) fast = npfd;
+		while(f.drop(slow, 1, npfd)) slow = npfd;
+		ASSERT_EQ(fast.getState().y, slow.getState().y);
+
+		// Then we could attempt to tuck the tile under the
+		// overhang and drop again.
+		if(f.move(fast, int8_t(random() % 3) - 1, npfd)) {
+			fast = npfd;
+			slow = npfd;
+			if(f.drop(fast, 20, npfd)) fast = npfd;
+			while(f.drop(slow, 1, npfd)) slow = npfd;
+			ASSERT_EQ(fast.getState().y, slow.getState().y);
+		}
+		ASSERT_FALSE(collide(fast, 0));
+		ASSERT_TRUE(collide(fast, -1));
+		uint8_t clear;
+		ASSERT_TRUE(f.lock(fast, clear));
+
+		// The cells must agree with the compact rows.
+		for(int y = 0; y < field::maxHeight; ++ y) {
+			fieldRow row = f.rowAt(y);
+			for(int i = 0; i < 10; ++ i)
+				ASSERT_EQ(row[i] != 0,
+					(f.compactRowAt(y) & (1<<i)) != 0);
+		}
+
+		// Evaluate the skyline from the rows and compare.
+		for(int i = 0; i < 10; ++ i) {
+			int height = 0;
+			for(int y = 0; y < field::maxHeight; ++ y)
+				if((f.compactRowAt(y) & (1<<i)) != 0)
+					height = y + 1;
+			ASSERT_EQ(f.columnHeight(i), height);
+		}
+
+		// The incremental hash must agree with the hash of
+		// the field built from the same rows.
+		field rebuilt;
+		for(int y = field::maxHeight - 1; y >= 0; -- y)
+			rebuilt.grow(f.rowAt(y));
+		ASSERT_EQ(f.getHash(), rebuilt.getHash());
+		ASSERT_EQ(f.getHash(), f.evaluateHash());
+	}
+}
+
+// Tile.GrowHash grows the garbage rows beyond the maximum
+// height, and checks the hash updated on each row against
+// the hash evaluated from all rows again.
+TEST(Tile, GrowHash) {
+	std::mt19937 random(0);
+	field f;
+	for(int n = 0; n < 3 * field::maxHeight; ++ n) {
+		fieldRow row;
+		row.fill(8);
+		row[random() % 10] = 0;
+		if(random() % 4 == 0) row.fill(0);
+		f.grow(row);
+		ASSERT_EQ(f.getHash(), f.evaluateHash());
+	}
+
+	// Locking and clearing above the garbage must keep the
+	// hash in sync as well.
+	tilePathFinder pfd(&tetrominoTile(tetromino::I)), result;
+	field g;
+	for(int n = 0; n < 4; ++ n) {
+		fieldRow row;
+		row.fill(8);
+		row[0] = 0;
+		g.grow(row);
+	}
+	ASSERT_TRUE(g.spawn(pfd));
+	ASSERT_TRUE(g.rotate(pfd, enumTileDirection::right, result));
+	pfd = result;
+	ASSERT_TRUE(g.move(pfd, -10, result));
+	pfd = result;
+	ASSERT_TRUE(g.drop(pfd, 40, result));
+	uint8_t clear;
+	ASSERT_TRUE(g.lock(result, clear));
+	ASSERT_EQ(clear, 4);
+	EXPECT_EQ(g.getHash(), field().getHash());
+	EXPECT_EQ(g.getHash(), g.evaluateHash());
+}
+
+// Tile.Hash checks whether the same cells locked in
+// different order will lead to the same hash.
+TEST(Tile, Hash) {
+	tileData data;
+	tileRotationTable kick;
+	createTetrominoTileData(data, tetromino::O);
+	createTetrominoRotation(kick, tetromino::O);
+	tile o(data, kick);
+	createTetrominoTileData(data, tetromino::I);
+	createTetrominoRotation(kick, tetromino::I);
+	tile i(data, kick);
+
+	// lockAt locks the tile after moving and dropping.
+	auto lockAt = [](field& f, const tile* t, int8_t dx) {
+		tilePathFinder pfd(t), result;
+		ASSERT_TRUE(f.spawn(pfd));
+		if(dx != 0) {
+			ASSERT_TRUE(f.move(pfd, dx, result));
+			pfd = result;
+		}
+		ASSERT_TRUE(f.drop(pfd, 20, result));
+		uint8_t clear;
+		ASSERT_TRUE(f.lock(result, clear));
+	};
+	field first, second;
+	ASSERT_EQ(first.getHash(), second.getHash());
+	lockAt(first, &o, -4);
+	ASSERT_NE(first.getHash(), second.getHash());
+	lockAt(first, &i, +3);
+	lockAt(second, &i, +3);
+	lockAt(second, &o, -4);
+	ASSERT_EQ(first.getHash(), second.getHash());
+
+	// Clearing the line moves the O tile down.
+	field cleared, expected;
+	lockAt(cleared, &o, -4);
+	lockAt(cleared, &o, -2);
+	lockAt(cleared, &o, 0);
+	lockAt(cleared, &o, +2);
+	lockAt(cleared, &o, +4);
+	lockAt(cleared, &o, -4);
+	lockAt(expected, &o, -4);
+	ASSERT_EQ(cleared.getHash(), expected.getHash());
+}
+
+// Tile.Spin rotates tiles into the slots and checks the
+// spins classified against the corners and immobility.
+TEST(Tile, Spin) {
+	tileData data;
+	tileRotationTable kick;
+	tileSpinCorners corners;
+	createTetrominoTileData(data, tetromino::T);
+	createTetrominoRotation(kick, tetromino::T);
+	createTetrominoSpinCorners(corners, tetromino::T);
+	tile t(data, kick, corners);
+	createTetrominoTileData(data, tetromino::O);
+	createTetrominoRotation(kick, tetromino::O);
+	createTetrominoSpinCorners(corners, tetromino::O);
+	tile o(data, kick, corners);
+
+	// Rotate the tile into the T-spin double slot, which
+	// is covered by the overhang at the left.
+	field f;
+	f.grow({0, 0, 0, 1, 0, 0, 0, 0, 0, 0});
+	f.grow({1, 1, 1, 0, 0, 0, 1, 1, 1, 1});
+	f.grow({1, 1, 1, 1, 0, 1, 1, 1, 1, 1});
+	tilePathFinder pfd(&t), result;
+	ASSERT_TRUE(f.spawn(pfd));
+	ASSERT_TRUE(f.drop(pfd, 20, result));
+	pfd = result;
+	ASSERT_TRUE(f.rotate(pfd, enumTileDirection::right, result));
+	pfd = result;
+	ASSERT_TRUE(f.drop(pfd, 20, result));
+	pfd = result;
+	ASSERT_EQ(f.spinOf(pfd), tileSpin::none);
+	ASSERT_TRUE(f.rotate(pfd, enumTileDirection::halfTurned, result));
+	pfd = result;
+	ASSERT_EQ(pfd.getState().x, 2);
+	ASSERT_EQ(pfd.getState().y, -1);
+	ASSERT_FALSE(pfd.isPreviousWallKick());
+	ASSERT_EQ(f.spinOf(pfd), tileSpin::full);
+	ASSERT_EQ(f.spinOf(pfd, spinRule::allMini), tileSpin::full);
+	uint8_t clear = 0;
+	ASSERT_TRUE(f.lock(pfd, clear));
+	ASSERT_EQ(clear, 2);
+
+	// The O tile under the roof cannot move in any way,
+	// which is a spin only under the all-spin rules.
+	field roofed, open;
+	roofed.grow({1, 1, 1, 1, 1, 0, 1, 1, 1, 1});
+	for(int i = 0; i < 2; ++ i) {
+		roofed.grow({1, 1, 1, 1, 0, 0, 1, 1, 1, 1});
+		open.grow({1, 1, 1, 1, 0, 0, 1, 1, 1, 1});
+	}
+	tileState state;
+	state.x = 2;
+	state.y = -2;
+	for(field* g : {&roofed, &open}) {
+		tilePathFinder opfd(&o, state), oresult;
+		ASSERT_TRUE(g->spawn(opfd));
+		ASSERT_EQ(g->spinOf(opfd, spinRule::allSpin), tileSpin::none);
+		ASSERT_TRUE(g->rotate(opfd, enumTileDirection::right, oresult));
+		opfd = oresult;
+		ASSERT_EQ(g->spinOf(opfd), tileSpin::none);
+		tileSpin expected = g == &roofed? tileSpin::full : tileSpin::none;
+		ASSERT_EQ(g->spinOf(opfd, spinRule::allSpin), expected);
+		expected = g == &roofed? tileSpin::mini : tileSpin::none;
+		ASSERT_EQ(g->spinOf(opfd, spinRule::allMini), expected);
+	}
+}
+
+// randomField creates the field of 12 rows grown from the
+// bottom, where a third of the cells are filled.
+static field randomField(std::mt19937& random) {
+	field f;
+	for(int y = 0; y < 12; ++ y) {
+		fieldRow row;
+		for(int x = 0; x < 10; ++ x)
+			row[x] = random() % 3 == 0? 1 : 0;
+		f.grow(row);
+	}
+	return f;
+}
+
+// Tile.Tables compares the tetrominoes generated at compile
+// time with the ones constructed from the tile data, by the
+// pixels and the results of operations in random fields.
+TEST(Tile, Tables) {
+	for(int x = -8; x < 8; ++ x)
+		for(int y = -8; y < 8; ++ y) {
+			uint8_t value = tileCoordValue(x, y);
+			ASSERT_EQ(value, tileCoordAt(x, y));
+			ASSERT_EQ(tileCoordX(value), x);
+			ASSERT_EQ(tileCoordY(value), y);
+		}
+
+	std::mt19937 random(0);
+	for(uint8_t i = 1; i <= 7; ++ i) {
+		tileData data;
+		createTetrominoTileData(data, tetromino(i));
+		tileRotationTable kick;
+		createTetrominoRotation(kick, tetromino(i));
+		tileSpinCorners corners;
+		createTetrominoSpinCorners(corners, tetromino(i));
+		tile expected(data, kick, corners);
+		const tile& actual = tetrominoTile(tetromino(i));
+
+		// Compare the pixels and bounding boxes.
+		for(uint8_t dir = 0; dir < 4; ++ dir) {
+			uint8_t expectedData[tile::maxNumPixels];
+			uint8_t actualData[tile::maxNumPixels];
+			tileCoord expectedLoc[tile::maxNumPixels];
+			tileCoord actualLoc[tile::maxNumPixels];
+			int numPixels = expected.retrieveTileData(
+				dir, expectedData, expectedLoc);
+			ASSERT_EQ(actual.retrieveTileData(
+				dir, actualData, actualLoc), numPixels);
+			for(int n = 0; n < numPixels; ++ n) {
+				ASSERT_EQ(actualData[n], expectedData[n]);
+				ASSERT_EQ(actualLoc[n].value, expectedLoc[n].value);
+			}
+			tileCoord expectedMin, expectedMax, actualMin, actualMax;
+			expected.retrieveBoundingBox(dir, expectedMin, expectedMax);
+			actual.retrieveBoundingBox(dir, actualMin, actualMax);
+			ASSERT_EQ(actualMin.value, expectedMin.value);
+			ASSERT_EQ(actualMax.value, expectedMax.value);
+			for(uint8_t x = 0; x < 6; ++ x)
+				ASSERT_EQ(actual.bottomAt(dir, x), expected.bottomAt(dir, x));
+		}
+
+		// Compare the operations at every location of the
+		// random fields, including the rotations and spins.
+		for(int n = 0; n < 8; ++ n) {
+			field f = randomField(random);
+			for(uint8_t dir = 0; dir < 4; ++ dir)
+			for(int8_t x = -3; x < 10; ++ x)
+			for(int8_t y = -3; y < 16; ++ y) {
+				tileState state;
+				state.dir = dir;
+				state.x = x;
+				state.y = y;
+				tilePathFinder a(&expected, state), b(&actual, state);
+				bool spawned = f.spawn(a);
+				ASSERT_EQ(f.spawn(b), spawned);
+				if(!spawned) continue;
+				tilePathFinder ra, rb;
+				for(int8_t dx : {-1, +1}) {
+					ASSERT_EQ(f.move(a, dx, ra), f.move(b, dx, rb));
+					ASSERT_EQ(ra.getState().x, rb.getState().x);
+				}
+				ASSERT_EQ(f.drop(a, 20, ra), f.drop(b, 20, rb));
+				ASSERT_EQ(ra.getState().y, rb.getState().y);
+				for(uint8_t target = 0; target < 4; ++ target) {
+					bool rotated = f.rotate(a, target, ra);
+					ASSERT_EQ(f.rotate(b, target, rb), rotated);
+					if(!rotated) continue;
+					ASSERT_EQ(ra.getState().x, rb.getState().x);
+					ASSERT_EQ(ra.getState().y, rb.getState().y);
+					ASSERT_EQ(f.spinOf(ra), f.spinOf(rb));
+				}
+			}
+		}
+	}
+
+	// Every direction of the pentominoes must be the one
+	// before it rotated clockwise around the center.
+	for(uint8_t i = 1; i <= 18; ++ i) {
+		const tile& t = pentominoTile(pentomino(i));
+		for(uint8_t dir = 0; dir < 4; ++ dir) {
+			uint8_t rdata[tile::maxNumPixels];
+			tileCoord rloc[tile::maxNumPixels];
+			ASSERT_EQ(t.retrieveTileData(dir, rdata, rloc), 5);
+			uint64_t rotated = 0;
+			for(int n = 0; n < 5; ++ n) {
+				ASSERT_EQ(rdata[n], i);
+				rotated |= uint64_t(1) << (rloc[n].y + 6 * (6 - rloc[n].x));
+			}
+			tileDirection next = tileDirection(dir).rotateCW();
+			int numPixels = t.retrieveTileData(next, rdata, rloc);
+			uint64_t pixels = 0;
+			for(int n = 0; n < numPixels; ++ n)
+				pixels |= uint64_t(1) << (rloc[n].x + 6 * rloc[n].y);
+			ASSERT_EQ(pixels, rotated);
+		}
+	}
+}
+
+// fieldOpsChecker compares the specialized operations with
+// the ones of the field at every location in the field.
+struct fieldOpsChecker {
+	const field& f;
+	const tile* typ;
+
+	template<typename piece>
+	void visit() {
+		for(uint8_t dir = 0; dir < 4; ++ dir)
+		for(int8_t x = -3; x < 10; ++ x)
+		for(int8_t y = -3; y < 16; ++ y) {
+			tileState state;
+			state.dir = dir;
+			state.x = x;
+			state.y = y;
+			tilePathFinder pfd(typ, state);
+			if(!f.spawn(pfd)) continue;
+			tilePathFinder expected, actual;
+			for(int8_t dx : {-1, +1, -10, +10}) {
+				bool moved = f.move(pfd, dx, expected);
+				ASSERT_EQ(pieceOps<piece>::move(f, pfd, dx, actual), moved);
+				ASSERT_EQ(actual.getState().x, expected.getState().x);
+			}
+			for(uint8_t dy : {1, 20}) {
+				bool dropped = f.drop(pfd, dy, expected);
+				ASSERT_EQ(pieceOps<piece>::drop(f, pfd, dy, actual), dropped);
+				ASSERT_EQ(actual.getState().y, expected.getState().y);
+			}
+			for(uint8_t target = 0; target < 4; ++ target) {
+				bool rotated = f.rotate(pfd, target, expected);
+				ASSERT_EQ(pieceOps<piece>::rotate(
+					f, pfd, target, actual), rotated);
+				if(!rotated) continue;
+				ASSERT_EQ(actual.getState().x, expected.getState().x);
+				ASSERT_EQ(actual.getState().y, expected.getState().y);
+				ASSERT_EQ(actual.getPreviousKick().value,
+					expected.getPreviousKick().value);
+				ASSERT_EQ(f.spinOf(actual), f.spinOf(expected));
+			}
+		}
+	}
+};
+
+// Tile.FieldOps compares the operations specialized for the
+// tetrominoes with the generic ones in random fields.
+TEST(Tile, FieldOps) {
+	std::mt19937 random(0);
+	for(int n = 0; n < 4; ++ n) {
+		field f = randomField(random);
+		for(uint8_t i = 1; i <= 7; ++ i) {
+			fieldOpsChecker checker = { f, &tetrominoTile(tetromino(i)) };
+			ASSERT_TRUE(visitTetromino(checker.typ, checker));
+		}
+	}
+
+	// Tiles outside the table are not dispatched.
+	fieldOpsChecker checker = { field(), nullptr };
+	tile copied = tetrominoTile(tetromino::T);
+	ASSERT_FALSE(visitTetromino(&copied, checker));
+}
@@ -0,0 +1,180 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <gtest/gtest.h>
+#include "model/tile.hpp"
+#include "model/tetromino.hpp"
+#include "model/generator.hpp"
+#include "model/playground.hpp"
+#include "model/timing.hpp"
+#include <string>
+#include <vector>
+using namespace hacktile::model;
+
+// timingGame is the playground driven by the engine.
+struct timingGame : public playgroundListener {
+	std::unique_ptr<tilePermutator> permutator;
+	std::unique_ptr<playground> play;
+	hacktile::util::eventSubscription<playgroundListener> subscription;
+	std::unique_ptr<timingEngine> engine;
+	int numLocks;
+
+	timingGame(const timingConfig& config, uint64_t seed = 0):
+		permutator(new tilePermutator(tetrominoTiles(), 7, seed)),
+		play(new playground(permutator.get())),
+		subscription(play->subscribe(this)), numLocks(0) {
+		play->start();
+		engine.reset(new timingEngine(*play, config));
+	}
+
+	void tileLock(const tileLockEvent&) override {
+		++ numLocks;
+	}
+
+	// describe renders the field and the current tile.
+	std::string describe() const {
+		std::string result;
+		for(int y = 0; y < 20; ++ y) {
+			fieldRow row = play->getField().rowAt(y);
+			for(int x = 0; x < 10; ++ x) result += char('0' + row[x]);
+		}
+		const tileState& state = play->getCurrentState();
+		result += std::to_string(state.x) + "," + std::to_string(state.y);
+		result += "," + std::to_string(state.dir.getValue());
+		return result;
+	}
+};
+
+// stillConfig is the config without gravity and auto shift.
+static timingConfig stillConfig() {
+	timingConfig config;
+	config.gravity = 0;
+	config.softDropGravity = 0;
+	config.lockDelay = 1000;
+	config.maxLockResets = 2;
+	config.das = 100;
+	config.arr = 10;
+	return config;
+}
+
+TEST(Timing, Gravity) {
+	timingConfig config = stillConfig();
+	config.gravity = 1000;
+	timingGame game(config);
+	int8_t y = game.play->getCurrentState().y;
+	game.engine->advance(999);
+	EXPECT_EQ(game.play->getCurrentState().y, y);
+	game.engine->advance(1000);
+	EXPECT_EQ(game.play->getCurrentState().y, y - 1);
+	game.engine->advance(3500);
+	EXPECT_EQ(game.play->getCurrentState().y, y - 3);
+	EXPECT_EQ(game.engine->nextDeadline(), 4000);
+
+	// Soft dropping restarts the fall with its gravity.
+	config.softDropGravity = 100;
+	timingGame softGame(config);
+	y = softGame.play->getCurrentState().y;
+	softGame.engine->press(timingInput::softDrop, 500);
+	softGame.engine->advance(800);
+	EXPECT_EQ(softGame.play->getCurrentState().y, y - 3);
+	softGame.engine->release(timingInput::softDrop, 850);
+	softGame.engine->advance(1849);
+	EXPECT_EQ(softGame.play->getCurrentState().y, y - 3);
+	softGame.engine->advance(1850);
+	EXPECT_EQ(softGame.play->getCurrentState().y, y - 4);
+
+	EXPECT_EQ(gravityOfLevel(1), ticksPerSecond);
+	EXPECT_LT(gravityOfLevel(10), gravityOfLevel(9));
+}
+
+TEST(Timing, LockDelay) {
+	timingGame game(stillConfig());
+	EXPECT_EQ(game.engine->nextDeadline(), timingEngine::never);
+	game.play->drop(20);
+	EXPECT_EQ(game.engine->nextDeadline(), 1000);
+
+	// Moving on the ground resets the lock delay, until
+	// the resets are used up.
+	game.engine->advance(400);
+	EXPECT_TRUE(game.play->move(-1));
+	EXPECT_EQ(game.engine->nextDeadline(), 1400);
+	game.engine->advance(1200);
+	EXPECT_TRUE(game.play->move(+1));
+	EXPECT_EQ(game.engine->nextDeadline(), 2200);
+	game.engine->advance(2000);
+	EXPECT_TRUE(game.play->move(-1));
+	EXPECT_EQ(game.engine->nextDeadline(), 2200);
+	EXPECT_EQ(game.numLocks, 0);
+	game.engine->advance(2199);
+	EXPECT_EQ(game.numLocks, 0);
+	game.engine->advance(2200);
+	EXPECT_EQ(game.numLocks, 1);
+
+	// The next tile is in the air without gravity.
+	EXPECT_EQ(game.engine->nextDeadline(), timingEngine::never);
+}
+
+TEST(Timing, AutoShift) {
+	timingGame game(stillConfig());
+	timingGame expect(stillConfig());
+	game.engine->press(timingInput::right, 0);
+	expect.play->move(+1);
+	EXPECT_EQ(game.describe(), expect.describe());
+	game.engine->advance(99);
+	EXPECT_EQ(game.describe(), expect.describe());
+	game.engine->advance(115);
+	expect.play->move(+1);
+	expect.play->move(+1);
+	EXPECT_EQ(game.describe(), expect.describe());
+
+	// Releasing the direction held last shifts towards the
+	// direction still held, which must be charged again.
+	game.engine->press(timingInput::left, 116);
+	expect.play->move(-1);
+	EXPECT_EQ(game.describe(), expect.describe());
+	game.engine->release(timingInput::left, 150);
+	game.engine->advance(249);
+	EXPECT_EQ(game.describe(), expect.describe());
+	game.engine->advance(250);
+	expect.play->move(+1);
+	EXPECT_EQ(game.describe(), expect.describe());
+	game.engine->release(timingInput::right, 255);
+	game.engine->advance(1000);
+	EXPECT_EQ(game.describe(), expect.describe());
+
+	// Shifting without repeat rate moves to the wall.
+	timingConfig config = stillConfig();
+	config.arr = 0;
+	timingGame wall(config);
+	timingGame expectWall(config);
+	wall.engine->press(timingInput::left, 0);
+	wall.engine->advance(100);
+	expectWall.play->move(-10);
+	EXPECT_EQ(wall.describe(), expectWall.describe());
+	EXPECT_EQ(wall.engine->nextDeadline(), timingEngine::never);
+}
+
+TEST(Timing, Deterministic) {
+	// The inputs at the same ticks result in the same game,
+	// no matter how often the engine is advanced.
+	timingConfig config;
+	config.lockDelay = ticksPerSecond / 4;
+	config.gravity = ticksPerSecond / 50;
+	timingGame fine(config, 42), coarse(config, 42);
+	uint64_t tick = 0;
+	for(int i = 0; i < 40; ++ i) {
+		timingInput dir = i % 3 == 0? timingInput::left : timingInput::right;
+		uint64_t pressed = tick + 12345 * (i % 7);
+		uint64_t released = pressed + 50000 * (i % 5);
+		for(uint64_t t = tick; t < pressed; t += 997) fine.engine->advance(t);
+		fine.engine->press(dir, pressed);
+		coarse.engine->press(dir, pressed);
+		for(uint64_t t = pressed; t < released; t += 997) fine.engine->advance(t);
+		fine.engine->release(dir, released);
+		coarse.engine->release(dir, released);
+		tick = released + ticksPerSecond / 3;
+	}
+	fine.engine->advance(tick);
+	coarse.engine->advance(tick);
+	EXPECT_GT(fine.numLocks, 10);
+	EXPECT_EQ(fine.numLocks, coarse.numLocks);
+	EXPECT_EQ(fine.describe(), coarse.describe());
+}
@@ -41,5 +41,160 @@ void createTetrominoTileData(
 void createTetrominoRotation(
 	tileRotationTable result, tetromino typ);
 
+/**
+ * createTetrominoSpinCorners constructs and returns the
+ * spin corner table of the tile, which is only filled for
+ * tetromino::T and all 0 for other tiles.
+ */
+void createTetrominoSpinCorners(
+	tileSpinCorners result, tetromino typ);
+
+/**
+ * @brief tetrominoTable is the tables of the tetrominoes,
+ * from which the tiles are generated at compile time.
+ */
+struct tetrominoTable {
+	/// kicks3x3 is the clockwise wall kicks recommended for
+	/// the tiles bounded by 3x3 square.
+	static constexpr uint8_t kicks3x3[4][tile::maxNumRotations] = {
+		{
+			tileCoordValue(-1,  0), tileCoordValue(-1, +1),
+			tileCoordValue( 0, -2), tileCoordValue(-1, -2),
+		}, {
+			tileCoordValue(+1,  0), tileCoordValue(+1, -1),
+			tileCoordValue( 0, +2), tileCoordValue(+1, +2),
+		}, {
+			tileCoordValue(+1,  0), tileCoordValue(+1, +1),
+			tileCoordValue( 0, -2), tileCoordValue(+1, -2),
+		}, {
+			tileCoordValue(-1,  0), tileCoordValue(-1, -1),
+			tileCoordValue( 0, +2), tileCoordValue(-1, +2),
+		},
+	};
+
+	/// kicksNone is the empty wall kicks of the tiles which
+	/// won't kick, like tetromino::O.
+	static constexpr uint8_t kicksNone[4][tile::maxNumRotations] = {};
+
+	/// kicksI is the clockwise wall kicks of tetromino::I.
+	static constexpr uint8_t kicksI[4][tile::maxNumRotations] = {
+		{
+			tileCoordValue(-2,  0), tileCoordValue(+1,  0),
+			tileCoordValue(-2, -1), tileCoordValue(+1, +2),
+		}, {
+			tileCoordValue(+2,  0), tileCoordValue(-1,  0),
+			tileCoordValue(-1, +2), tileCoordValue(+2, -1),
+		}, {
+			tileCoordValue(+2,  0), tileCoordValue(-1,  0),
+			tileCoordValue(+2, +1), tileCoordValue(-1, -2),
+		}, {
+			tileCoordValue(-2,  0), tileCoordValue(+1,  0),
+			tileCoordValue(+1, -2), tileCoordValue(-2, +1),
+		},
+	};
+
+	/// shapes are the shapes of the tetrominoes in the
+	/// order of the enum.
+	static constexpr tileShape shapes[7] = {
+		// tetromino::J
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 1, 0, 0, 0, 0 },
+			{ 0, 1, 1, 1, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 4, uint8_t(tetromino::J), kicks3x3, {} },
+		// tetromino::L
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 1, 0, 0 },
+			{ 0, 1, 1, 1, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 4, uint8_t(tetromino::L), kicks3x3, {} },
+		// tetromino::S
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 1, 1, 0, 0 },
+			{ 0, 1, 1, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 4, uint8_t(tetromino::S), kicks3x3, {} },
+		// tetromino::Z
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 1, 1, 0, 0, 0 },
+			{ 0, 0, 1, 1, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 4, uint8_t(tetromino::Z), kicks3x3, {} },
+		// tetromino::T
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 1, 0, 0, 0 },
+			{ 0, 1, 1, 1, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 4, uint8_t(tetromino::T), kicks3x3, {
+			tileCoordValue(1, 3), tileCoordValue(3, 3),
+			tileCoordValue(1, 1), tileCoordValue(3, 1),
+		} },
+		// tetromino::I
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 1, 1, 1, 1, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 5, uint8_t(tetromino::I), kicksI, {} },
+		// tetromino::O
+		{ {
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 1, 1, 0, 0 },
+			{ 0, 0, 1, 1, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+			{ 0, 0, 0, 0, 0, 0 },
+		}, 5, uint8_t(tetromino::O), kicksNone, {} },
+	};
+
+	/// tiles are the tetrominoes generated from the shapes,
+	/// in the order of the enum.
+	static constexpr tile tiles[7] = {
+		tile(shapes[0]), tile(shapes[1]), tile(shapes[2]),
+		tile(shapes[3]), tile(shapes[4]), tile(shapes[5]),
+		tile(shapes[6]),
+	};
+
+	/// pointers are the pointers to the tiles, which could
+	/// be passed to the generators as the tiles to generate.
+	static constexpr const tile* pointers[7] = {
+		&tiles[0], &tiles[1], &tiles[2], &tiles[3],
+		&tiles[4], &tiles[5], &tiles[6],
+	};
+}; // struct hacktile::model::tetrominoTable
+
+/**
+ * tetrominoTile returns the tile of the tetromino, which
+ * is generated at compile time and requires no setup.
+ */
+inline const tile& tetrominoTile(tetromino typ) {
+	return tetrominoTable::tiles[uint8_t(typ) - 1];
+}
+
+/**
+ * tetrominoTiles returns the pointers to the tiles of all
+ * tetrominoes in the order of the enum.
+ */
+inline const tile* const* tetrominoTiles() {
+	return tetrominoTable::pointers;
+}
+
 } // namespace hacktile::model
 } // namespace hacktile
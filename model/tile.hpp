@@ -16,7 +16,9 @@
  * you will need to rewrite a dedicated field algorithm if
  * your requirement is really specific.
  */
+#include "model/config.hpp"
 #include <cstdint>
+#include <cstddef>
 #include <algorithm>
 #include <vector>
 #include <array>
@@ -53,12 +55,26 @@ class compactField {
 	/// rows inside the field.
 	static constexpr uint64_t fullMask = (((uint64_t)1)<<60)-1;
 public:
+	/// solidRow is the row with all of its 10 cells filled.
+	static constexpr uint16_t solidRow = (1<<10)-1;
+
 	/// compactField creates a new instance of field.
 	compactField(uint64_t data = 0): field(data) {}
 
 	/// assignment operator for the field.
 	compactField(const compactField& c): field(c.field) {}
 
+	/// assignment operator for the field.
+	compactField& operator=(const compactField& c) {
+		field = c.field;
+		return *this;
+	}
+
+	/// getValue returns the bits of the compact field.
+	uint64_t getValue() const {
+		return field;
+	}
+
 	/// collide judges whether a field has collided with
 	/// an input tile. The comparision is as simple as
 	/// comparing their fields.
@@ -169,8 +185,7 @@ struct tileState {
 
 	tileState(): dir(), x(0), y(0) {}
 
-	tileState(const tileState& r):
-		dir(r.dir), x(r.x), y(r.y) {}
+	tileState(const tileState& r) = default;
 }; // struct hacktile::model::tileState
 
 /**
@@ -194,6 +209,47 @@ inline uint8_t tileCoordAt(int8_t x, int8_t y) {
 	return coord.value;
 }
 
+/**
+ * @brief tileCoordValue is the constant expression version
+ * of tileCoordAt, which packs the x in the lower 4 bits and
+ * the y in the higher 4 bits.
+ */
+constexpr uint8_t tileCoordValue(int x, int y) {
+	return uint8_t((x & 0x0f) | ((y & 0x0f) << 4));
+}
+
+/**
+ * @brief tileCoordX and tileCoordY are the constant
+ * expression versions of reading the fields of tileCoord.
+ */
+constexpr int tileCoordX(uint8_t value) {
+	return ((value & 0x0f) ^ 0x08) - 0x08;
+}
+
+/// tileCoordY returns the y coordinate of the value.
+constexpr int tileCoordY(uint8_t value) {
+	return ((value >> 4) ^ 0x08) - 0x08;
+}
+
+/**
+ * @brief tileIndices is the sequence of indices used for
+ * initializing the tables of the tile at compile time.
+ */
+template<size_t... i>
+struct tileIndices {};
+
+/// makeTileIndices creates the tileIndices from 0 to n-1.
+template<size_t n, size_t... i>
+struct makeTileIndices : makeTileIndices<n - 1, n - 1, i...> {};
+
+/// makeTileIndices terminates the recursion of the indices.
+template<size_t... i>
+struct makeTileIndices<0, i...> {
+	typedef tileIndices<i...> type;
+};
+
+struct tileShape;
+
 /**
  * @brief a tile is the currently passed data indicating
  * the current item in use and will be used for collision
@@ -216,13 +272,28 @@ struct tile {
 
 	/// rotationType is the rotation table defined for tile.
 	typedef uint8_t rotationType[4][4][maxNumRotations];
+
+	/// spinCornerType is the spin corner table defined for
+	/// tile, which stores 4 corners around the center of the
+	/// tile in each direction, with the first 2 corners
+	/// being the ones at the front of the tile.
+	typedef uint8_t spinCornerType[4][4];
 private:
-	uint8_t data[4][maxNumPixels];
-	uint8_t loc[4][maxNumPixels];
-	uint8_t min[4], max[4];
-	uint64_t compactTile[4];
-	rotationType rotateTable;
+	std::array<std::array<uint8_t, maxNumPixels>, 4> data, loc;
+	std::array<uint8_t, 4> min, max;
+	std::array<std::array<int8_t, 6>, 4> bottom;
+	std::array<uint64_t, 4> compactTile;
+	std::array<std::array<std::array<uint8_t,
+		maxNumRotations>, 4>, 4> rotateTable;
+	std::array<std::array<uint8_t, 4>, 4> spinCorners;
 	friend class field;
+	friend class placementFinder;
+
+	// tile constructor to initialize the tables from the
+	// shape with the indices of each dimension of tables.
+	template<size_t... d, size_t... p, size_t... c, size_t... k>
+	constexpr tile(const tileShape&, tileIndices<d...>,
+		tileIndices<p...>, tileIndices<c...>, tileIndices<k...>);
 public:
 	// tile constructor to completely specify the basic
 	// bounding boxes and rotation states.
@@ -231,7 +302,16 @@ public:
 	// means the arg[?][0][0] actually represents the
 	// pixel at data[?][5][0], so are other tiles. This
 	// is used to simplify most code and make them readable.
-	tile(dataType, rotationType);
+	//
+	// The spin corners are only specified for the tiles
+	// recognized by their corners like tetromino::T, and
+	// other tiles could spin only when they're immobile.
+	tile(dataType, rotationType, spinCornerType = nullptr);
+
+	// tile constructor to evaluate the tables from the shape
+	// of the tile, which could be done at compile time, so
+	// that the tile could be stored as a constant.
+	constexpr tile(const tileShape&);
 
 	// initTileState evaluates the location of where
 	// should the tile spawn in field.
@@ -257,14 +337,220 @@ public:
 		rmin.value = min[dir.getValue()];
 		rmax.value = max[dir.getValue()];
 	}
+
+	// bottomAt retrieves the lowest pixel row at the column
+	// inside the 6x6 square, or -1 if the column is empty.
+	int8_t bottomAt(tileDirection dir, uint8_t x) const {
+		return bottom[dir.getValue()][x];
+	}
 }; // struct hacktile::model::tile
 
+/**
+ * @brief tileShape is the compile time description of a
+ * tile, from which the tables of the tile are generated.
+ *
+ * Only the initial direction is specified, and the other
+ * directions are generated by rotating the pixels clockwise
+ * around the pivot, as are the spin corners.
+ */
+struct tileShape {
+	/// grid is the pixels in initial direction, which is
+	/// turned upside-down like the tile data.
+	uint8_t grid[6][6];
+
+	/// pivot is twice the coordinate of the rotation center
+	/// on both axes, that is, 4 for the 3x3 tiles and 5 for
+	/// the 4x4 tiles in the 6x6 square.
+	uint8_t pivot;
+
+	/// value is the data of each pixel of the tile.
+	uint8_t value;
+
+	/// kicks is the wall kick table of the clockwise rotation
+	/// from each direction, which is all 0 if the tile won't
+	/// kick. The counter-clockwise rotations are the negated
+	/// ones, and the table must not be null, since comparing
+	/// it against null is not a constant expression.
+	const uint8_t (*kicks)[tile::maxNumRotations];
+
+	/// corners are the spin corners in initial direction,
+	/// or all 0 if the tile is not recognized by corners.
+	uint8_t corners[4];
+
+	/// pixelAt returns the pixel at location in direction.
+	constexpr uint8_t pixelAt(int dir, int x, int y) const {
+		return dir > 0? pixelAt(dir - 1, pivot - y, x) :
+			(x < 0 || x >= 6 || y < 0 || y >= 6)? 0 : grid[5 - y][x];
+	}
+
+	/// rotate returns the coordinate rotated clockwise for
+	/// specified times around the pivot.
+	constexpr uint8_t rotate(uint8_t coord, int times) const {
+		return times == 0? coord : rotate(tileCoordValue(
+			tileCoordY(coord), pivot - tileCoordX(coord)), times - 1);
+	}
+
+	/// pixelIndex returns the index (x + 6 * y) of the n-th
+	/// pixel in direction, or 36 if there's no such pixel.
+	constexpr int pixelIndex(int dir, int n, int i = 0) const {
+		return i >= 36? 36 :
+			pixelAt(dir, i % 6, i / 6) == 0? pixelIndex(dir, n, i + 1) :
+			n == 0? i : pixelIndex(dir, n - 1, i + 1);
+	}
+
+	/// pixelData returns the data of the n-th pixel.
+	constexpr uint8_t pixelData(int dir, int n) const {
+		return pixelIndex(dir, n) == 36? 0 : value;
+	}
+
+	/// pixelLoc returns the location of the n-th pixel.
+	constexpr uint8_t pixelLoc(int dir, int n) const {
+		return pixelIndex(dir, n) == 36? 0 : tileCoordValue(
+			pixelIndex(dir, n) % 6, pixelIndex(dir, n) / 6);
+	}
+
+	/// extremeOf returns the minimum or maximum coordinate
+	/// on the axis of the pixels in direction.
+	constexpr int extremeOf(int dir, bool y, bool highest,
+		int i = 0, int result = -1) const {
+		return i >= 36? result : extremeOf(dir, y, highest, i + 1,
+			pixelAt(dir, i % 6, i / 6) == 0? result :
+			(result < 0 || (highest? (y? i / 6 : i % 6) > result
+				: (y? i / 6 : i % 6) < result))?
+				(y? i / 6 : i % 6) : result);
+	}
+
+	/// boundOf returns the corner of the bounding box.
+	constexpr uint8_t boundOf(int dir, bool highest) const {
+		return tileCoordValue(extremeOf(dir, false, highest),
+			extremeOf(dir, true, highest));
+	}
+
+	/// bottomOf returns the lowest pixel in the column, or
+	/// -1 if the column is empty.
+	constexpr int8_t bottomOf(int dir, int x, int y = 0) const {
+		return y >= 6? -1 : pixelAt(dir, x, y) != 0? int8_t(y)
+			: bottomOf(dir, x, y + 1);
+	}
+
+	/// compactOf returns the compact tile in direction.
+	constexpr uint64_t compactOf(int dir, int i = 0) const {
+		return i >= 36? 0 : compactOf(dir, i + 1) |
+			(pixelAt(dir, i % 6, i / 6) == 0? 0 :
+				uint64_t(1) << (i % 6 + 10 * (i / 6)));
+	}
+
+	/// kickAt returns the k-th wall kick between directions.
+	constexpr uint8_t kickAt(int src, int dst, int k) const {
+		return dst == ((src + 1) & 3)? kicks[src][k] :
+			src == ((dst + 1) & 3)? tileCoordValue(
+				-tileCoordX(kicks[dst][k]), -tileCoordY(kicks[dst][k])) : 0;
+	}
+
+	/// cornerAt returns the i-th spin corner in direction.
+	constexpr uint8_t cornerAt(int dir, int i) const {
+		return corners[i] == 0? 0 : rotate(corners[i], dir);
+	}
+
+	/// dataOf returns the data of pixels in direction.
+	template<size_t... p>
+	constexpr std::array<uint8_t, tile::maxNumPixels>
+	dataOf(int dir, tileIndices<p...>) const {
+		return {{ pixelData(dir, p)... }};
+	}
+
+	/// locOf returns the locations of pixels in direction.
+	template<size_t... p>
+	constexpr std::array<uint8_t, tile::maxNumPixels>
+	locOf(int dir, tileIndices<p...>) const {
+		return {{ pixelLoc(dir, p)... }};
+	}
+
+	/// bottomsOf returns the bottom of columns in direction.
+	template<size_t... c>
+	constexpr std::array<int8_t, 6>
+	bottomsOf(int dir, tileIndices<c...>) const {
+		return {{ bottomOf(dir, c)... }};
+	}
+
+	/// kicksOf returns the wall kicks between directions.
+	template<size_t... k>
+	constexpr std::array<uint8_t, tile::maxNumRotations>
+	kicksOf(int src, int dst, tileIndices<k...>) const {
+		return {{ kickAt(src, dst, k)... }};
+	}
+
+	/// rotationsOf returns the wall kicks from direction.
+	template<size_t... d, size_t... k>
+	constexpr std::array<std::array<uint8_t, tile::maxNumRotations>, 4>
+	rotationsOf(int src, tileIndices<d...>, tileIndices<k...>) const {
+		return {{ kicksOf(src, d, tileIndices<k...>())... }};
+	}
+
+	/// cornersOf returns the spin corners in direction.
+	template<size_t... d>
+	constexpr std::array<uint8_t, 4>
+	cornersOf(int dir, tileIndices<d...>) const {
+		return {{ cornerAt(dir, d)... }};
+	}
+}; // struct hacktile::model::tileShape
+
+template<size_t... d, size_t... p, size_t... c, size_t... k>
+constexpr tile::tile(const tileShape& s, tileIndices<d...> dirs,
+	tileIndices<p...> pixels, tileIndices<c...> columns,
+	tileIndices<k...> kicks):
+	data{{ s.dataOf(d, pixels)... }},
+	loc{{ s.locOf(d, pixels)... }},
+	min{{ s.boundOf(d, false)... }},
+	max{{ s.boundOf(d, true)... }},
+	bottom{{ s.bottomsOf(d, columns)... }},
+	compactTile{{ s.compactOf(d)... }},
+	rotateTable{{ s.rotationsOf(d, dirs, kicks)... }},
+	spinCorners{{ s.cornersOf(d, dirs)... }} {}
+
+constexpr tile::tile(const tileShape& s): tile(s,
+	makeTileIndices<4>::type(), makeTileIndices<maxNumPixels>::type(),
+	makeTileIndices<6>::type(), makeTileIndices<maxNumRotations>::type()) {}
+
 /// tileData is forwarded type for tile data.
 typedef tile::dataType tileData;
 
 /// tileRotationTable is forwarded type for rotation table.
 typedef tile::rotationType tileRotationTable;
 
+/// tileSpinCorners is forwarded type for spin corner table.
+typedef tile::spinCornerType tileSpinCorners;
+
+/**
+ * @brief tileSpin is the kind of spin that a tile has been
+ * locked with, which is evaluated at lock time.
+ */
+enum class tileSpin : uint8_t {
+	none,
+	mini,
+	full,
+};
+
+/**
+ * @brief spinRule specifies which tiles are recognized as
+ * spins when they are locked after a rotation.
+ *
+ * The tiles with spin corners are always recognized by
+ * their corners, and the rule only affects other tiles.
+ */
+enum class spinRule : uint8_t {
+	/// tSpin recognizes only the tiles with spin corners.
+	tSpin,
+
+	/// allSpin recognizes other tiles as full spins when
+	/// they cannot move left, right or up.
+	allSpin,
+
+	/// allMini recognizes other tiles as mini spins when
+	/// they cannot move left, right or up.
+	allMini,
+};
+
 /**
  * @brief tilePathFinder is the path finder of a tile,
  * whose internal state could be modified by the
@@ -281,22 +567,26 @@ class tilePathFinder {
 
 	/// only the class hacktile::field can access it.
 	friend class field;
+	template<typename, int> friend struct fieldOps;
 
-	/// previousWallKick is a field indicates that the
-	/// previous step has been an wall kick.
-	bool previousWallKick;
+	/// previousRotation is a field indicates that the
+	/// previous step has been a rotation, and previousKick
+	/// is the offset of the wall kick applied in rotation,
+	/// or 0 if the rotation is not a wall kick.
+	bool previousRotation;
+	uint8_t previousKick;
 public:
 	/// tilePathFinder null constructor.
 	tilePathFinder():
 		typ(nullptr), state(), version(0), current(0),
-		previousWallKick(false) {}
+		previousRotation(false), previousKick(0) {}
 
 	/// tilePathFinder default constructor creates a
 	/// tile path finder with specified tile state.
 	tilePathFinder(
 		const tile* typ, const tileState& state):
 		typ(typ), state(state), version(0), current(0),
-		previousWallKick(false) {}
+		previousRotation(false), previousKick(0) {}
 
 	/// tilePathFinder type-only constructor for
 	/// evaluating the default location prior to any
@@ -310,7 +600,8 @@ public:
 		state = pfd.state;
 		version = pfd.version;
 		current = pfd.current;
-		previousWallKick = pfd.previousWallKick;
+		previousRotation = pfd.previousRotation;
+		previousKick = pfd.previousKick;
 		return *this;
 	}
 
@@ -329,7 +620,21 @@ public:
 	/// this path finder is created when the previous
 	/// operation is a wall kick.
 	bool isPreviousWallKick() const {
-		return previousWallKick;
+		return previousKick != 0;
+	}
+
+	/// isPreviousRotation returns whether this path finder
+	/// is created by a rotation, with or without wall kick.
+	bool isPreviousRotation() const {
+		return previousRotation;
+	}
+
+	/// getPreviousKick returns the offset of the wall kick
+	/// that this path finder is created with.
+	tileCoord getPreviousKick() const {
+		tileCoord coord;
+		coord.value = previousKick;
+		return coord;
 	}
 }; // struct hacktile::model::tilePathFinder
 
@@ -338,6 +643,257 @@ public:
  */
 typedef std::array<uint8_t, 10> fieldRow;
 
+/**
+ * @brief fieldRowRing is a fixed capacity ring buffer of
+ * the field rows, indexed from the bottom row.
+ *
+ * Adding a row below the bottom row only moves the offset
+ * of the bottom row, and erasing rows is done in a single
+ * compaction pass, which moves either the rows below or the
+ * rows above the erased ones, whichever is fewer.
+ */
+template<typename rowType, int capacity>
+class fieldRowRing {
+	static_assert((capacity & (capacity - 1)) == 0,
+		"capacity of the ring must be power of 2");
+	rowType rows[capacity];
+	uint8_t base, height;
+
+	/// physical returns the location of the row in buffer.
+	static int physical(int base, int y) {
+		return (base + y) & (capacity - 1);
+	}
+public:
+	/// fieldRowRing initializes an empty ring.
+	fieldRowRing(): base(0), height(0) {}
+
+	/// size returns the number of rows in the ring.
+	int size() const {
+		return height;
+	}
+
+	/// operator[] returns the row at specified index.
+	rowType& operator[](int y) {
+		return rows[physical(base, y)];
+	}
+
+	/// operator[] returns the row at specified index.
+	const rowType& operator[](int y) const {
+		return rows[physical(base, y)];
+	}
+
+	/// resize adds empty rows or removes rows at the top.
+	void resize(int newHeight) {
+		if(newHeight > capacity) newHeight = capacity;
+		for(int y = height; y < newHeight; ++ y)
+			(*this)[y] = rowType();
+		height = newHeight;
+	}
+
+	/// insertBottom adds a row below all rows, and the
+	/// highest row is discarded if the ring is full.
+	void insertBottom(const rowType& row) {
+		base = physical(base, -1);
+		(*this)[0] = row;
+		if(height < capacity) ++ height;
+	}
+
+	/// erase removes the rows specified in ascending order,
+	/// moving the rows above them down.
+	void erase(const uint8_t erased[], int numErased) {
+		if(numErased == 0) return;
+		int lowest = erased[0], highest = erased[numErased-1];
+		if(lowest < height - 1 - highest) {
+			// Move the rows below upward, and the bottom
+			// will be moved up by the number of rows.
+			int dst = highest, k = numErased - 1;
+			for(int src = highest; src >= 0; -- src) {
+				if(k >= 0 && erased[k] == src) { -- k; continue; }
+				(*this)[dst --] = (*this)[src];
+			}
+			base = physical(base, numErased);
+		} else {
+			// Move the rows above downward.
+			int dst = lowest, k = 0;
+			for(int src = lowest; src < height; ++ src) {
+				if(k < numErased && erased[k] == src) { ++ k; continue; }
+				(*this)[dst ++] = (*this)[src];
+			}
+		}
+		height -= numErased;
+	}
+}; // class hacktile::model::fieldRowRing
+
+/**
+ * @brief fieldCompactRows stores the compact rows of the
+ * field as a ring of row masks, and will assemble the
+ * compact field window row by row.
+ *
+ * The compact storages share the same interface, so that
+ * the field could use any of them to detect collisions.
+ * The rows below the field are always solid and the rows
+ * above the stored ones are always empty.
+ */
+class fieldCompactRows {
+public:
+	/// numRows is the maximum number of rows to store.
+	static constexpr int numRows = 64;
+private:
+	fieldRowRing<uint16_t, numRows> rows;
+public:
+	/// fieldCompactRows initializes an empty storage.
+	fieldCompactRows(): rows() {}
+
+	/// rowAt returns the row mask at specified row.
+	uint16_t rowAt(int y) const {
+		if(y < 0) return compactField::solidRow;
+		if(rows.size() <= y) return 0;
+		return rows[y];
+	}
+
+	/// window returns the compact field of 6 rows starting
+	/// from specified row.
+	compactField window(int y) const {
+		compactField result;
+		for(int i = 6; i > 0; -- i)
+			result = result.fieldDown(rowAt(y + i - 1));
+		return result;
+	}
+
+	/// fill adds the cells of the mask to specified row.
+	void fill(int y, uint16_t mask) {
+		if(y < 0 || y >= numRows) return;
+		if(rows.size() <= y) rows.resize(y + 1);
+		rows[y] |= mask;
+	}
+
+	/// erase removes the rows specified in ascending order,
+	/// moving rows above them down.
+	void erase(const uint8_t erased[], int numErased) {
+		while(numErased > 0 && erased[numErased-1] >= rows.size())
+			-- numErased;
+		rows.erase(erased, numErased);
+	}
+
+	/// insertBottom adds a row below all rows.
+	void insertBottom(uint16_t row) {
+		rows.insertBottom(row);
+	}
+}; // class hacktile::model::fieldCompactRows
+
+/**
+ * @brief fieldBitboard stores the whole field as packed
+ * 64-bit words, each holding 6 rows in the same layout as
+ * the compact field.
+ *
+ * Since the window of any row covers at most two words,
+ * the window is assembled with two loads and shifts rather
+ * than looping over the rows. An extra word of solid rows
+ * is placed below the field and an extra word of empty rows
+ * is placed above the field, so that no boundary needs to
+ * be checked for the rows in range.
+ */
+class fieldBitboard {
+public:
+	/// numRows is the maximum number of rows to store,
+	/// and rows above it will be discarded.
+	static constexpr int numRows = 48;
+private:
+	static constexpr int rowsPerWord = 6;
+	static constexpr int numWords = numRows / rowsPerWord + 2;
+	static constexpr uint64_t rowMask = compactField::solidRow;
+	static constexpr uint64_t fullMask = (uint64_t(1)<<60)-1;
+	uint64_t words[numWords];
+public:
+	/// fieldBitboard initializes an empty storage.
+	fieldBitboard() {
+		words[0] = fullMask;
+		for(int i = 1; i < numWords; ++ i) words[i] = 0;
+	}
+
+	/// rowAt returns the row mask at specified row.
+	uint16_t rowAt(int y) const {
+		if(y < 0) return compactField::solidRow;
+		if(y >= numRows) return 0;
+		int i = y + rowsPerWord;
+		return uint16_t((words[i / rowsPerWord]
+			>> (10 * (i % rowsPerWord))) & rowMask);
+	}
+
+	/// window returns the compact field of 6 rows starting
+	/// from specified row.
+	compactField window(int y) const {
+		if(y < -rowsPerWord) return compactField(fullMask);
+		if(y >= numRows) return compactField(0);
+		int i = y + rowsPerWord;
+		int k = i / rowsPerWord, shift = 10 * (i % rowsPerWord);
+		uint64_t result = words[k] >> shift;
+		if(shift != 0) result |= words[k+1] << (60 - shift);
+		return compactField(result & fullMask);
+	}
+
+	/// fill adds the cells of the mask to specified row.
+	void fill(int y, uint16_t mask) {
+		if(y < 0 || y >= numRows) return;
+		int i = y + rowsPerWord;
+		words[i / rowsPerWord] |= (uint64_t(mask) & rowMask)
+			<< (10 * (i % rowsPerWord));
+	}
+
+	/// erase removes the rows specified in ascending order,
+	/// moving rows above them down.
+	void erase(const uint8_t erased[], int numErased) {
+		// Erase from the highest row so that the lower
+		// rows to erase remain at their location.
+		for(int n = numErased - 1; n >= 0; -- n)
+			erase(erased[n]);
+	}
+
+	/// erase removes the row, moving rows above it down.
+	void erase(int y) {
+		if(y < 0 || y >= numRows) return;
+		int i = y + rowsPerWord;
+		int k = i / rowsPerWord, shift = 10 * (i % rowsPerWord);
+
+		// Remove the row from the word holding it, and the
+		// rows above it are moved down by one row.
+		uint64_t low = words[k] & ((uint64_t(1) << shift) - 1);
+		uint64_t high = (words[k] >> (shift + 10)) << shift;
+		words[k] = low | high;
+
+		// Then each word borrows the lowest row of the
+		// word above it as its highest row.
+		for(; k < numWords - 1; ++ k) {
+			words[k] |= (words[k+1] & rowMask) << 50;
+			if(k + 1 < numWords - 1) words[k+1] >>= 10;
+		}
+	}
+
+	/// insertBottom adds a row below all rows, moving all
+	/// rows up and discarding the highest row.
+	void insertBottom(uint16_t row) {
+		uint64_t carry = row & rowMask;
+		for(int k = 1; k < numWords - 1; ++ k) {
+			uint64_t next = (words[k] >> 50) & rowMask;
+			words[k] = ((words[k] << 10) | carry) & fullMask;
+			carry = next;
+		}
+	}
+}; // class hacktile::model::fieldBitboard
+
+/**
+ * @brief fieldCompactStorage is the compact storage used by
+ * the field, which is selected by HACKTILE_FIELD_BITBOARD.
+ */
+#ifdef HACKTILE_FIELD_BITBOARD
+typedef fieldBitboard fieldCompactStorage;
+#else
+typedef fieldCompactRows fieldCompactStorage;
+#endif
+
+class snapshotArena;
+struct fieldSnapshot;
+
 /**
  * @brief field is a concrete playground of a player.
  *
@@ -346,10 +902,50 @@ typedef std::array<uint8_t, 10> fieldRow;
  * of horizontal move, drop, bottomDrop, rotate and flip.
  */
 class field {
-	std::vector<uint16_t> compactFields;
-	std::vector<fieldRow> fields;
+	fieldCompactStorage compactFields;
+	fieldRowRing<fieldRow, 64> fields;
 	uint64_t version;
 
+	/// heights is the skyline of the field, that is, the
+	/// row right above the highest cell of each column.
+	uint8_t heights[10];
+
+	/// rowHandles are the handles of the rows copied into
+	/// the snapshot arena of handleEpoch, or 0 if the row
+	/// has been modified since the last snapshot.
+	fieldRowRing<uint32_t, 64> rowHandles;
+	uint64_t handleEpoch;
+
+	/// hash is the Zobrist hash of the cells in the field,
+	/// which is the exclusive-or of the keys of the rows.
+	uint64_t hash;
+
+	/// rotateKey rotates the key left by the bits.
+	static uint64_t rotateKey(uint64_t key, int bits) {
+		bits &= 63;
+		return (key << bits) | (key >> ((64 - bits) & 63));
+	}
+
+	/// rowKey returns the key of the row at location, and
+	/// empty rows always have the key of 0. The keys of the
+	/// same row at different locations are rotated by the
+	/// rows in between, so that raising all rows by one just
+	/// rotates the hash by one bit.
+	static uint64_t rowKey(int y, uint16_t row) {
+		if(row == 0) return 0;
+		uint64_t z = uint64_t(row) + uint64_t(0x9e3779b97f4a7c15);
+		z = (z ^ (z >> 30)) * uint64_t(0xbf58476d1ce4e5b9);
+		z = (z ^ (z >> 27)) * uint64_t(0x94d049bb133111eb);
+		return rotateKey(z ^ (z >> 31), y);
+	}
+
+	/// hashRows evaluates the keys of the rows in range.
+	uint64_t hashRows(int from, int to) const;
+
+	/// evaluateHeights evaluates the skyline of the field
+	/// again, which is required after erasing rows.
+	void evaluateHeights();
+
 	/// assertLegit is a state that could be used in
 	/// methods other than spawn.
 	void assertLegit(const tilePathFinder&) const;
@@ -360,13 +956,19 @@ class field {
 
 	/// envalidate is used to mark the state valid.
 	void envalidate(tilePathFinder&) const;
+
+	/// the specialized operations of the pieces.
+	template<typename, int> friend struct fieldOps;
 public:
 	/// field initialize the current field, including the
 	/// specification of the fields and compactFields.
-	field(): compactFields(), fields(), version(1) {
-		compactFields.reserve(22);
-		fields.reserve(22);
-	}
+	field(): compactFields(), fields(), version(1), heights(),
+		rowHandles(), handleEpoch(0), hash(0) {}
+
+	/// maxHeight is the maximum number of rows that could
+	/// be held by the field, and rows above it are dropped.
+	static constexpr int maxHeight = fieldCompactStorage::numRows;
+	static_assert(maxHeight <= 64, "too many rows in field");
 
 	/// spawn attempt to create a tile with initial rotation
 	/// at initial location, and returns whether it could be
@@ -379,23 +981,47 @@ public:
 	/// Please notice that when the solid row is used as
 	/// garbage line, it will not be erased by player, since
 	/// only the tile placed by player will trigger line clear.
-	static constexpr uint16_t solidRow = (1<<10)-1;
+	static constexpr uint16_t solidRow = compactField::solidRow;
 
 	/// compactRowAt returns the compactField value at row.
 	uint16_t compactRowAt(int y) const {
-		if(y < 0) return solidRow;
-		if(compactFields.size() <= y) return 0;
-		return compactFields[y];
+		return compactFields.rowAt(y);
+	}
+
+	/// compactWindowAt returns the compactField of the 6
+	/// rows starting from specified row.
+	compactField compactWindowAt(int y) const {
+		return compactFields.window(y);
+	}
+
+	/// getHash returns the Zobrist hash of the occupied
+	/// cells, which is updated whenever the field changes.
+	/// Fields with the same cells occupied always have the
+	/// same hash, regardless of the tiles locked.
+	uint64_t getHash() const {
+		return hash;
+	}
+
+	/// evaluateHash evaluates the hash from all rows again,
+	/// which always agrees with the hash of getHash.
+	uint64_t evaluateHash() const {
+		return hashRows(0, fields.size());
+	}
+
+	/// columnHeight returns the row right above the highest
+	/// cell in the column, or 0 if the column is empty.
+	uint8_t columnHeight(int x) const {
+		return heights[x];
 	}
 
 	/// rowAt retrieves the row vector with specified index.
 	fieldRow rowAt(int y, uint8_t solidCell = 1) const {
-		if(compactFields.size() <= y) return fieldRow();
-		else if(y < 0) {
+		if(y < 0) {
 			fieldRow result;
 			for(int i = 0; i < 10; ++ i) result[i] = solidCell;
 			return result;
 		}
+		if(fields.size() <= y) return fieldRow();
 		return fields[y];
 	}
 
@@ -408,6 +1034,10 @@ public:
 	/// drop is used to move on the vertical direction with
 	/// specified steps, returning whether it could eventually
 	/// move onto some tile on that direction.
+	///
+	/// When the tile is above the skyline, the landing row
+	/// is evaluated from the skyline directly, otherwise the
+	/// tile will be moved down row by row.
 	bool drop(const tilePathFinder& pfd,
 		uint8_t numSteps, tilePathFinder& result) const;
 
@@ -416,12 +1046,36 @@ public:
 	bool rotate(const tilePathFinder& pfd,
 		tileDirection targetDir, tilePathFinder& result) const;
 
+	/// spinOf classifies the spin of the tile if it were
+	/// locked at its location, which must be evaluated prior
+	/// to locking the tile.
+	///
+	/// Tiles with spin corners are spins when at least 3 of
+	/// the corners are filled, with the walls and floor
+	/// considered filled, and they're full spins when both
+	/// front corners are filled or the wall kick has moved
+	/// the tile by 2 rows, otherwise mini spins. Other tiles
+	/// are classified by their immobility and the rule.
+	tileSpin spinOf(const tilePathFinder& pfd,
+		spinRule rule = spinRule::tSpin) const;
+
 	/// lock will eventually place a tile on the tracker
 	/// location, modify the state of the field.
 	bool lock(const tilePathFinder& pfd, uint8_t& clear);
 
 	/// grow add tiles to the bottom of the fields.
 	void grow(fieldRow row);
+
+	/// save takes the snapshot of the field, copying only
+	/// the rows modified since the last snapshot into the
+	/// arena. The other rows are shared with the previous
+	/// snapshots taken in the same arena.
+	void save(fieldSnapshot&, snapshotArena&);
+
+	/// restore reverts the field to the snapshot, copying
+	/// only the rows that differ from the field. All path
+	/// finders of the field are invalidated.
+	void restore(const fieldSnapshot&, const snapshotArena&);
 }; // struct hacktile::model::field
 
 } // namespace hacktile::model
@@ -0,0 +1,163 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file timing.hpp
+ * @brief gravity, lock delay and auto shift of playground
+ * @author aegistudio
+ *
+ * This file provides the timing engine, which moves the tile
+ * in the playground as the time elapses: the tile falls with
+ * the gravity, locks after the lock delay on the ground, and
+ * shifts repeatedly while the direction is held.
+ *
+ * The time is measured in integral ticks provided by the
+ * caller, and the engine never reads the clock itself, so
+ * that the same inputs at the same ticks always result in
+ * the same game, whether it runs in real time or headlessly
+ * at accelerated time.
+ */
+#include "model/playground.hpp"
+#include <cstdint>
+
+namespace hacktile {
+namespace model {
+
+/// ticksPerSecond is the number of ticks in a second,
+/// which are microseconds.
+constexpr uint64_t ticksPerSecond = 1000000;
+
+/// gravityOfLevel returns the ticks for the tile to fall a
+/// row in the level counting from 1, by the guideline curve.
+uint64_t gravityOfLevel(int level);
+
+/**
+ * @brief timingConfig specifies the timing of the engine,
+ * in ticks unless specified otherwise.
+ */
+struct timingConfig {
+	/// gravity is the ticks for the tile to fall a row,
+	/// or 0 if the tile does not fall itself.
+	uint64_t gravity;
+
+	/// softDropGravity is the gravity while soft dropping,
+	/// or 0 for dropping to the ground at once.
+	uint64_t softDropGravity;
+
+	/// lockDelay is the ticks for the tile on the ground to
+	/// be locked.
+	uint64_t lockDelay;
+
+	/// maxLockResets is the number of times the lock delay
+	/// could be reset by moving or rotating on the ground,
+	/// which is refilled when the tile reaches a lower row.
+	int maxLockResets;
+
+	/// das is the ticks to hold the direction before the
+	/// tile shifts repeatedly, and arr is the ticks between
+	/// the repeated shifts, or 0 for shifting to the end.
+	uint64_t das, arr;
+
+	/// timingConfig creates the config of the level 1.
+	timingConfig(): gravity(gravityOfLevel(1)),
+		softDropGravity(gravityOfLevel(1) / 20),
+		lockDelay(ticksPerSecond / 2), maxLockResets(15),
+		das(ticksPerSecond / 6), arr(ticksPerSecond / 30) {}
+};
+
+/**
+ * @brief timingInput are the inputs that are held rather
+ * than applied at once.
+ */
+enum class timingInput {
+	left,
+	right,
+	softDrop,
+};
+
+/**
+ * @brief timingEngine drives the tile of the playground with
+ * the time elapsed.
+ *
+ * The caller advances the engine to the current tick before
+ * feeding the inputs, and the held inputs are pressed and
+ * released through the engine. The other inputs are applied
+ * to the playground directly after advancing the engine,
+ * and the engine observes them through the events, e.g.
+ * rotating the tile on the ground resets the lock delay.
+ *
+ * The events due at the same tick are processed in the order
+ * of shifting, falling and locking.
+ */
+class timingEngine : public playgroundListener {
+	playground& play;
+	timingConfig config;
+	hacktile::util::eventSubscription<playgroundListener> subscription;
+	uint64_t now;
+
+	// The held inputs, and the direction that the tile is
+	// shifting, which is the direction held last.
+	bool leftHeld, rightHeld, softDropHeld;
+	int shift;
+	bool shiftCharged;
+
+	// The lock delay resets available and the lowest row
+	// reached by the current tile.
+	int lockResets;
+	int8_t lowestY;
+
+	// The ticks of the next shift, fall and lock, or never
+	// if they are not scheduled.
+	uint64_t nextShift, nextFall, lockDeadline;
+
+	// fallInterval returns the gravity in effect.
+	uint64_t fallInterval() const;
+
+	// isGrounded returns whether the tile is on the ground.
+	bool isGrounded() const;
+
+	// reschedule updates the fall and lock schedule after
+	// the tile is spawned or moved.
+	void reschedule();
+
+	// step processes the event due at the tick.
+	void step(uint64_t tick);
+public:
+	/// never is the tick of the events not scheduled.
+	static constexpr uint64_t never = UINT64_MAX;
+
+	/// timingEngine creates the engine driving the
+	/// playground from the tick 0.
+	timingEngine(playground& play,
+		const timingConfig& config = timingConfig());
+
+	/// getConfig returns the config of the engine.
+	const timingConfig& getConfig() const {
+		return config;
+	}
+
+	/// getTime returns the tick the engine is at.
+	uint64_t getTime() const {
+		return now;
+	}
+
+	/// nextDeadline returns the tick of the next event, or
+	/// never if nothing will happen without inputs.
+	uint64_t nextDeadline() const;
+
+	/// advance processes the events until the tick, which
+	/// must not go back in time.
+	void advance(uint64_t tick);
+
+	/// press advances to the tick and holds the input.
+	void press(timingInput input, uint64_t tick);
+
+	/// release advances to the tick and releases the input.
+	void release(timingInput input, uint64_t tick);
+
+	virtual void tileSpawn(const tileSpawnEvent&) override;
+	virtual void tileMove(const tileMoveEvent&) override;
+	virtual void gameEnd(const gameEndEvent&) override;
+}; // class hacktile::model::timingEngine
+
+} // namespace hacktile::model
+} // namespace hacktile
@@ -0,0 +1,171 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file beam.hpp
+ * @brief beam search bot looking ahead with previews
+ * @author aegistudio
+ *
+ * This file provides the beam search controller, which
+ * looks ahead the current tile, the tile in swap and the
+ * tiles in preview, and plays the current tile towards the
+ * best field found after all of them are locked.
+ */
+#include "simulation/controller.hpp"
+#include "simulation/evaluator.hpp"
+#include "simulation/transposition.hpp"
+#include "simulation/features.hpp"
+#include "model/playground.hpp"
+#include "model/placement.hpp"
+#include <vector>
+#include <memory>
+
+namespace hacktile {
+namespace simulation {
+
+/**
+ * @brief beamConfig specifies how the beam search should
+ * be performed.
+ */
+struct beamConfig {
+	/// beamWidth is the number of fields kept in each ply.
+	size_t beamWidth;
+
+	/// minBeamWidth and maxBeamWidth are the range that the
+	/// beam width could be tuned to fit the time budget.
+	size_t minBeamWidth, maxBeamWidth;
+
+	/// maxDepth is the maximum number of tiles to lock in
+	/// the search, including the current tile.
+	int maxDepth;
+
+	/// timeBudget is the expected time of each move in
+	/// seconds, or 0 to keep the beam width unchanged.
+	double timeBudget;
+
+	/// tableBits is the logarithm of the number of entries
+	/// in the transposition table, or 0 to disable it.
+	int tableBits;
+
+	/// peekBeyondPreviews is whether the tiles beyond the
+	/// previews are searched when the generator could tell
+	/// them, which is only fair if the ruleset allows it.
+	bool peekBeyondPreviews;
+
+	/// beamConfig creates the default config.
+	beamConfig(): beamWidth(32), minBeamWidth(1),
+		maxBeamWidth(256), maxDepth(6), timeBudget(0),
+		tableBits(16), peekBeyondPreviews(false) {}
+};
+
+/**
+ * @brief beamController searches the placements of the
+ * current tile and the tiles ahead ply by ply, keeping the
+ * best fields of each ply in the beam.
+ *
+ * Every ply locks either the next tile of the queue, or the
+ * tile swapped out with it, in every placement, and all
+ * working memory is reserved when the controller is created,
+ * so that expanding the nodes will not allocate. Before the
+ * candidates could outgrow the room for the placements of
+ * another node, they are pruned to the beam width.
+ *
+ * The evaluations are cached in the transposition table
+ * by the hash of the field, and the table is kept across
+ * moves, so that the fields looked ahead in previous moves
+ * are not evaluated again. The fields missing in the table
+ * are evaluated in batches of featureBatchSize.
+ *
+ * When a time budget is specified, the beam width is tuned
+ * after each move, which makes the moves dependent on the
+ * speed of the machine.
+ */
+class beamController : public controller {
+	// beamNode is the field after locking tiles in a ply.
+	struct beamNode {
+		hacktile::model::field f;
+		const hacktile::model::tile* swap;
+		uint8_t cursor;
+		uint16_t rootMove;
+		int lines;
+		double score;
+	};
+
+	// beamCandidate is an expansion of a node, which will
+	// be locked again into the next ply if it is selected.
+	struct beamCandidate {
+		uint16_t parent;
+		bool swapped;
+		hacktile::model::tileState state;
+		uint8_t clear;
+		double score;
+	};
+
+	// rootMove is the move of current tile in the playground
+	// that the nodes have been expanded from.
+	struct rootMove {
+		bool swapped;
+		hacktile::model::tileState state;
+	};
+
+	beamConfig config;
+	std::unique_ptr<fieldEvaluator> evaluator;
+	std::shared_ptr<transpositionTable> table;
+	std::unique_ptr<hacktile::model::placementFinder> finder;
+	std::vector<beamNode> beam, nextBeam;
+	std::vector<beamCandidate> candidates;
+	std::vector<rootMove> rootMoves;
+	std::vector<const hacktile::model::tile*> queue;
+	std::vector<hacktile::model::tileInput> path;
+
+	// The fields pending for evaluation, which are evaluated
+	// in a batch once there're enough of them.
+	hacktile::model::field pending[featureBatchSize];
+	const hacktile::model::field* pendingFields[featureBatchSize];
+	size_t pendingCandidates[featureBatchSize];
+	size_t numPending;
+
+	// queueLimit returns the most tiles in the queue, which
+	// is the room reserved for the queue.
+	size_t queueLimit() const;
+
+	// prune keeps only the best candidates that could be
+	// selected into the beam, after evaluating the pending.
+	void prune();
+
+	// pieceOf evaluates the tile to lock, and the tile in
+	// swap and the queue cursor after locking it.
+	bool pieceOf(const beamNode&, bool swapped,
+		const hacktile::model::tile*& typ,
+		const hacktile::model::tile*& swap, uint8_t& cursor) const;
+
+	// expand evaluates the candidates of the node.
+	void expand(uint16_t parent, bool swapped);
+
+	// flush evaluates the pending fields and adds their
+	// scores to the candidates.
+	void flush();
+
+	// search runs the beam search and returns the move of
+	// the current tile, or false if every move tops out.
+	bool search(const hacktile::model::playground&, rootMove&);
+public:
+	/// beamController creates the controller with the config
+	/// and the evaluator, or the linear evaluator if null.
+	///
+	/// The transposition table could be shared with other
+	/// controllers using the same evaluator, otherwise the
+	/// table is created from the config.
+	beamController(const beamConfig& = beamConfig(),
+		std::unique_ptr<fieldEvaluator> = nullptr,
+		std::shared_ptr<transpositionTable> = nullptr);
+
+	/// getBeamWidth returns the current beam width.
+	size_t getBeamWidth() const {
+		return config.beamWidth;
+	}
+
+	virtual bool control(hacktile::model::playground&) override;
+}; // class hacktile::simulation::beamController
+
+} // namespace hacktile::simulation
+} // namespace hacktile
@@ -0,0 +1,81 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file controller.hpp
+ * @brief headless controllers driving the playground
+ * @author aegistudio
+ *
+ * This file provides the interface of controllers, which
+ * take the place of the player in simulations and play the
+ * tiles in the playground, and some simple implementations
+ * of the controller.
+ */
+#include "model/playground.hpp"
+#include "model/placement.hpp"
+#include "simulation/evaluator.hpp"
+#include <vector>
+#include <memory>
+
+namespace hacktile {
+namespace simulation {
+
+/**
+ * @brief controller is the interface of anything that plays
+ * the playground without terminal attached.
+ */
+struct controller {
+	// virtual destructor for pure virtual class.
+	virtual ~controller() {}
+
+	/// reset is invoked before a new game is started, with
+	/// the seed of the game.
+	virtual void reset(uint64_t) {}
+
+	/// control plays the current tile in the playground
+	/// until it is locked, and returns whether the tile is
+	/// locked. The game stops once it returns false.
+	virtual bool control(hacktile::model::playground&) = 0;
+}; // struct hacktile::simulation::controller
+
+/**
+ * @brief scriptedController plays each tile with the inputs
+ * from the scripts in turn, and hard drops the tile after
+ * the script has been applied.
+ */
+class scriptedController : public controller {
+	std::vector<std::vector<hacktile::model::tileInput>> scripts;
+	size_t cursor;
+public:
+	/// scriptedController creates the controller with the
+	/// scripts to apply to the tiles cyclically.
+	scriptedController(
+		std::vector<std::vector<hacktile::model::tileInput>> scripts):
+		scripts(std::move(scripts)), cursor(0) {}
+
+	virtual void reset(uint64_t seed) override;
+
+	virtual bool control(hacktile::model::playground&) override;
+}; // class hacktile::simulation::scriptedController
+
+/**
+ * @brief greedyController is a simple bot that evaluates
+ * every placement of the current tile, and plays the one
+ * leaving the best field.
+ *
+ * The field is evaluated with the linear evaluator unless
+ * another evaluator is specified.
+ */
+class greedyController : public controller {
+	std::unique_ptr<hacktile::model::placementFinder> finder;
+	std::unique_ptr<fieldEvaluator> evaluator;
+	std::vector<hacktile::model::tileInput> path;
+public:
+	/// greedyController creates the controller with the
+	/// evaluator, or the linear evaluator if it is null.
+	greedyController(std::unique_ptr<fieldEvaluator> = nullptr);
+
+	virtual bool control(hacktile::model::playground&) override;
+}; // class hacktile::simulation::greedyController
+
+} // namespace hacktile::simulation
+} // namespace hacktile
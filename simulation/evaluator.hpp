@@ -0,0 +1,89 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file evaluator.hpp
+ * @brief pluggable field evaluation of the bots
+ * @author aegistudio
+ *
+ * This file provides the interface of field evaluators,
+ * which score the field after tiles are locked, so that the
+ * bots could compare the placements, and the well known
+ * linear evaluator of the field.
+ */
+#include "model/tile.hpp"
+#include "simulation/features.hpp"
+#include <cstddef>
+
+namespace hacktile {
+namespace simulation {
+
+/**
+ * @brief fieldEvaluator is the interface scoring the field
+ * after some tiles have been locked.
+ *
+ * The score of locking tiles is the score of the field plus
+ * the reward of the lines cleared by them, and the higher
+ * the score the better. The score of the field must depend
+ * on the occupied cells only, so that it could be cached
+ * by the hash of the field.
+ */
+struct fieldEvaluator {
+	// virtual destructor for pure virtual class.
+	virtual ~fieldEvaluator() {}
+
+	/// evaluate returns the score of the field.
+	virtual double evaluate(const hacktile::model::field&) const = 0;
+
+	/// evaluateBatch returns the scores of the fields, which
+	/// could be overriden for evaluating them at once.
+	virtual void evaluateBatch(const hacktile::model::field* const fields[],
+		size_t numFields, double scores[]) const {
+		for(size_t i = 0; i < numFields; ++ i)
+			scores[i] = evaluate(*fields[i]);
+	}
+
+	/// reward returns the score of clearing the lines.
+	virtual double reward(int lines) const = 0;
+}; // struct hacktile::simulation::fieldEvaluator
+
+/**
+ * @brief linearEvaluator scores the field with a linear
+ * combination of the field features and cleared lines.
+ */
+class linearEvaluator : public fieldEvaluator {
+public:
+	/// weights of each feature of the field.
+	struct weights {
+		double height, lines, holes, bumpiness;
+		double maxHeight, rowTransitions, columnTransitions, wells;
+
+		/// weights creates the default weights, which are
+		/// tuned for surviving rather than scoring, and
+		/// only aggregate height, holes and bumpiness are
+		/// considered.
+		weights(): height(-0.510066), lines(0.760666),
+			holes(-0.35663), bumpiness(-0.184483), maxHeight(0),
+			rowTransitions(0), columnTransitions(0), wells(0) {}
+	};
+private:
+	weights w;
+
+	// score evaluates the linear combination of features.
+	double score(const fieldFeatures&) const;
+public:
+	/// linearEvaluator creates the evaluator with weights.
+	linearEvaluator(const weights& w = weights()): w(w) {}
+
+	virtual double evaluate(
+		const hacktile::model::field&) const override;
+
+	virtual void evaluateBatch(const hacktile::model::field* const fields[],
+		size_t numFields, double scores[]) const override;
+
+	virtual double reward(int lines) const override {
+		return w.lines * lines;
+	}
+}; // class hacktile::simulation::linearEvaluator
+
+} // namespace hacktile::simulation
+} // namespace hacktile
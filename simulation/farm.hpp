@@ -0,0 +1,56 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file farm.hpp
+ * @brief multi-threaded game farm of the simulator
+ * @author aegistudio
+ *
+ * This file provides the game farm, which runs the games of
+ * the simulator on a pool of worker threads. Since each game
+ * is fully independent, every worker owns its controller,
+ * playground, generator and listeners, and no data is shared
+ * between workers except the indices of the games to run.
+ */
+#include "simulation/simulator.hpp"
+#include <functional>
+#include <memory>
+
+namespace hacktile {
+namespace simulation {
+
+/**
+ * @brief gameFarm runs the games of the simulator in
+ * parallel, and merges the stats of the workers once all
+ * games are done.
+ *
+ * The games are initially split evenly into ranges owned
+ * by each worker. A worker takes games from the front of
+ * its own range, and once it runs out of games, it steals
+ * the latter half of the range of another worker.
+ */
+class gameFarm {
+public:
+	/// controllerFactory creates the controller of a worker.
+	typedef std::function<std::unique_ptr<controller>()>
+		controllerFactory;
+private:
+	const simulator& sim;
+	controllerFactory factory;
+	unsigned numWorkers;
+public:
+	/// gameFarm creates the farm running the games of the
+	/// simulator with specified number of workers, or the
+	/// number of cores if it is 0.
+	gameFarm(const simulator&, controllerFactory, unsigned numWorkers = 0);
+
+	/// getNumWorkers returns the number of workers.
+	unsigned getNumWorkers() const {
+		return numWorkers;
+	}
+
+	/// run simulates all games in the config of simulator.
+	simulationStats run() const;
+}; // class hacktile::simulation::gameFarm
+
+} // namespace hacktile::simulation
+} // namespace hacktile
@@ -0,0 +1,87 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file features.hpp
+ * @brief batch extraction of heuristic field features
+ * @author aegistudio
+ *
+ * This file provides the extraction of the well known
+ * heuristic features of the fields. The fields are processed
+ * in batches, with the compact rows of the fields transposed
+ * so that each row of all fields in the batch is processed
+ * by a single SIMD instruction, one 16-bit lane per field.
+ */
+#include "model/tile.hpp"
+#include <cstddef>
+
+namespace hacktile {
+namespace simulation {
+
+/**
+ * @brief fieldFeatures is the heuristic features of a field.
+ */
+struct fieldFeatures {
+	/// aggregateHeight is the sum of the column heights,
+	/// and maxHeight is the highest of them.
+	int aggregateHeight, maxHeight;
+
+	/// bumpiness is the sum of height differences between
+	/// the adjacent columns.
+	int bumpiness;
+
+	/// holes is the number of empty cells with any cell
+	/// above them in the same column.
+	int holes;
+
+	/// rowTransitions is the number of horizontally adjacent
+	/// cell pairs differing in occupancy, with the walls
+	/// considered occupied, in rows below maxHeight.
+	int rowTransitions;
+
+	/// columnTransitions is the number of vertically adjacent
+	/// cell pairs differing in occupancy, with the floor
+	/// considered occupied.
+	int columnTransitions;
+
+	/// wells is the cumulative depth of the wells, that is,
+	/// a well of n cells open to the top adds 1 + ... + n.
+	/// A well cell is an empty cell with no cell above it,
+	/// and both neighbours occupied (or the wall).
+	int wells;
+};
+
+/**
+ * @brief featureBackend is the instruction set used for the
+ * feature extraction.
+ */
+enum class featureBackend {
+	scalar,
+	sse2,
+	avx2,
+};
+
+/// featureBatchSize is the number of fields processed in
+/// a batch by the widest backend, which is the suggested
+/// number of fields to extract at once.
+constexpr size_t featureBatchSize = 16;
+
+/// bestFeatureBackend returns the fastest backend that is
+/// both compiled and supported by the running processor.
+featureBackend bestFeatureBackend();
+
+/// isFeatureBackendSupported returns whether the backend
+/// could be used on the running processor.
+bool isFeatureBackendSupported(featureBackend);
+
+/// extractFeatures evaluates the features of the fields with
+/// the best backend.
+void extractFeatures(const hacktile::model::field* const fields[],
+	size_t numFields, fieldFeatures features[]);
+
+/// extractFeatures evaluates the features of the fields with
+/// specified backend, which must be supported.
+void extractFeatures(const hacktile::model::field* const fields[],
+	size_t numFields, fieldFeatures features[], featureBackend);
+
+} // namespace hacktile::simulation
+} // namespace hacktile
@@ -0,0 +1,153 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file simulator.hpp
+ * @brief headless batch simulation of playgrounds
+ * @author aegistudio
+ *
+ * This file provides the simulator, which runs many
+ * independent games of the playground with controllers and
+ * seeded tile generators, and collects aggregated stats of
+ * the games. No terminal is involved in the simulation.
+ */
+#include "model/tile.hpp"
+#include "model/generator.hpp"
+#include "model/playground.hpp"
+#include "simulation/controller.hpp"
+#include <vector>
+#include <memory>
+
+namespace hacktile {
+namespace simulation {
+
+/**
+ * @brief generatorType is the tile generator of the games.
+ */
+enum class generatorType {
+	permutator,
+	historyRoll,
+};
+
+/**
+ * @brief randomizerType is the randomizer of the generator.
+ */
+enum class randomizerType {
+	mt19937,
+	xoshiro256,
+};
+
+/// lookaheadMargin is the tiles generated beyond the previews
+/// in a batch by default, which keeps the snapshots of the
+/// lookahead small while the previews are refilled in bulk.
+constexpr size_t lookaheadMargin = 3;
+
+/**
+ * @brief simulationConfig specifies how the games should
+ * be simulated.
+ */
+struct simulationConfig {
+	/// numGames is the number of games to simulate.
+	uint64_t numGames;
+
+	/// seed is the seed of the first game, and the seed of
+	/// each game is the seed plus its index.
+	uint64_t seed;
+
+	/// maxPieces is the number of tiles to lock before the
+	/// game is considered completed.
+	uint64_t maxPieces;
+
+	/// numPreviews is the number of previews of playground.
+	int numPreviews;
+
+	/// generator is the tile generator of the games.
+	generatorType generator;
+
+	/// randomizer is the randomizer of the generator, where
+	/// mt19937 plays the same games as it did before.
+	randomizerType randomizer;
+
+	/// lookahead is the number of tiles generated at least
+	/// in a batch through the tileLookahead, which also lets
+	/// the controllers peek beyond the previews, or 0 to
+	/// generate the tiles one at a time. The tiles buffered
+	/// are saved in every snapshot of the generator.
+	size_t lookahead;
+
+	/// simulationConfig creates the default config, which
+	/// looks ahead the previews and the lookaheadMargin.
+	simulationConfig(): numGames(1000), seed(0), maxPieces(1000),
+		numPreviews(5), generator(generatorType::permutator),
+		randomizer(randomizerType::mt19937),
+		lookahead(size_t(numPreviews) + lookaheadMargin) {}
+};
+
+/**
+ * @brief simulationStats is the aggregated stats of games.
+ */
+struct simulationStats {
+	uint64_t numGames, numPieces, numLines, numTopOuts;
+	double seconds;
+
+	/// simulationStats creates the empty stats.
+	simulationStats(): numGames(0), numPieces(0), numLines(0),
+		numTopOuts(0), seconds(0) {}
+
+	/// operator+= merges the stats of other games. The
+	/// seconds are left untouched since the games might
+	/// have been simulated at the same time.
+	simulationStats& operator+=(const simulationStats& r) {
+		numGames += r.numGames;
+		numPieces += r.numPieces;
+		numLines += r.numLines;
+		numTopOuts += r.numTopOuts;
+		return *this;
+	}
+
+	/// piecesPerSecond returns the number of pieces locked
+	/// in a second of the simulation.
+	double piecesPerSecond() const {
+		return seconds > 0? numPieces / seconds : 0;
+	}
+
+	/// topOutRate returns the ratio of games topped out.
+	double topOutRate() const {
+		return numGames > 0? double(numTopOuts) / numGames : 0;
+	}
+};
+
+/// tetrominoGenerator creates the tile generator of the
+/// tetrominoes in the order of the enum, with the seed.
+std::unique_ptr<hacktile::model::tileGenerator>
+tetrominoGenerator(generatorType, uint64_t seed,
+	randomizerType = randomizerType::mt19937);
+
+/**
+ * @brief simulator runs the games in the simulation.
+ */
+class simulator {
+	simulationConfig config;
+public:
+	/// simulator creates the simulator with the config.
+	simulator(const simulationConfig&);
+
+	/// getConfig returns the config of the simulator.
+	const simulationConfig& getConfig() const {
+		return config;
+	}
+
+	/// createGenerator creates the tile generator of the
+	/// game with specified seed.
+	std::unique_ptr<hacktile::model::tileGenerator>
+	createGenerator(uint64_t seed) const;
+
+	/// runGame simulates a single game with specified seed
+	/// and adds the result of the game to the stats.
+	void runGame(controller&, uint64_t seed, simulationStats&) const;
+
+	/// run simulates all games in the config one by one.
+	simulationStats run(controller&) const;
+}; // class hacktile::simulation::simulator
+
+} // namespace hacktile::simulation
+} // namespace hacktile
@@ -0,0 +1,281 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file beam.cpp
+ * @author aegistudio
+ * @brief Implementation of the beam search controller.
+ *
+ * This file implements the beam search controller. Each ply
+ * is searched in two passes: the first pass locks every
+ * placement of the nodes into a pending field and scores
+ * the pending fields in batches, and the second pass locks
+ * the selected candidates again into the nodes of the next
+ * ply, so that only the fields kept in the beam are copied
+ * into the nodes.
+ */
+#include "simulation/beam.hpp"
+#include <algorithm>
+#include <chrono>
+using namespace hacktile::model;
+
+namespace hacktile {
+namespace simulation {
+
+// maxPlacements is the most placements of a node, which is
+// bounded by the states that the finder could search.
+static constexpr size_t maxPlacements = placementFinder::numNodes;
+
+beamController::beamController(const beamConfig& config,
+	std::unique_ptr<fieldEvaluator> evaluator,
+	std::shared_ptr<transpositionTable> table):
+	config(config), evaluator(std::move(evaluator)),
+	table(std::move(table)), finder(new placementFinder),
+	beam(), nextBeam(),
+	candidates(), rootMoves(), queue(), path(), numPending(0) {
+	if(this->evaluator == nullptr)
+		this->evaluator.reset(new linearEvaluator());
+	if(this->table == nullptr && config.tableBits > 0)
+		this->table.reset(new transpositionTable(config.tableBits));
+	this->config.maxBeamWidth = std::max<size_t>(1, config.maxBeamWidth);
+	this->config.minBeamWidth = std::min(
+		std::max<size_t>(1, config.minBeamWidth),
+		this->config.maxBeamWidth);
+	this->config.beamWidth = std::min(std::max(config.beamWidth,
+		this->config.minBeamWidth), this->config.maxBeamWidth);
+	size_t width = this->config.maxBeamWidth;
+	beam.resize(width);
+	nextBeam.resize(width);
+	candidates.reserve(width + maxPlacements);
+	rootMoves.reserve(width);
+	path.reserve(placementFinder::numRows);
+	queue.reserve(queueLimit());
+	for(size_t i = 0; i < featureBatchSize; ++ i)
+		pendingFields[i] = &pending[i];
+}
+
+size_t beamController::queueLimit() const {
+	return size_t(std::max(int(playgroundSnapshot::maxNumPreviews),
+		config.maxDepth)) + 1;
+}
+
+void beamController::prune() {
+	flush();
+	if(candidates.size() <= config.beamWidth) return;
+	std::nth_element(candidates.begin(),
+		candidates.begin() + (config.beamWidth - 1), candidates.end(),
+		[](const beamCandidate& a, const beamCandidate& b) {
+			return a.score > b.score;
+		});
+	candidates.resize(config.beamWidth);
+}
+
+bool beamController::pieceOf(const beamNode& node, bool swapped,
+	const tile*& typ, const tile*& swap, uint8_t& cursor) const {
+	if(node.cursor >= queue.size()) return false;
+	const tile* next = queue[node.cursor];
+	if(!swapped) {
+		typ = next;
+		swap = node.swap;
+		cursor = node.cursor + 1;
+	} else if(node.swap == nullptr) {
+		// The next tile is swapped in from the queue.
+		if(size_t(node.cursor) + 1 >= queue.size()) return false;
+		typ = queue[node.cursor + 1];
+		swap = next;
+		cursor = node.cursor + 2;
+	} else {
+		// Swapping the same tile is the same as not swapping.
+		if(node.swap == next) return false;
+		typ = node.swap;
+		swap = next;
+		cursor = node.cursor + 1;
+	}
+	return true;
+}
+
+void beamController::expand(uint16_t parent, bool swapped) {
+	const beamNode& node = beam[parent];
+	const tile* typ;
+	const tile* swap;
+	uint8_t cursor;
+	if(!pieceOf(node, swapped, typ, swap, cursor)) return;
+	tilePathFinder pfd(typ);
+	if(!node.f.spawn(pfd)) return;
+	size_t numPlacements = finder->search(node.f, pfd);
+	for(size_t i = 0; i < numPlacements; ++ i) {
+		const tilePlacement& placement = finder->getPlacement(i);
+		field& locked = pending[numPending];
+		locked = node.f;
+		tilePathFinder pfd(typ, placement.state);
+		uint8_t clear = 0;
+		if(!locked.spawn(pfd)) continue;
+		if(!locked.lock(pfd, clear)) continue;
+
+		// The placement is discarded if the next tile in the
+		// queue could not be spawned after it is locked.
+		if(cursor < queue.size()) {
+			tilePathFinder next(queue[cursor]);
+			if(!locked.spawn(next)) continue;
+		}
+		beamCandidate candidate;
+		candidate.parent = parent;
+		candidate.swapped = swapped;
+		candidate.state = placement.state;
+		candidate.clear = clear;
+		candidate.score = evaluator->reward(node.lines + clear);
+
+		// Add the score of the field in the table, or
+		// evaluate the field later in a batch.
+		double score;
+		if(table != nullptr && table->probe(locked.getHash(), score)) {
+			candidate.score += score;
+			candidates.push_back(candidate);
+			continue;
+		}
+		candidates.push_back(candidate);
+		pendingCandidates[numPending ++] = candidates.size() - 1;
+		if(numPending >= featureBatchSize) flush();
+	}
+}
+
+void beamController::flush() {
+	double scores[featureBatchSize];
+	evaluator->evaluateBatch(pendingFields, numPending, scores);
+	for(size_t i = 0; i < numPending; ++ i) {
+		candidates[pendingCandidates[i]].score += scores[i];
+		if(table != nullptr)
+			table->store(pending[i].getHash(), scores[i]);
+	}
+	numPending = 0;
+}
+
+bool beamController::search(const playground& play, rootMove& move) {
+	// Collect the tiles to lock, from the current tile to
+	// the last preview that is available, or the tiles
+	// peeked beyond the previews if it is allowed.
+	queue.clear();
+	queue.push_back(play.getCurrentTile());
+	size_t numTiles = config.peekBeyondPreviews?
+		size_t(config.maxDepth) : size_t(play.getNumPreviews());
+	numTiles = std::min(numTiles, queueLimit() - 1);
+	for(size_t i = 0; i < numTiles; ++ i) {
+		const tile* next = play.peekTile(i);
+		if(next == nullptr) break;
+		queue.push_back(next);
+	}
+
+	// Initialize the beam with the field of the playground.
+	beamNode& root = beam[0];
+	root.f = play.getField();
+	root.swap = play.getSwapTile();
+	root.cursor = 0;
+	root.rootMove = 0;
+	root.lines = 0;
+	root.score = 0;
+	size_t numNodes = 1;
+	rootMoves.clear();
+
+	int maxDepth = std::min(config.maxDepth, int(queue.size()));
+	for(int depth = 0; depth < maxDepth; ++ depth) {
+		candidates.clear();
+		for(size_t i = 0; i < numNodes; ++ i) {
+			// The room reserved holds the placements of one
+			// more node over the widest beam.
+			for(int swapped = 0; swapped < 2; ++ swapped) {
+				if(swapped && depth == 0 && !play.isSwapEnabled())
+					continue;
+				if(candidates.size() > config.maxBeamWidth) prune();
+				expand(uint16_t(i), swapped != 0);
+			}
+		}
+		flush();
+		if(candidates.empty()) break;
+
+		// Select the best candidates, and lock them into
+		// the nodes of the next ply.
+		size_t width = std::min(config.beamWidth, candidates.size());
+		std::nth_element(candidates.begin(),
+			candidates.begin() + (width - 1), candidates.end(),
+			[](const beamCandidate& a, const beamCandidate& b) {
+				return a.score > b.score;
+			});
+		for(size_t i = 0; i < width; ++ i) {
+			const beamCandidate& candidate = candidates[i];
+			const beamNode& parent = beam[candidate.parent];
+			beamNode& node = nextBeam[i];
+			const tile* typ = nullptr;
+			pieceOf(parent, candidate.swapped,
+				typ, node.swap, node.cursor);
+			node.f = parent.f;
+			tilePathFinder locked(typ, candidate.state);
+			uint8_t clear = 0;
+			node.f.spawn(locked);
+			node.f.lock(locked, clear);
+			node.lines = parent.lines + clear;
+			node.score = candidate.score;
+			if(depth == 0) {
+				node.rootMove = uint16_t(rootMoves.size());
+				rootMoves.push_back(rootMove{
+					candidate.swapped, candidate.state});
+			} else node.rootMove = parent.rootMove;
+		}
+		std::swap(beam, nextBeam);
+		numNodes = width;
+	}
+	if(rootMoves.empty()) return false;
+
+	// Play the root move leading to the best node.
+	size_t best = 0;
+	for(size_t i = 1; i < numNodes; ++ i)
+		if(beam[i].score > beam[best].score) best = i;
+	move = rootMoves[beam[best].rootMove];
+	return true;
+}
+
+bool beamController::control(playground& play) {
+	if(!play.isInGame()) return false;
+	auto start = std::chrono::steady_clock::now();
+	rootMove move;
+	if(!search(play, move)) return play.hardDrop();
+	if(move.swapped) {
+		play.swapTile();
+		if(!play.isInGame()) return false;
+	}
+
+	// Find the placement of the move again in the field of
+	// the playground, and replay its input path.
+	const field& f = play.getField();
+	tilePathFinder current(play.getCurrentTile(), play.getCurrentState());
+	if(f.spawn(current)) {
+		size_t numPlacements = finder->search(f, current);
+		for(size_t i = 0; i < numPlacements; ++ i) {
+			const tilePlacement& placement = finder->getPlacement(i);
+			const tileState& state = placement.state;
+			if(state.dir.getValue() != move.state.dir.getValue() ||
+				state.x != move.state.x || state.y != move.state.y)
+				continue;
+			path.resize(placement.numInputs);
+			finder->retrievePath(placement, path.data());
+			for(tileInput in : path) play.input(in);
+			break;
+		}
+	}
+	bool locked = play.hardDrop();
+
+	// Tune the beam width so that the time of each move will
+	// approach the time budget.
+	if(config.timeBudget > 0) {
+		std::chrono::duration<double> elapsed =
+			std::chrono::steady_clock::now() - start;
+		size_t width = config.beamWidth;
+		if(elapsed.count() > config.timeBudget)
+			width = width * 3 / 4;
+		else if(elapsed.count() < config.timeBudget * 0.75)
+			width = width + std::max<size_t>(1, width / 8);
+		config.beamWidth = std::min(std::max(width,
+			config.minBeamWidth), config.maxBeamWidth);
+	}
+	return locked;
+}
+
+} // namespace hacktile::simulation
+} // namespace hacktile
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file controller.cpp
+ * @author aegistudio
+ * @brief Implementation of the simple controllers.
+ *
+ * This file implements the scripted controller, which is
+ * mostly used for reproducing scenarios, and the greedy
+ * controller, which is the baseline bot of simulations.
+ */
+#include "simulation/controller.hpp"
+#include <limits>
+using namespace hacktile::model;
+
+namespace hacktile {
+namespace simulation {
+
+void scriptedController::reset(uint64_t) {
+	cursor = 0;
+}
+
+bool scriptedController::control(playground& play) {
+	if(!scripts.empty()) {
+		for(tileInput in : scripts[cursor]) play.input(in);
+		if(++ cursor >= scripts.size()) cursor = 0;
+	}
+	return play.hardDrop();
+}
+
+greedyController::greedyController(
+	std::unique_ptr<fieldEvaluator> evaluator):
+	finder(new placementFinder), evaluator(std::move(evaluator)),
+	path() {
+	if(this->evaluator == nullptr)
+		this->evaluator.reset(new linearEvaluator());
+}
+
+bool greedyController::control(playground& play) {
+	if(!play.isInGame()) return false;
+	const tile* typ = play.getCurrentTile();
+	const field& f = play.getField();
+	tilePathFinder current(typ, play.getCurrentState());
+	if(!f.spawn(current)) return play.hardDrop();
+
+	// Lock the tile at each placement in a copy of field,
+	// and select the placement with the best score.
+	size_t numPlacements = finder->search(f, current);
+	double bestScore = -std::numeric_limits<double>::infinity();
+	const tilePlacement* best = nullptr;
+	for(size_t i = 0; i < numPlacements; ++ i) {
+		const tilePlacement& placement = finder->getPlacement(i);
+		field locked = f;
+		tilePathFinder pfd(typ, placement.state);
+		uint8_t clear = 0;
+		if(!locked.spawn(pfd)) continue;
+		if(!locked.lock(pfd, clear)) continue;
+		double score = evaluator->evaluate(locked)
+			+ evaluator->reward(clear);
+		if(score > bestScore) {
+			bestScore = score;
+			best = &placement;
+		}
+	}
+
+	// Replay the input path to the placement.
+	if(best != nullptr) {
+		path.resize(best->numInputs);
+		finder->retrievePath(*best, path.data());
+		for(tileInput in : path) play.input(in);
+	}
+	return play.hardDrop();
+}
+
+} // namespace hacktile::simulation
+} // namespace hacktile
@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file evaluator.cpp
+ * @author aegistudio
+ * @brief Implementation of the field evaluators.
+ *
+ * This file implements the linear evaluator, whose features
+ * are extracted in batches by the feature extraction.
+ */
+#include "simulation/evaluator.hpp"
+#include <algorithm>
+using namespace hacktile::model;
+
+namespace hacktile {
+namespace simulation {
+
+double linearEvaluator::score(const fieldFeatures& features) const {
+	return w.height * features.aggregateHeight
+		+ w.holes * features.holes
+		+ w.bumpiness * features.bumpiness
+		+ w.maxHeight * features.maxHeight
+		+ w.rowTransitions * features.rowTransitions
+		+ w.columnTransitions * features.columnTransitions
+		+ w.wells * features.wells;
+}
+
+double linearEvaluator::evaluate(const field& f) const {
+	// A single field is not worth the SIMD backends.
+	const field* fields[] = { &f };
+	fieldFeatures features;
+	extractFeatures(fields, 1, &features, featureBackend::scalar);
+	return score(features);
+}
+
+void linearEvaluator::evaluateBatch(const field* const fields[],
+	size_t numFields, double scores[]) const {
+	fieldFeatures features[featureBatchSize];
+	for(size_t base = 0; base < numFields; base += featureBatchSize) {
+		size_t n = std::min(featureBatchSize, numFields - base);
+		extractFeatures(fields + base, n, features);
+		for(size_t i = 0; i < n; ++ i)
+			scores[base + i] = score(features[i]);
+	}
+}
+
+} // namespace hacktile::simulation
+} // namespace hacktile
@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file farm.cpp
+ * @author aegistudio
+ * @brief Implementation of the game farm.
+ *
+ * This file implements the work stealing of the game farm.
+ * The range of games owned by a worker is packed into a
+ * single 64-bit atomic word, with the front in higher half
+ * and the end in lower half, so that both taking a game by
+ * the owner and stealing half of the range by other worker
+ * are a single compare-and-swap.
+ */
+#include "simulation/farm.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <stdexcept>
+
+namespace hacktile {
+namespace simulation {
+
+namespace {
+
+// gameRange is the range of games owned by a worker, which
+// is padded to avoid false sharing between workers.
+struct gameRange {
+	std::atomic<uint64_t> range;
+	char padding[64 - sizeof(std::atomic<uint64_t>)];
+
+	gameRange(): range(0) {}
+
+	static uint64_t pack(uint32_t front, uint32_t end) {
+		return (uint64_t(front) << 32) | end;
+	}
+
+	// take attempts to take the game at the front.
+	bool take(uint32_t& game) {
+		uint64_t current = range.load(std::memory_order_relaxed);
+		while(true) {
+			uint32_t front = current >> 32, end = uint32_t(current);
+			if(front >= end) return false;
+			if(range.compare_exchange_weak(current,
+				pack(front + 1, end))) {
+				game = front;
+				return true;
+			}
+		}
+	}
+
+	// steal attempts to steal the latter half of the range.
+	bool steal(uint32_t& front, uint32_t& end) {
+		uint64_t current = range.load(std::memory_order_relaxed);
+		while(true) {
+			uint32_t vfront = current >> 32, vend = uint32_t(current);
+			if(vfront >= vend) return false;
+			uint32_t middle = vfront + (vend - vfront) / 2;
+			if(range.compare_exchange_weak(current,
+				pack(vfront, middle))) {
+				front = middle;
+				end = vend;
+				return true;
+			}
+		}
+	}
+};
+
+} // anonymous namespace
+
+gameFarm::gameFarm(const simulator& sim,
+	controllerFactory factory, unsigned numWorkers):
+	sim(sim), factory(std::move(factory)), numWorkers(numWorkers) {
+	if(this->numWorkers == 0)
+		this->numWorkers = std::thread::hardware_concurrency();
+	if(this->numWorkers == 0) this->numWorkers = 1;
+}
+
+simulationStats gameFarm::run() const {
+	const simulationConfig& config = sim.getConfig();
+	if(config.numGames > UINT32_MAX)
+		throw std::runtime_error("too many games to simulate");
+	uint32_t numGames = uint32_t(config.numGames);
+
+	// Split the games evenly into the workers.
+	std::unique_ptr<gameRange[]> ranges(new gameRange[numWorkers]);
+	std::vector<simulationStats> stats(numWorkers);
+	for(unsigned i = 0; i < numWorkers; ++ i) {
+		uint32_t front = uint64_t(numGames) * i / numWorkers;
+		uint32_t end = uint64_t(numGames) * (i + 1) / numWorkers;
+		ranges[i].range.store(gameRange::pack(front, end));
+	}
+
+	// Each worker runs the games in its range, and steals
+	// from other workers after its range is exhausted.
+	auto worker = [&](unsigned id) {
+		std::unique_ptr<controller> ctrl = factory();
+		simulationStats local;
+		while(true) {
+			uint32_t game;
+			if(ranges[id].take(game)) {
+				sim.runGame(*ctrl, config.seed + game, local);
+				continue;
+			}
+			bool stolen = false;
+			for(unsigned n = 1; n < numWorkers && !stolen; ++ n) {
+				uint32_t front, end;
+				unsigned victim = (id + n) % numWorkers;
+				if(!ranges[victim].steal(front, end)) continue;
+				ranges[id].range.store(gameRange::pack(front, end));
+				stolen = true;
+			}
+			if(!stolen) break;
+		}
+		stats[id] = local;
+	};
+
+	// Run the workers and merge their stats.
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+	for(unsigned i = 1; i < numWorkers; ++ i)
+		threads.emplace_back(worker, i);
+	worker(0);
+	for(auto& thread : threads) thread.join();
+	std::chrono::duration<double> elapsed =
+		std::chrono::steady_clock::now() - start;
+
+	simulationStats result;
+	for(const auto& local : stats) result += local;
+	result.seconds = elapsed.count();
+	return result;
+}
+
+} // namespace hacktile::simulation
+} // namespace hacktile
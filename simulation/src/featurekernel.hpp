@@ -0,0 +1,198 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file featurekernel.hpp
+ * @brief lane generic kernel of the feature extraction
+ * @author aegistudio
+ *
+ * This file provides the feature extraction kernel, which
+ * is written against a lane type providing the bitwise and
+ * arithmetic operations on the 16-bit lanes, so that the
+ * same kernel is instantiated for the scalar, SSE2 and AVX2
+ * backends. The kernel must be instantiated where the
+ * instruction set of the lane type is enabled.
+ */
+#include "simulation/features.hpp"
+#include <algorithm>
+
+namespace hacktile {
+namespace simulation {
+namespace kernel {
+
+// maxRows is the maximum number of rows to transpose.
+constexpr int maxRows = hacktile::model::field::maxHeight;
+
+// scalarLanes is the lane type with a single lane.
+struct scalarLanes {
+	typedef uint16_t vec;
+	static constexpr size_t width = 1;
+	static vec load(const uint16_t* p) { return *p; }
+	static void store(uint16_t* p, vec v) { *p = v; }
+	static vec set1(uint16_t v) { return v; }
+	static vec zero() { return 0; }
+	static vec bitAnd(vec a, vec b) { return a & b; }
+	static vec bitOr(vec a, vec b) { return a | b; }
+	static vec bitXor(vec a, vec b) { return a ^ b; }
+	static vec andNot(vec a, vec b) { return ~a & b; }
+	static vec add(vec a, vec b) { return a + b; }
+	static vec sub(vec a, vec b) { return a - b; }
+	template<int n> static vec shl(vec a) { return uint16_t(a << n); }
+	template<int n> static vec shr(vec a) { return a >> n; }
+	static vec greater(vec a, vec b) { return a > b? 0xffff : 0; }
+};
+
+// popcount16 counts the bits of each 16-bit lane with the
+// operations of the lane type.
+template<typename L>
+inline typename L::vec popcount16(typename L::vec x) {
+	x = L::sub(x, L::bitAnd(L::template shr<1>(x), L::set1(0x5555)));
+	x = L::add(L::bitAnd(x, L::set1(0x3333)),
+		L::bitAnd(L::template shr<2>(x), L::set1(0x3333)));
+	x = L::bitAnd(L::add(x, L::template shr<4>(x)), L::set1(0x0f0f));
+	return L::bitAnd(L::add(x, L::template shr<8>(x)), L::set1(0x001f));
+}
+
+// bitsOf evaluates the number of bits to represent value.
+constexpr int bitsOf(int value) {
+	return value == 0? 0 : 1 + bitsOf(value >> 1);
+}
+
+// numPlanes is the number of bit planes of the well depth
+// counters, which must be able to count the maxRows.
+constexpr int numPlanes = bitsOf(maxRows);
+static_assert((1 << numPlanes) > maxRows, "not enough bit planes");
+
+// extractBatch evaluates the holes, transitions and wells of
+// the transposed rows, whose row y of lane i is located at
+// rows[y * L::width + i], from the top row downward.
+template<typename L>
+void extractBatch(const uint16_t* rows, const uint16_t* tops,
+	int numRows, uint16_t* holesOut, uint16_t* rowTransitionsOut,
+	uint16_t* columnTransitionsOut, uint16_t* wellsOut) {
+	typedef typename L::vec vec;
+	const vec solid = L::set1(0x3ff);
+	const vec walls = L::set1(0x801);
+	const vec inner = L::set1(0x7ff);
+	const vec leftWall = L::set1(0x001);
+	const vec rightWall = L::set1(0x200);
+	const vec top = L::load(tops);
+	vec covered = L::zero(), above = L::zero();
+	vec holes = L::zero(), rowTransitions = L::zero();
+	vec columnTransitions = L::zero(), wells = L::zero();
+	vec planes[numPlanes];
+	for(int i = 0; i < numPlanes; ++ i) planes[i] = L::zero();
+	for(int y = numRows - 1; y >= 0; -- y) {
+		vec row = L::load(rows + y * L::width);
+
+		// Row transitions are counted with the walls added
+		// as the bit 0 and bit 11, only for the rows below
+		// the top of each field.
+		vec walled = L::bitOr(L::template shl<1>(row), walls);
+		vec changed = L::bitAnd(L::bitXor(walled,
+			L::template shr<1>(walled)), inner);
+		vec active = L::greater(top, L::set1(uint16_t(y)));
+		rowTransitions = L::add(rowTransitions,
+			L::bitAnd(popcount16<L>(changed), active));
+		columnTransitions = L::add(columnTransitions,
+			popcount16<L>(L::bitXor(row, above)));
+
+		// The well cells are counted by bit sliced depth
+		// counters of each column, which are increased at the
+		// well cells and reset elsewhere.
+		vec neighbours = L::bitAnd(
+			L::bitOr(L::template shl<1>(row), leftWall),
+			L::bitOr(L::template shr<1>(row), rightWall));
+		vec well = L::andNot(L::bitOr(row, covered),
+			L::bitAnd(neighbours, solid));
+		vec carry = well;
+		for(int i = 0; i < numPlanes; ++ i) {
+			vec next = L::bitAnd(planes[i], carry);
+			planes[i] = L::bitAnd(L::bitXor(planes[i], carry), well);
+			carry = next;
+		}
+		for(int i = 0; i < numPlanes; ++ i) {
+			vec count = popcount16<L>(planes[i]);
+			for(int j = 0; j < i; ++ j) count = L::add(count, count);
+			wells = L::add(wells, count);
+		}
+
+		holes = L::add(holes, popcount16<L>(L::andNot(row, covered)));
+		covered = L::bitOr(covered, row);
+		above = row;
+	}
+	columnTransitions = L::add(columnTransitions,
+		popcount16<L>(L::bitXor(above, solid)));
+	L::store(holesOut, holes);
+	L::store(rowTransitionsOut, rowTransitions);
+	L::store(columnTransitionsOut, columnTransitions);
+	L::store(wellsOut, wells);
+}
+
+// extractWith evaluates the features of the fields in the
+// batches of the lane type.
+template<typename L>
+void extractWith(const hacktile::model::field* const fields[],
+	size_t numFields, fieldFeatures features[]) {
+	alignas(32) uint16_t rows[maxRows * L::width];
+	alignas(32) uint16_t tops[L::width];
+	alignas(32) uint16_t holes[L::width], rowTransitions[L::width];
+	alignas(32) uint16_t columnTransitions[L::width], wells[L::width];
+	for(size_t base = 0; base < numFields; base += L::width) {
+		size_t numLanes = numFields - base;
+		if(numLanes > L::width) numLanes = L::width;
+
+		// Evaluate the skyline features and transpose the
+		// rows of the fields below the highest top.
+		int numRows = 0;
+		for(size_t i = 0; i < L::width; ++ i) {
+			tops[i] = 0;
+			if(i >= numLanes) continue;
+			const hacktile::model::field& f = *fields[base + i];
+			fieldFeatures& result = features[base + i];
+			result.aggregateHeight = 0;
+			result.maxHeight = 0;
+			result.bumpiness = 0;
+			for(int x = 0; x < 10; ++ x) {
+				int height = f.columnHeight(x);
+				result.aggregateHeight += height;
+				result.maxHeight = std::max(result.maxHeight, height);
+				if(x > 0) {
+					int diff = height - f.columnHeight(x - 1);
+					result.bumpiness += diff < 0? -diff : diff;
+				}
+			}
+			tops[i] = uint16_t(result.maxHeight);
+			numRows = std::max(numRows, result.maxHeight);
+		}
+		for(size_t i = 0; i < L::width; ++ i) {
+			if(i >= numLanes) {
+				for(int y = 0; y < numRows; ++ y)
+					rows[y * L::width + i] = 0;
+				continue;
+			}
+			const hacktile::model::field& f = *fields[base + i];
+			for(int y = 0; y < numRows; y += 6) {
+				uint64_t window = f.compactWindowAt(y).getValue();
+				int n = std::min(6, numRows - y);
+				for(int k = 0; k < n; ++ k)
+					rows[(y + k) * L::width + i] =
+						uint16_t((window >> (10 * k)) & 0x3ff);
+			}
+		}
+
+		// Evaluate the row features of all fields at once.
+		extractBatch<L>(rows, tops, numRows, holes,
+			rowTransitions, columnTransitions, wells);
+		for(size_t i = 0; i < numLanes; ++ i) {
+			fieldFeatures& result = features[base + i];
+			result.holes = holes[i];
+			result.rowTransitions = rowTransitions[i];
+			result.columnTransitions = columnTransitions[i];
+			result.wells = wells[i];
+		}
+	}
+}
+
+} // namespace hacktile::simulation::kernel
+} // namespace hacktile::simulation
+} // namespace hacktile
@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file features.cpp
+ * @author aegistudio
+ * @brief Implementation of the feature extraction.
+ *
+ * This file instantiates the scalar and SSE2 backends of the
+ * feature extraction kernel, and dispatches to the widest
+ * backend supported by the processor. The AVX2 backend is
+ * instantiated in a separate source.
+ */
+#include "simulation/features.hpp"
+#include "simulation/src/featurekernel.hpp"
+#include <stdexcept>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+using namespace hacktile::model;
+
+namespace hacktile {
+namespace simulation {
+
+#ifdef HACKTILE_FEATURES_AVX2
+// extractFeaturesAVX2 is defined in features_avx2.cpp.
+void extractFeaturesAVX2(const field* const fields[],
+	size_t numFields, fieldFeatures features[]);
+#endif
+
+namespace {
+
+#ifdef __SSE2__
+// sse2Lanes is the lane type with 8 lanes of SSE2.
+struct sse2Lanes {
+	typedef __m128i vec;
+	static constexpr size_t width = 8;
+	static vec load(const uint16_t* p) {
+		return _mm_load_si128(reinterpret_cast<const __m128i*>(p));
+	}
+	static void store(uint16_t* p, vec v) {
+		_mm_store_si128(reinterpret_cast<__m128i*>(p), v);
+	}
+	static vec set1(uint16_t v) { return _mm_set1_epi16(short(v)); }
+	static vec zero() { return _mm_setzero_si128(); }
+	static vec bitAnd(vec a, vec b) { return _mm_and_si128(a, b); }
+	static vec bitOr(vec a, vec b) { return _mm_or_si128(a, b); }
+	static vec bitXor(vec a, vec b) { return _mm_xor_si128(a, b); }
+	static vec andNot(vec a, vec b) { return _mm_andnot_si128(a, b); }
+	static vec add(vec a, vec b) { return _mm_add_epi16(a, b); }
+	static vec sub(vec a, vec b) { return _mm_sub_epi16(a, b); }
+	template<int n> static vec shl(vec a) { return _mm_slli_epi16(a, n); }
+	template<int n> static vec shr(vec a) { return _mm_srli_epi16(a, n); }
+	static vec greater(vec a, vec b) { return _mm_cmpgt_epi16(a, b); }
+};
+#endif
+
+} // anonymous namespace
+
+bool isFeatureBackendSupported(featureBackend backend) {
+	switch(backend) {
+	case featureBackend::scalar:
+		return true;
+#ifdef __SSE2__
+	case featureBackend::sse2:
+		return true;
+#endif
+#ifdef HACKTILE_FEATURES_AVX2
+	case featureBackend::avx2:
+		return __builtin_cpu_supports("avx2");
+#endif
+	default:
+		return false;
+	}
+}
+
+featureBackend bestFeatureBackend() {
+	static const featureBackend best = [] {
+		if(isFeatureBackendSupported(featureBackend::avx2))
+			return featureBackend::avx2;
+		if(isFeatureBackendSupported(featureBackend::sse2))
+			return featureBackend::sse2;
+		return featureBackend::scalar;
+	}();
+	return best;
+}
+
+void extractFeatures(const field* const fields[],
+	size_t numFields, fieldFeatures features[]) {
+	extractFeatures(fields, numFields, features, bestFeatureBackend());
+}
+
+void extractFeatures(const field* const fields[], size_t numFields,
+	fieldFeatures features[], featureBackend backend) {
+	switch(backend) {
+	case featureBackend::scalar:
+		kernel::extractWith<kernel::scalarLanes>(
+			fields, numFields, features);
+		return;
+#ifdef __SSE2__
+	case featureBackend::sse2:
+		kernel::extractWith<sse2Lanes>(fields, numFields, features);
+		return;
+#endif
+#ifdef HACKTILE_FEATURES_AVX2
+	case featureBackend::avx2:
+		extractFeaturesAVX2(fields, numFields, features);
+		return;
+#endif
+	default:
+		throw std::runtime_error("feature backend not supported");
+	}
+}
+
+} // namespace hacktile::simulation
+} // namespace hacktile
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file features_avx2.cpp
+ * @author aegistudio
+ * @brief AVX2 backend of the feature extraction.
+ *
+ * This file instantiates the feature extraction kernel with
+ * 16 lanes of AVX2. Instead of compiling the whole source
+ * with AVX2, only the kernel is compiled with AVX2 enabled,
+ * so that the inline functions of other headers instantiated
+ * here will never contain AVX2 instructions. The backend
+ * must only be called after checking the processor.
+ */
+#include "simulation/features.hpp"
+#include "model/tile.hpp"
+#include <algorithm>
+#include <immintrin.h>
+using namespace hacktile::model;
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), \
+	apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+#include "simulation/src/featurekernel.hpp"
+
+namespace hacktile {
+namespace simulation {
+
+namespace {
+
+// avx2Lanes is the lane type with 16 lanes of AVX2.
+struct avx2Lanes {
+	typedef __m256i vec;
+	static constexpr size_t width = 16;
+	static vec load(const uint16_t* p) {
+		return _mm256_load_si256(reinterpret_cast<const __m256i*>(p));
+	}
+	static void store(uint16_t* p, vec v) {
+		_mm256_store_si256(reinterpret_cast<__m256i*>(p), v);
+	}
+	static vec set1(uint16_t v) { return _mm256_set1_epi16(short(v)); }
+	static vec zero() { return _mm256_setzero_si256(); }
+	static vec bitAnd(vec a, vec b) { return _mm256_and_si256(a, b); }
+	static vec bitOr(vec a, vec b) { return _mm256_or_si256(a, b); }
+	static vec bitXor(vec a, vec b) { return _mm256_xor_si256(a, b); }
+	static vec andNot(vec a, vec b) { return _mm256_andnot_si256(a, b); }
+	static vec add(vec a, vec b) { return _mm256_add_epi16(a, b); }
+	static vec sub(vec a, vec b) { return _mm256_sub_epi16(a, b); }
+	template<int n> static vec shl(vec a) { return _mm256_slli_epi16(a, n); }
+	template<int n> static vec shr(vec a) { return _mm256_srli_epi16(a, n); }
+	static vec greater(vec a, vec b) { return _mm256_cmpgt_epi16(a, b); }
+};
+
+} // anonymous namespace
+
+void extractFeaturesAVX2(const field* const fields[],
+	size_t numFields, fieldFeatures features[]) {
+	kernel::extractWith<avx2Lanes>(fields, numFields, features);
+}
+
+} // namespace hacktile::simulation
+} // namespace hacktile
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file main.cpp
+ * @author aegistudio
+ * @brief Entrypoint for the hacktile simulation mode.
+ *
+ * This file is the entrypoint for hacktile-sim, which will
+ * simulate the games headlessly with the bot specified in
+ * command line, and report the aggregated stats.
+ */
+#include "simulation/simulator.hpp"
+#include "simulation/controller.hpp"
+#include "simulation/farm.hpp"
+#include "simulation/beam.hpp"
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+using namespace hacktile::simulation;
+
+static void usage(const char* program) {
+	std::cerr << "Usage: " << program << " [options]\n"
+		"  -n <games>      number of games to simulate\n"
+		"  -s <seed>       seed of the first game\n"
+		"  -p <pieces>     pieces to lock before completion\n"
+		"  -r <previews>   number of previews\n"
+		"  -g <generator>  permutator or history\n"
+		"  -R <randomizer> mt19937 or xoshiro\n"
+		"  -b <tiles>      tiles generated in a batch, 0 to disable\n"
+		"  -c <controller> greedy, beam or drop\n"
+		"  -j <threads>    number of worker threads\n"
+		"  -w <width>      beam width of the beam search\n"
+		"  -d <depth>      tiles to look ahead in beam search\n"
+		"  -t <millis>     time budget of each beam search move\n"
+		"  -k              peek beyond previews in beam search\n";
+}
+
+int main(int argc, char** argv) {
+	// Parse the simulation config from the command line.
+	simulationConfig config;
+	std::string controllerName = "greedy";
+	unsigned numWorkers = 0;
+	bool lookaheadSpecified = false;
+	beamConfig beam;
+	int opt;
+	while((opt = getopt(argc, argv, "n:s:p:r:g:R:b:c:j:w:d:t:kh")) != -1) {
+		switch(opt) {
+		case 'n': config.numGames = strtoull(optarg, nullptr, 0); break;
+		case 's': config.seed = strtoull(optarg, nullptr, 0); break;
+		case 'p': config.maxPieces = strtoull(optarg, nullptr, 0); break;
+		case 'r': config.numPreviews = atoi(optarg); break;
+		case 'g':
+			if(strcmp(optarg, "permutator") == 0)
+				config.generator = generatorType::permutator;
+			else if(strcmp(optarg, "history") == 0)
+				config.generator = generatorType::historyRoll;
+			else {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'R':
+			if(strcmp(optarg, "mt19937") == 0)
+				config.randomizer = randomizerType::mt19937;
+			else if(strcmp(optarg, "xoshiro") == 0)
+				config.randomizer = randomizerType::xoshiro256;
+			else {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'b':
+			config.lookahead = strtoull(optarg, nullptr, 0);
+			lookaheadSpecified = true;
+			break;
+		case 'c': controllerName = optarg; break;
+		case 'j': numWorkers = strtoul(optarg, nullptr, 0); break;
+		case 'w': beam.beamWidth = strtoul(optarg, nullptr, 0); break;
+		case 'd': beam.maxDepth = atoi(optarg); break;
+		case 't': beam.timeBudget = atof(optarg) / 1000; break;
+		case 'k': beam.peekBeyondPreviews = true; break;
+		default:
+			usage(argv[0]);
+			return opt == 'h'? 0 : 1;
+		}
+	}
+	if(config.numPreviews <= 0) {
+		usage(argv[0]);
+		return 1;
+	}
+	if(!lookaheadSpecified)
+		config.lookahead = size_t(config.numPreviews) + lookaheadMargin;
+
+	// Create the controller factory of the workers.
+	gameFarm::controllerFactory factory;
+	if(controllerName == "greedy")
+		factory = [] {
+			return std::unique_ptr<controller>(new greedyController());
+		};
+	else if(controllerName == "beam")
+		factory = [beam] {
+			return std::unique_ptr<controller>(new beamController(beam));
+		};
+	else if(controllerName == "drop")
+		factory = [] {
+			return std::unique_ptr<controller>(new scriptedController({}));
+		};
+	else {
+		usage(argv[0]);
+		return 1;
+	}
+
+	// Run the simulation and report the stats.
+	simulator sim(config);
+	gameFarm farm(sim, factory, numWorkers);
+	simulationStats stats = farm.run();
+	std::cout << "workers: " << farm.getNumWorkers() << "\n"
+		<< "games:   " << stats.numGames << "\n"
+		<< "pieces:  " << stats.numPieces << " ("
+			<< stats.piecesPerSecond() << " pieces/s)\n"
+		<< "lines:   " << stats.numLines << " ("
+			<< (stats.numGames > 0? double(stats.numLines)
+				/ stats.numGames : 0) << " lines/game)\n"
+		<< "top out: " << stats.numTopOuts << " ("
+			<< stats.topOutRate() * 100 << "%)\n"
+		<< "elapsed: " << stats.seconds << "s\n";
+	return 0;
+}
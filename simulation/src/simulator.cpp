@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file simulator.cpp
+ * @author aegistudio
+ * @brief Implementation of the headless simulator.
+ *
+ * This file implements the simulator, which creates the
+ * playground and the generator of each game, and subscribes
+ * to the playground for collecting the stats.
+ */
+#include "simulation/simulator.hpp"
+#include "model/tetromino.hpp"
+#include "model/lookahead.hpp"
+#include <chrono>
+using namespace hacktile::model;
+
+namespace hacktile {
+namespace simulation {
+
+std::unique_ptr<tileGenerator>
+tetrominoGenerator(generatorType type, uint64_t seed,
+	randomizerType randomizer) {
+	const tile* const* tilePointers = tetrominoTiles();
+	bool fast = randomizer == randomizerType::xoshiro256;
+	switch(type) {
+	case generatorType::historyRoll: {
+		// The initial history is Z S Z S, so that the game
+		// will never begin with an S, Z or O tile.
+		size_t history[4] = {
+			size_t(tetromino::Z) - 1, size_t(tetromino::S) - 1,
+			size_t(tetromino::Z) - 1, size_t(tetromino::S) - 1,
+		};
+		if(fast) return std::unique_ptr<tileGenerator>(
+			new fastHistoryRoll(tilePointers, 7, 4, history, 4, seed));
+		return std::unique_ptr<tileGenerator>(new historyRoll(
+			tilePointers, 7, 4, history, 4, seed));
+	}
+	default:
+		if(fast) return std::unique_ptr<tileGenerator>(
+			new fastTilePermutator(tilePointers, 7, seed));
+		return std::unique_ptr<tileGenerator>(new tilePermutator(
+			tilePointers, 7, seed));
+	}
+}
+
+simulator::simulator(const simulationConfig& config): config(config) {}
+
+std::unique_ptr<tileGenerator>
+simulator::createGenerator(uint64_t seed) const {
+	return tetrominoGenerator(config.generator, seed, config.randomizer);
+}
+
+namespace {
+
+// statsListener collects the stats of a single game.
+struct statsListener : public playgroundListener {
+	simulationStats& stats;
+	uint64_t numPieces;
+
+	statsListener(simulationStats& stats):
+		stats(stats), numPieces(0) {}
+
+	virtual void tileLock(const tileLockEvent& event) override {
+		++ numPieces;
+		++ stats.numPieces;
+		stats.numLines += event.clear;
+	}
+
+	virtual void gameEnd(const gameEndEvent& event) override {
+		++ stats.numGames;
+		if(event.endState == playgroundState::topOut)
+			++ stats.numTopOuts;
+	}
+};
+
+} // anonymous namespace
+
+void simulator::runGame(controller& ctrl,
+	uint64_t seed, simulationStats& stats) const {
+	// The tiles are generated through the lookahead, which
+	// generates the same tiles in batches.
+	std::unique_ptr<tileGenerator> source = createGenerator(seed);
+	std::unique_ptr<tileLookahead> lookahead;
+	tileGenerator* generator = source.get();
+	if(config.lookahead > 0) {
+		lookahead.reset(new tileLookahead(source.get(), config.lookahead));
+		generator = lookahead.get();
+	}
+	playground play(generator, config.numPreviews);
+	statsListener listener(stats);
+	auto subscription = play.subscribe(&listener);
+
+	// Play the game until it ends or enough tiles has been
+	// locked, which will be considered completed.
+	ctrl.reset(seed);
+	play.start();
+	while(play.isInGame() && listener.numPieces < config.maxPieces)
+		if(!ctrl.control(play)) break;
+	play.complete();
+}
+
+simulationStats simulator::run(controller& ctrl) const {
+	simulationStats stats;
+	auto start = std::chrono::steady_clock::now();
+	for(uint64_t i = 0; i < config.numGames; ++ i)
+		runGame(ctrl, config.seed + i, stats);
+	std::chrono::duration<double> elapsed =
+		std::chrono::steady_clock::now() - start;
+	stats.seconds = elapsed.count();
+	return stats;
+}
+
+} // namespace hacktile::simulation
+} // namespace hacktile
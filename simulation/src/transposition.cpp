@@ -0,0 +1,32 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file transposition.cpp
+ * @author aegistudio
+ * @brief Implementation of the transposition table.
+ *
+ * This file implements the allocation and clearing of the
+ * transposition table. The empty entry at each index holds
+ * the key of the next index with the lowest bit flipped,
+ * which is stored at another index and will never match.
+ */
+#include "simulation/transposition.hpp"
+#include <algorithm>
+
+namespace hacktile {
+namespace simulation {
+
+transpositionTable::transpositionTable(int numBits):
+	entries(new entry[size_t(1) << std::max(numBits, 1)]),
+	mask((uint64_t(1) << std::max(numBits, 1)) - 1) {
+	clear();
+}
+
+void transpositionTable::clear() {
+	for(uint64_t i = 0; i <= mask; ++ i) {
+		entries[i].check.store(i ^ 1, std::memory_order_relaxed);
+		entries[i].data.store(0, std::memory_order_relaxed);
+	}
+}
+
+} // namespace hacktile::simulation
+} // namespace hacktile
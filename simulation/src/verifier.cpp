@@ -0,0 +1,209 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file verifier.cpp
+ * @author aegistudio
+ * @brief Implementation of the replay verifier.
+ *
+ * This file implements the replay verifier, which tracks
+ * the tiles generated and swapped in the same way as the
+ * playground, so that the tile of every placement could be
+ * checked without running the playground and its events.
+ */
+#include "simulation/verifier.hpp"
+#include "simulation/simulator.hpp"
+#include "model/tetromino.hpp"
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+using namespace hacktile::model;
+
+namespace hacktile {
+namespace simulation {
+
+const char* verdictName(replayVerdict verdict) {
+	switch(verdict) {
+	case replayVerdict::valid:       return "valid";
+	case replayVerdict::unreadable:  return "unreadable";
+	case replayVerdict::truncated:   return "truncated";
+	case replayVerdict::unsupported: return "unsupported";
+	case replayVerdict::wrongTile:   return "wrong tile";
+	case replayVerdict::unreachable: return "unreachable";
+	case replayVerdict::toppedOut:   return "topped out";
+	}
+	return "unknown";
+}
+
+replayVerifier::replayVerifier(): finder(new placementFinder) {}
+
+// replayedGenerator creates the generator of the replay, or
+// returns nullptr if it is not a generator of the simulator.
+static std::unique_ptr<tileGenerator>
+replayedGenerator(const replayHeader& header) {
+	randomizerType randomizer;
+	switch(header.randomizer) {
+	case replayRandomizer::mt19937:
+		randomizer = randomizerType::mt19937;
+		break;
+	case replayRandomizer::xoshiro256:
+		randomizer = randomizerType::xoshiro256;
+		break;
+	default:
+		return nullptr;
+	}
+
+	// The history roll of the simulator always begins with
+	// the history of Z S Z S.
+	if(header.generator == replayGenerator::permutator &&
+		header.history == replayHistory::none)
+		return tetrominoGenerator(generatorType::permutator,
+			header.seed, randomizer);
+	if(header.generator == replayGenerator::historyRoll &&
+		header.history == replayHistory::zszs)
+		return tetrominoGenerator(generatorType::historyRoll,
+			header.seed, randomizer);
+	return nullptr;
+}
+
+replayVerifier::~replayVerifier() {}
+
+// canSpawn judges whether the tile could be spawned.
+static bool canSpawn(const field& f, const tile* typ) {
+	if(typ == nullptr) return false;
+	tilePathFinder pfd(typ);
+	return f.spawn(pfd);
+}
+
+// isSameState judges whether the states are the same.
+static bool isSameState(const tileState& a, const tileState& b) {
+	return a.dir.getValue() == b.dir.getValue() &&
+		a.x == b.x && a.y == b.y;
+}
+
+bool replayVerifier::isReachable(const field& f,
+	const tile& typ, const tileState& target) {
+	tilePathFinder spawned(&typ);
+	if(!f.spawn(spawned)) return false;
+
+	// Rotate, shift and then drop the tile to the ground,
+	// which is exactly the placement for most tiles.
+	tilePathFinder pfd = spawned, next;
+	bool direct = true;
+	if(pfd.getState().dir.getValue() != target.dir.getValue()) {
+		direct = f.rotate(pfd, target.dir, next);
+		if(direct) pfd = next;
+	}
+	int8_t dx = int8_t(target.x - pfd.getState().x);
+	if(direct && dx != 0) {
+		direct = f.move(pfd, dx, next) &&
+			next.getState().x == target.x;
+		if(direct) pfd = next;
+	}
+	if(direct) {
+		while(f.drop(pfd, 20, next)) pfd = next;
+		if(isSameState(pfd.getState(), target)) return true;
+	}
+
+	// Search every placement otherwise, which is much more
+	// expensive but finds the tucks and spins.
+	finder->search(f, spawned);
+	return finder->isPlaced(target);
+}
+
+replayResult replayVerifier::verify(
+	const replayHeader& header, replayCursor cursor) {
+	replayResult result;
+	if(header.numTiles != 7) return result;
+	std::unique_ptr<tileGenerator> generator = replayedGenerator(header);
+	if(generator == nullptr) {
+		result.verdict = replayVerdict::unsupported;
+		return result;
+	}
+
+	field f;
+	const tile* current = generator->generate();
+	const tile* swap = nullptr;
+	replayPlacement placement;
+	while(cursor.next(placement)) {
+		const tile& typ = tetrominoTile(tetromino(placement.type + 1));
+		if(!canSpawn(f, current)) {
+			result.verdict = replayVerdict::toppedOut;
+			return result;
+		}
+
+		// Swapping with an empty swap brings the next tile,
+		// and swapping again before locking brings the first
+		// tile back, which the tile of placement tells.
+		if(placement.swapped) {
+			if(swap == nullptr) {
+				swap = current;
+				current = generator->generate();
+				if(current != &typ && swap == &typ) {
+					if(!canSpawn(f, current)) {
+						result.verdict = replayVerdict::toppedOut;
+						return result;
+					}
+					std::swap(swap, current);
+				}
+			} else std::swap(swap, current);
+			if(!canSpawn(f, current)) {
+				result.verdict = replayVerdict::toppedOut;
+				return result;
+			}
+		}
+		if(current != &typ) {
+			result.verdict = replayVerdict::wrongTile;
+			return result;
+		}
+
+		uint8_t clear = 0;
+		if(!isReachable(f, typ, stateOf(f, typ, placement)) ||
+			!replayLock(f, typ, placement, clear)) {
+			result.verdict = replayVerdict::unreachable;
+			return result;
+		}
+		++ result.numPieces;
+		result.numLines += clear;
+		result.fieldHash = f.getHash();
+		current = generator->generate();
+	}
+	result.verdict = cursor.isEnded()?
+		replayVerdict::valid : replayVerdict::truncated;
+	return result;
+}
+
+replayResult replayVerifier::verify(const char* path) {
+	try {
+		replayReader reader(path);
+		return verify(reader.getHeader(), reader.placements());
+	} catch(const std::runtime_error&) {
+		return replayResult();
+	}
+}
+
+std::vector<replayResult> verifyReplays(
+	const std::vector<std::string>& paths, unsigned numWorkers) {
+	if(numWorkers == 0) numWorkers = std::thread::hardware_concurrency();
+	if(numWorkers == 0) numWorkers = 1;
+	if(numWorkers > paths.size()) numWorkers = unsigned(paths.size());
+
+	// Each worker takes the next file to verify, and writes
+	// the result to the slot of the file.
+	std::vector<replayResult> results(paths.size());
+	std::atomic<size_t> next(0);
+	auto worker = [&] {
+		replayVerifier verifier;
+		size_t i;
+		while((i = next.fetch_add(1)) < paths.size())
+			results[i] = verifier.verify(paths[i].c_str());
+	};
+	std::vector<std::thread> threads;
+	for(unsigned i = 1; i < numWorkers; ++ i)
+		threads.emplace_back(worker);
+	if(numWorkers > 0) worker();
+	for(auto& thread : threads) thread.join();
+	return results;
+}
+
+} // namespace hacktile::simulation
+} // namespace hacktile
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file verify.cpp
+ * @author aegistudio
+ * @brief Entrypoint for the hacktile replay verification.
+ *
+ * This file is the entrypoint for hacktile-verify, which will
+ * verify the replay files specified in command line, report
+ * the replays failing the verification, and exit with failure
+ * if there's any of them.
+ */
+#include "simulation/verifier.hpp"
+#include <unistd.h>
+#include <cstdlib>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace hacktile::simulation;
+
+static void usage(const char* program) {
+	std::cerr << "Usage: " << program << " [options] <replay>...\n"
+		"  -j <threads>    number of worker threads\n"
+		"  -v              report the valid replays as well\n";
+}
+
+int main(int argc, char** argv) {
+	unsigned numWorkers = 0;
+	bool verbose = false;
+	int opt;
+	while((opt = getopt(argc, argv, "j:vh")) != -1) {
+		switch(opt) {
+		case 'j': numWorkers = strtoul(optarg, nullptr, 0); break;
+		case 'v': verbose = true; break;
+		default:
+			usage(argv[0]);
+			return opt == 'h'? 0 : 1;
+		}
+	}
+	if(optind >= argc) {
+		usage(argv[0]);
+		return 1;
+	}
+	std::vector<std::string> paths(argv + optind, argv + argc);
+
+	// Verify the replays and report the results.
+	auto start = std::chrono::steady_clock::now();
+	std::vector<replayResult> results = verifyReplays(paths, numWorkers);
+	std::chrono::duration<double> elapsed =
+		std::chrono::steady_clock::now() - start;
+	size_t numInvalid = 0;
+	uint64_t numPieces = 0;
+	for(size_t i = 0; i < results.size(); ++ i) {
+		const replayResult& result = results[i];
+		numPieces += result.numPieces;
+		bool valid = result.verdict == replayVerdict::valid;
+		if(!valid) ++ numInvalid;
+		if(valid && !verbose) continue;
+		std::cout << paths[i] << ": " << verdictName(result.verdict)
+			<< " after " << result.numPieces << " pieces, "
+			<< result.numLines << " lines, field "
+			<< std::hex << result.fieldHash << std::dec << "\n";
+	}
+	std::cout << "replays: " << results.size() << " ("
+			<< numInvalid << " invalid)\n"
+		<< "pieces:  " << numPieces << "\n"
+		<< "elapsed: " << elapsed.count() << "s\n";
+	return numInvalid > 0? 1 : 0;
+}
@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <gtest/gtest.h>
+#include "simulation/simulator.hpp"
+#include "simulation/beam.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+using namespace hacktile::simulation;
+using namespace hacktile::model;
+
+// Beam.Survive runs the games with the beam search, which
+// must be deterministic and survive the short games.
+TEST(Beam, Survive) {
+	simulationConfig config;
+	config.numGames = 2;
+	config.maxPieces = 150;
+	config.generator = generatorType::historyRoll;
+	simulator sim(config);
+	beamConfig beam;
+	beam.beamWidth = 8;
+	beam.maxDepth = 3;
+	beamController ctrl(beam);
+	simulationStats first = sim.run(ctrl);
+	simulationStats second = sim.run(ctrl);
+	ASSERT_EQ(first.numTopOuts, 0);
+	ASSERT_EQ(first.numPieces, 2 * 150);
+	ASSERT_EQ(first.numLines, second.numLines);
+	ASSERT_GT(first.numLines, 2 * 50);
+}
+
+// Beam.TimeBudget checks whether the beam width is tuned
+// down when the time budget cannot be met.
+TEST(Beam, TimeBudget) {
+	simulationConfig config;
+	config.numGames = 1;
+	config.maxPieces = 20;
+	simulator sim(config);
+	beamConfig beam;
+	beam.beamWidth = 64;
+	beam.minBeamWidth = 2;
+	beam.timeBudget = 1e-9;
+	beamController ctrl(beam);
+	sim.run(ctrl);
+	ASSERT_EQ(ctrl.getBeamWidth(), 2);
+}
+
+// countingEvaluator counts the number of evaluations.
+struct countingEvaluator : public fieldEvaluator {
+	size_t& numEvaluations;
+	linearEvaluator linear;
+
+	countingEvaluator(size_t& numEvaluations):
+		numEvaluations(numEvaluations) {}
+
+	virtual double evaluate(const field& f) const override {
+		++ numEvaluations;
+		return linear.evaluate(f);
+	}
+
+	virtual double reward(int lines) const override {
+		return linear.reward(lines);
+	}
+};
+
+// Beam.Transposition checks whether the transposition table
+// reduces the evaluations without changing the moves.
+TEST(Beam, Transposition) {
+	simulationConfig config;
+	config.numGames = 1;
+	config.maxPieces = 40;
+	simulator sim(config);
+	beamConfig beam;
+	beam.beamWidth = 8;
+	beam.maxDepth = 5;
+
+	size_t uncached = 0, cached = 0;
+	beam.tableBits = 0;
+	beamController first(beam, std::unique_ptr<fieldEvaluator>(
+		new countingEvaluator(uncached)));
+	simulationStats firstStats = sim.run(first);
+	beam.tableBits = 20;
+	beamController second(beam, std::unique_ptr<fieldEvaluator>(
+		new countingEvaluator(cached)));
+	simulationStats secondStats = sim.run(second);
+	ASSERT_EQ(firstStats.numLines, secondStats.numLines);
+	ASSERT_LT(cached * 3, uncached * 2);
+}
+
+// Beam.TableConcurrent stores and probes the table from
+// multiple threads, and no torn entry should be reported.
+TEST(Beam, TableConcurrent) {
+	transpositionTable table(4);
+	std::vector<std::thread> threads;
+	std::atomic<bool> mismatch(false);
+	for(int t = 0; t < 4; ++ t)
+		threads.emplace_back([&table, &mismatch, t] {
+			for(uint64_t i = 0; i < 100000; ++ i) {
+				uint64_t key = (i * 4 + t) * 0x9e3779b97f4a7c15;
+				table.store(key, double(key >> 11));
+				double score;
+				if(table.probe(key ^ 1, score)) continue;
+				uint64_t other = ((i + 1) * 4 + t) * 0x9e3779b97f4a7c15;
+				if(table.probe(other, score) && score != double(other >> 11))
+					mismatch = true;
+			}
+		});
+	for(auto& thread : threads) thread.join();
+	ASSERT_FALSE(mismatch);
+	double score;
+	table.store(42, 1.5);
+	ASSERT_TRUE(table.probe(42, score));
+	ASSERT_EQ(score, 1.5);
+	table.clear();
+	ASSERT_FALSE(table.probe(42, score));
+
+	// The empty entries match no key, including the keys
+	// of all zeros and all ones.
+	for(uint64_t key = 0; key < 16; ++ key) {
+		ASSERT_FALSE(table.probe(key, score));
+		ASSERT_FALSE(table.probe(~key, score));
+	}
+}
@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <gtest/gtest.h>
+#include "simulation/features.hpp"
+#include <random>
+#include <vector>
+using namespace hacktile::simulation;
+using namespace hacktile::model;
+
+// evaluateFeatures evaluates the features cell by cell.
+static fieldFeatures evaluateFeatures(const field& f) {
+	auto filled = [&f](int x, int y) {
+		if(x < 0 || x >= 10 || y < 0) return true;
+		return (f.compactRowAt(y) & (1<<x)) != 0;
+	};
+	fieldFeatures result = {};
+	int heights[10] = {};
+	for(int x = 0; x < 10; ++ x) {
+		for(int y = 0; y < field::maxHeight; ++ y)
+			if(filled(x, y)) heights[x] = y + 1;
+		result.aggregateHeight += heights[x];
+		result.maxHeight = std::max(result.maxHeight, heights[x]);
+		if(x > 0) result.bumpiness += std::abs(heights[x] - heights[x-1]);
+	}
+	for(int x = 0; x < 10; ++ x) {
+		bool covered = false;
+		int depth = 0;
+		for(int y = result.maxHeight - 1; y >= 0; -- y) {
+			bool cell = filled(x, y);
+			if(!cell && covered) ++ result.holes;
+			bool well = !cell && !covered &&
+				filled(x - 1, y) && filled(x + 1, y);
+			depth = well? depth + 1 : 0;
+			result.wells += depth;
+			covered = covered || cell;
+		}
+		for(int y = 0; y <= result.maxHeight; ++ y)
+			if(filled(x, y) != filled(x, y - 1))
+				++ result.columnTransitions;
+	}
+	for(int y = 0; y < result.maxHeight; ++ y)
+		for(int x = 0; x <= 10; ++ x)
+			if(filled(x, y) != filled(x - 1, y))
+				++ result.rowTransitions;
+	return result;
+}
+
+// Features.Backends compares the features extracted by every
+// supported backend with the cell by cell evaluation.
+TEST(Features, Backends) {
+	std::mt19937 random(0);
+	std::vector<field> fields(37);
+	for(size_t i = 0; i < fields.size(); ++ i) {
+		// The fields are made of random rows of various
+		// densities, and the first field is kept empty.
+		int numRows = i == 0? 0 : random() % field::maxHeight;
+		int density = random() % 8 + 1;
+		for(int y = 0; y < numRows; ++ y) {
+			fieldRow row = {};
+			for(int x = 0; x < 10; ++ x)
+				row[x] = int(random() % 9) < density? 1 : 0;
+			fields[i].grow(row);
+		}
+	}
+	std::vector<const field*> pointers;
+	for(const field& f : fields) pointers.push_back(&f);
+
+	const featureBackend backends[] = {
+		featureBackend::scalar, featureBackend::sse2,
+		featureBackend::avx2,
+	};
+	for(featureBackend backend : backends) {
+		if(!isFeatureBackendSupported(backend)) continue;
+		std::vector<fieldFeatures> features(fields.size());
+		extractFeatures(pointers.data(), pointers.size(),
+			features.data(), backend);
+		for(size_t i = 0; i < fields.size(); ++ i) {
+			fieldFeatures expected = evaluateFeatures(fields[i]);
+			const fieldFeatures& actual = features[i];
+			ASSERT_EQ(actual.aggregateHeight, expected.aggregateHeight);
+			ASSERT_EQ(actual.maxHeight, expected.maxHeight);
+			ASSERT_EQ(actual.bumpiness, expected.bumpiness);
+			ASSERT_EQ(actual.holes, expected.holes);
+			ASSERT_EQ(actual.rowTransitions, expected.rowTransitions);
+			ASSERT_EQ(actual.columnTransitions,
+				expected.columnTransitions);
+			ASSERT_EQ(actual.wells, expected.wells);
+		}
+	}
+	ASSERT_TRUE(isFeatureBackendSupported(bestFeatureBackend()));
+}
@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <gtest/gtest.h>
+#include "simulation/simulator.hpp"
+#include "simulation/controller.hpp"
+#include "simulation/farm.hpp"
+using namespace hacktile::simulation;
+using namespace hacktile::model;
+
+// Simulator.Deterministic runs the same games twice with the
+// greedy controller, and the stats must be the same.
+TEST(Simulator, Deterministic) {
+	simulationConfig config;
+	config.numGames = 4;
+	config.maxPieces = 200;
+	simulator sim(config);
+	greedyController ctrl;
+	simulationStats first = sim.run(ctrl);
+	simulationStats second = sim.run(ctrl);
+	ASSERT_EQ(first.numGames, 4);
+	ASSERT_EQ(first.numPieces, second.numPieces);
+	ASSERT_EQ(first.numLines, second.numLines);
+	ASSERT_EQ(first.numTopOuts, second.numTopOuts);
+
+	// The greedy controller must be able to survive for
+	// such a short game and clear some lines.
+	ASSERT_EQ(first.numTopOuts, 0);
+	ASSERT_EQ(first.numPieces, 4 * 200);
+	ASSERT_GT(first.numLines, 4 * 60);
+}
+
+// Simulator.TopOut drops every tile at the spawn location,
+// and every game must top out.
+TEST(Simulator, TopOut) {
+	simulationConfig config;
+	config.numGames = 4;
+	config.generator = generatorType::historyRoll;
+	simulator sim(config);
+	scriptedController ctrl({
+		{ tileInput::moveLeft },
+		{ tileInput::rotateCW, tileInput::moveRight },
+	});
+	simulationStats stats = sim.run(ctrl);
+	ASSERT_EQ(stats.numGames, 4);
+	ASSERT_EQ(stats.numTopOuts, 4);
+	ASSERT_EQ(stats.numLines, 0);
+}
+
+// Simulator.Farm runs the games in the game farm, and the
+// stats must be the same as running them one by one.
+TEST(Simulator, Farm) {
+	simulationConfig config;
+	config.numGames = 13;
+	config.maxPieces = 100;
+	simulator sim(config);
+	greedyController ctrl;
+	simulationStats sequential = sim.run(ctrl);
+	gameFarm farm(sim, [] {
+		return std::unique_ptr<controller>(new greedyController());
+	}, 4);
+	simulationStats parallel = farm.run();
+	ASSERT_EQ(parallel.numGames, sequential.numGames);
+	ASSERT_EQ(parallel.numPieces, sequential.numPieces);
+	ASSERT_EQ(parallel.numLines, sequential.numLines);
+	ASSERT_EQ(parallel.numTopOuts, sequential.numTopOuts);
+}
+
+// Simulator.Lookahead runs the games with the tiles generated
+// in batches, which must be the same games as generating the
+// tiles one at a time.
+TEST(Simulator, Lookahead) {
+	simulationConfig config;
+	config.numGames = 4;
+	config.maxPieces = 100;
+	config.generator = generatorType::historyRoll;
+	config.lookahead = 0;
+	greedyController ctrl;
+	simulationStats single = simulator(config).run(ctrl);
+	config.lookahead = 64;
+	simulationStats batched = simulator(config).run(ctrl);
+	ASSERT_EQ(batched.numPieces, single.numPieces);
+	ASSERT_EQ(batched.numLines, single.numLines);
+	ASSERT_EQ(batched.numTopOuts, single.numTopOuts);
+}
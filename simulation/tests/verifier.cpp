@@ -0,0 +1,180 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <gtest/gtest.h>
+#include "simulation/verifier.hpp"
+#include "simulation/simulator.hpp"
+#include "simulation/controller.hpp"
+#include "model/tetromino.hpp"
+#include "model/replay.hpp"
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+using namespace hacktile::simulation;
+using namespace hacktile::model;
+
+// replayDirectory is the temporary directory of the replays,
+// which is removed with the replays on destruction.
+struct replayDirectory {
+	std::string path;
+	std::vector<std::string> files;
+
+	replayDirectory() {
+		char name[] = "/tmp/hacktileVerifyXXXXXX";
+		path = ::mkdtemp(name);
+	}
+
+	~replayDirectory() {
+		for(const auto& file : files) ::unlink(file.c_str());
+		::rmdir(path.c_str());
+	}
+
+	// create creates the replay file and returns its fd.
+	int create() {
+		files.push_back(path + "/" + std::to_string(files.size()));
+		return ::open(files.back().c_str(),
+			O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	}
+};
+
+// recordedGame is the stats of the game recorded.
+struct recordedGame : public playgroundListener {
+	uint64_t numPieces, numLines;
+
+	recordedGame(): numPieces(0), numLines(0) {}
+
+	void tileLock(const tileLockEvent& event) override {
+		++ numPieces;
+		numLines += event.clear;
+	}
+};
+
+// recordGame plays the game with the greedy controller and
+// swaps randomly, and records the game into the file.
+static uint64_t recordGame(int fd, generatorType type, uint64_t seed,
+	uint64_t maxPieces, recordedGame& game,
+	randomizerType randomizer = randomizerType::mt19937) {
+	auto generator = tetrominoGenerator(type, seed, randomizer);
+	playground play(generator.get());
+	auto subscription = play.subscribe(&game);
+	replayHeader header;
+	bool roll = type == generatorType::historyRoll;
+	header.generator = roll?
+		replayGenerator::historyRoll : replayGenerator::permutator;
+	header.history = roll? replayHistory::zszs : replayHistory::none;
+	header.randomizer = randomizer == randomizerType::xoshiro256?
+		replayRandomizer::xoshiro256 : replayRandomizer::mt19937;
+	header.numTiles = 7;
+	header.numPreviews = uint8_t(play.getNumPreviews());
+	header.seed = seed;
+	replayRecorder recorder(play, fd, header, tetrominoTiles());
+
+	greedyController ctrl;
+	std::mt19937 rng(static_cast<uint32_t>(seed));
+	play.start();
+	while(play.isInGame() && game.numPieces < maxPieces) {
+		if(rng() % 4 == 0) play.swapTile();
+		if(!ctrl.control(play)) break;
+	}
+	recorder.finish();
+	::close(fd);
+	return play.getField().getHash();
+}
+
+// Verifier.RecordedGames verifies the games recorded, which
+// must be valid and end with the same field.
+TEST(Verifier, RecordedGames) {
+	replayDirectory dir;
+	std::vector<recordedGame> games(6);
+	std::vector<uint64_t> hashes;
+	for(size_t i = 0; i < games.size(); ++ i)
+		hashes.push_back(recordGame(dir.create(), i % 2 == 0?
+			generatorType::permutator : generatorType::historyRoll,
+			100 + i, 150, games[i], i < 4?
+			randomizerType::mt19937 : randomizerType::xoshiro256));
+
+	std::vector<replayResult> results = verifyReplays(dir.files, 3);
+	ASSERT_EQ(results.size(), games.size());
+	for(size_t i = 0; i < games.size(); ++ i) {
+		EXPECT_EQ(results[i].verdict, replayVerdict::valid);
+		EXPECT_EQ(results[i].numPieces, games[i].numPieces);
+		EXPECT_EQ(results[i].numLines, games[i].numLines);
+		EXPECT_EQ(results[i].fieldHash, hashes[i]);
+	}
+}
+
+// Verifier.Rejected verifies the replays tampered with.
+TEST(Verifier, Rejected) {
+	replayDirectory dir;
+	recordedGame game;
+	recordGame(dir.create(), generatorType::permutator, 7, 50, game);
+	replayVerifier verifier;
+	EXPECT_EQ(verifier.verify(dir.files[0].c_str()).verdict,
+		replayVerdict::valid);
+
+	// The replay with another seed has other tiles.
+	replayReader reader(dir.files[0].c_str());
+	replayHeader header = reader.getHeader();
+	header.seed = 8;
+	replayResult result = verifier.verify(header, reader.placements());
+	EXPECT_EQ(result.verdict, replayVerdict::wrongTile);
+	EXPECT_LT(result.numPieces, game.numPieces);
+
+	// The replay of another generator has other tiles, and
+	// the generators not simulated are unsupported.
+	header = reader.getHeader();
+	header.randomizer = replayRandomizer::xoshiro256;
+	result = verifier.verify(header, reader.placements());
+	EXPECT_EQ(result.verdict, replayVerdict::wrongTile);
+	header = reader.getHeader();
+	header.history = replayHistory::zszs;
+	result = verifier.verify(header, reader.placements());
+	EXPECT_EQ(result.verdict, replayVerdict::unsupported);
+	header.generator = replayGenerator::historyRoll;
+	header.history = replayHistory::none;
+	result = verifier.verify(header, reader.placements());
+	EXPECT_EQ(result.verdict, replayVerdict::unsupported);
+	header.history = replayHistory(7);
+	result = verifier.verify(header, reader.placements());
+	EXPECT_EQ(result.verdict, replayVerdict::unsupported);
+
+	// The replay cut in the middle is truncated.
+	ASSERT_EQ(::truncate(dir.files[0].c_str(),
+		replayHeader::size + 4), 0);
+	result = verifier.verify(dir.files[0].c_str());
+	EXPECT_EQ(result.verdict, replayVerdict::truncated);
+	EXPECT_GT(result.numPieces, 0);
+	ASSERT_EQ(::truncate(dir.files[0].c_str(), 10), 0);
+	result = verifier.verify(dir.files[0].c_str());
+	EXPECT_EQ(result.verdict, replayVerdict::unreadable);
+
+	// The tile tucked under the floor is unreachable, and
+	// the placement is encoded by hand.
+	std::vector<uint8_t> data(replayHeader::size + 3);
+	const char magic[] = "HTRP";
+	for(int i = 0; i < 4; ++ i) data[i] = uint8_t(magic[i]);
+	data[4] = replayHeader::currentVersion;
+	data[6] = 7;
+	const tile* first = tetrominoGenerator(
+		generatorType::permutator, 0)->generate();
+	uint32_t type = 0;
+	while(&tetrominoTile(tetromino(type + 1)) != first) ++ type;
+	uint32_t bits = type | (0 << 3) | (0 << 4) | ((3 + 6) << 6)
+		| (1 << 10) | (1 << 11) | (7 << 12);
+	for(int i = 0; i < 3; ++ i)
+		data[replayHeader::size + i] = uint8_t(bits >> (8 * i));
+	ASSERT_TRUE(replayReader::parseHeader(data.data(), data.size(), header));
+	result = verifier.verify(header, replayCursor(
+		header, data.data(), data.size()));
+	EXPECT_EQ(result.verdict, replayVerdict::unreachable);
+
+	// Dropping the tile onto the floor instead is valid.
+	bits = (bits & 0x3ff) | (7 << 11);
+	for(int i = 0; i < 3; ++ i)
+		data[replayHeader::size + i] = uint8_t(bits >> (8 * i));
+	result = verifier.verify(header, replayCursor(
+		header, data.data(), data.size()));
+	EXPECT_EQ(result.verdict, replayVerdict::valid);
+	EXPECT_EQ(result.numPieces, 1);
+}
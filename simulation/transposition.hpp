@@ -0,0 +1,72 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file transposition.hpp
+ * @brief lock-free transposition table of evaluations
+ * @author aegistudio
+ *
+ * This file provides the transposition table, which caches
+ * the evaluations of the fields by their hashes, so that
+ * the fields reached through different placement orders
+ * are evaluated only once in the search.
+ */
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+
+namespace hacktile {
+namespace simulation {
+
+/**
+ * @brief transpositionTable is a fixed size hash table from
+ * the 64-bit keys to the scores, which could be shared by
+ * the searches of multiple threads without locking.
+ *
+ * Each entry stores the score and the key exclusive-or the
+ * score, so that an entry torn by concurrent stores will
+ * fail the verification rather than reporting a wrong score.
+ * Colliding entries are always replaced by the newer one.
+ */
+class transpositionTable {
+	struct entry {
+		std::atomic<uint64_t> check, data;
+	};
+	std::unique_ptr<entry[]> entries;
+	uint64_t mask;
+public:
+	/// transpositionTable creates the table with 2^numBits
+	/// entries, and at least 2 entries, which are all empty
+	/// initially and match no key.
+	transpositionTable(int numBits);
+
+	/// getSize returns the number of entries in the table.
+	size_t getSize() const {
+		return size_t(mask + 1);
+	}
+
+	/// clear removes all entries in the table.
+	void clear();
+
+	/// probe looks up the score of the key.
+	bool probe(uint64_t key, double& score) const {
+		const entry& e = entries[key & mask];
+		uint64_t check = e.check.load(std::memory_order_relaxed);
+		uint64_t data = e.data.load(std::memory_order_relaxed);
+		if((check ^ data) != key) return false;
+		std::memcpy(&score, &data, sizeof(score));
+		return true;
+	}
+
+	/// store saves the score of the key.
+	void store(uint64_t key, double score) {
+		entry& e = entries[key & mask];
+		uint64_t data;
+		std::memcpy(&data, &score, sizeof(score));
+		e.data.store(data, std::memory_order_relaxed);
+		e.check.store(key ^ data, std::memory_order_relaxed);
+	}
+}; // class hacktile::simulation::transpositionTable
+
+} // namespace hacktile::simulation
+} // namespace hacktile
@@ -0,0 +1,125 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file verifier.hpp
+ * @brief verification of the recorded replays
+ * @author aegistudio
+ *
+ * This file provides the replay verifier, which replays the
+ * placements of the tetromino games against the field and
+ * the generator described by the replay header, and checks
+ * that every tile is the one generated and could have been
+ * moved to its placement from where it is spawned.
+ */
+#include "model/tile.hpp"
+#include "model/placement.hpp"
+#include "model/replay.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hacktile {
+namespace simulation {
+
+/**
+ * @brief replayVerdict is the result of the verification.
+ */
+enum class replayVerdict : uint8_t {
+	/// valid is the replay with every placement verified.
+	valid,
+
+	/// unreadable is the file that is not a replay, or a
+	/// replay of tiles other than the tetrominoes.
+	unreadable,
+
+	/// truncated is the replay without the end, whose
+	/// placements are verified so far.
+	truncated,
+
+	/// unsupported is the replay of a generator that the
+	/// verifier could not reproduce.
+	unsupported,
+
+	/// wrongTile is the placement of a tile other than the
+	/// current one, or the one brought in by swapping.
+	wrongTile,
+
+	/// unreachable is the placement that the tile could not
+	/// be moved to from where it is spawned.
+	unreachable,
+
+	/// toppedOut is the placement after the game has topped
+	/// out, since the tile could not be spawned.
+	toppedOut,
+};
+
+/// verdictName returns the name of the verdict.
+const char* verdictName(replayVerdict);
+
+/**
+ * @brief replayResult is the result of replay verification,
+ * with the stats of the placements verified.
+ */
+struct replayResult {
+	replayVerdict verdict;
+
+	/// numPieces and numLines are the tiles locked and the
+	/// lines cleared before the verification stops.
+	uint64_t numPieces, numLines;
+
+	/// fieldHash is the hash of the field after the last
+	/// placement verified, to compare with the final state
+	/// submitted with the replay.
+	uint64_t fieldHash;
+
+	replayResult(): verdict(replayVerdict::unreadable),
+		numPieces(0), numLines(0), fieldHash(0) {}
+};
+
+/**
+ * @brief replayVerifier verifies the replays one at a time.
+ *
+ * Every placement is first attempted by rotating, shifting
+ * and dropping the tile from where it is spawned, which is
+ * how most tiles are played. Only when it does not end up
+ * at the placement is the placement finder searched, which
+ * also finds the tucks and spins.
+ *
+ * The verifier holds the placement finder, and should be
+ * reused for the replays verified on the same thread.
+ */
+class replayVerifier {
+	std::unique_ptr<hacktile::model::placementFinder> finder;
+
+	// isReachable judges whether the tile could be moved to
+	// the state from where it is spawned in the field.
+	bool isReachable(const hacktile::model::field&,
+		const hacktile::model::tile&, const hacktile::model::tileState&);
+public:
+	/// replayVerifier creates the verifier.
+	replayVerifier();
+	~replayVerifier();
+
+	/// verify verifies the placements of the cursor.
+	replayResult verify(const hacktile::model::replayHeader&,
+		hacktile::model::replayCursor);
+
+	/// verify verifies the replay file, and the file that
+	/// could not be read is unreadable.
+	replayResult verify(const char* path);
+}; // class hacktile::simulation::replayVerifier
+
+/**
+ * @brief verifyReplays verifies the replay files on a pool
+ * of worker threads, each with its own verifier, and the
+ * results are in the order of the paths.
+ *
+ * The files are taken by the workers one at a time, since
+ * the length of the replays varies a lot. The number of
+ * workers is the number of cores if it is 0.
+ */
+std::vector<replayResult> verifyReplays(
+	const std::vector<std::string>& paths, unsigned numWorkers = 0);
+
+} // namespace hacktile::simulation
+} // namespace hacktile
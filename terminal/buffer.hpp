@@ -0,0 +1,75 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file buffer.hpp
+ * @brief output buffer of the terminal.
+ * @author aegistudio
+ *
+ * This file provides the output buffer of the terminal, which
+ * retains its capacity across the flushes, and keeps the
+ * bytes that could not be written to a non-blocking file
+ * descriptor until it is writable again.
+ */
+#include <vector>
+#include <cstddef>
+
+namespace hacktile {
+namespace terminal {
+
+/**
+ * @brief outputBuffer is the buffer of the bytes pending
+ * to be written to the file descriptor.
+ *
+ * The bytes are appended after the pending ones, and the
+ * storage is only grown and never released, so that the
+ * buffer stops allocating once it is large enough for the
+ * largest frame.
+ */
+class outputBuffer {
+	std::vector<char> storage;
+	size_t head, tail;
+public:
+	/// outputBuffer creates the buffer with the capacity.
+	outputBuffer(size_t capacity = 4096):
+		storage(capacity), head(0), tail(0) {}
+
+	/// size returns the number of bytes pending.
+	size_t size() const { return tail - head; }
+
+	/// empty returns whether there's no byte pending.
+	bool empty() const { return head == tail; }
+
+	/// data returns the bytes pending.
+	const char* data() const { return storage.data() + head; }
+
+	/// capacity returns the size of the storage.
+	size_t capacity() const { return storage.size(); }
+
+	/// reserve returns the space for appending at least n
+	/// bytes, which is committed by commit.
+	char* reserve(size_t n);
+
+	/// commit marks the n bytes reserved as appended.
+	void commit(size_t n) { tail += n; }
+
+	/// append appends the bytes after the pending ones.
+	void append(const char* s, size_t n);
+
+	/// push appends a single byte.
+	void push(char c) {
+		*reserve(1) = c;
+		++ tail;
+	}
+
+	/// clear discards the bytes pending.
+	void clear() { head = tail = 0; }
+
+	/// writeTo writes the bytes pending to the file, and
+	/// returns whether all of them are written, or false if
+	/// the file would block. It throws runtime_error when
+	/// the file could not be written.
+	bool writeTo(int fd);
+}; // class hacktile::terminal::outputBuffer
+
+} // namespace hacktile::terminal
+} // namespace hacktile
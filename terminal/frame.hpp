@@ -0,0 +1,68 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file frame.hpp
+ * @brief frame scheduler of the terminal.
+ * @author aegistudio
+ *
+ * This file provides the frame scheduler, which limits how
+ * often the frames are composed and flushed, so that the
+ * states changed within a frame are displayed at once, and
+ * the states nobody could see are never rendered.
+ */
+#include <cstdint>
+
+namespace hacktile {
+namespace terminal {
+
+/**
+ * @brief frameScheduler decides when the next frame should
+ * be composed, with a timerfd for polling the frame time.
+ *
+ * The caller requests a frame whenever the content changes,
+ * and composes the frame once it is ready. When a frame is
+ * requested too soon after the previous one, the timer is
+ * armed at the time of the next frame, and the caller should
+ * poll the file descriptor for reading, and check whether the
+ * frame is ready once it is readable.
+ */
+class frameScheduler {
+	int timer;
+	uint64_t interval, lastFrame;
+	bool pending, armed;
+
+	// arm sets the timer to expire at the absolute time, or
+	// disarms the timer if the time is 0.
+	void arm(uint64_t time);
+public:
+	/// frameScheduler creates the scheduler of the refresh
+	/// rate in frames per second. It throws runtime_error if
+	/// the timer cannot be created.
+	frameScheduler(int refreshRate = 60);
+	~frameScheduler();
+	frameScheduler(const frameScheduler&) = delete;
+	frameScheduler& operator=(const frameScheduler&) = delete;
+
+	/// getFd returns the timer for polling.
+	int getFd() const { return timer; }
+
+	/// request marks the content changed, and a frame will
+	/// be ready no sooner than the interval after the last.
+	void request() { pending = true; }
+
+	/// isPending returns whether a frame is requested.
+	bool isPending() const { return pending; }
+
+	/// ready returns whether the frame requested should be
+	/// composed now, otherwise the timer is armed.
+	bool ready();
+
+	/// presented marks the frame composed at the moment.
+	void presented();
+
+	/// now returns the monotonic time in nanoseconds.
+	static uint64_t now();
+}; // class hacktile::terminal::frameScheduler
+
+} // namespace hacktile::terminal
+} // namespace hacktile
@@ -0,0 +1,93 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file hold.hpp
+ * @brief inference of the keys held in the terminal.
+ * @author aegistudio
+ *
+ * The terminal reports the keys pressed and repeated by the
+ * OS, but never the keys released. This file provides the
+ * tracker inferring the keys held from the repeats, and
+ * feeding them to the timing engine as held inputs.
+ */
+#include "model/timing.hpp"
+#include <cstdint>
+
+namespace hacktile {
+namespace terminal {
+
+/**
+ * @brief holdConfig specifies how long a key is held without
+ * being repeated, in ticks of the timing engine.
+ */
+struct holdConfig {
+	/// delay is the ticks a key is held after pressed until
+	/// the first repeat, which must be longer than the delay
+	/// of the OS before repeating, usually 250 to 600 ms.
+	uint64_t delay;
+
+	/// interval is the ticks a key is held after repeated
+	/// until the next repeat, which must be longer than the
+	/// interval of the OS between repeats.
+	uint64_t interval;
+
+	/// holdConfig creates the config longer than the common
+	/// keyboard settings.
+	holdConfig(): delay(model::ticksPerSecond * 13 / 20),
+		interval(model::ticksPerSecond / 10) {}
+};
+
+/**
+ * @brief holdTracker holds the inputs of the timing engine
+ * while their keys keep being repeated.
+ *
+ * The key pressed holds the input, and is released once it
+ * has not been repeated for the delay before the first
+ * repeat, or for the interval after that. The caller should
+ * release the keys due before advancing the engine, and wake
+ * up at the nextDeadline for the keys to be released.
+ */
+class holdTracker {
+	model::timingEngine& engine;
+	holdConfig config;
+
+	// The keys bound to the held inputs, indexed by input.
+	struct heldKey {
+		char key;
+		bool held;
+		uint64_t releaseAt;
+	};
+	static constexpr int numInputs = 3;
+	heldKey keys[numInputs];
+public:
+	/// never is the deadline when no key is held.
+	static constexpr uint64_t never = model::timingEngine::never;
+
+	/// holdTracker creates the tracker holding the inputs of
+	/// the engine, with no key bound.
+	holdTracker(model::timingEngine& engine,
+		const holdConfig& config = holdConfig());
+
+	/// bind binds the key to the held input.
+	void bind(char key, model::timingInput input);
+
+	/// press marks the key read at the tick, and returns
+	/// whether it is bound to a held input.
+	bool press(char key, uint64_t tick);
+
+	/// release releases the inputs whose keys are not
+	/// repeated in time until the tick.
+	void release(uint64_t tick);
+
+	/// isHeld returns whether the input is held.
+	bool isHeld(model::timingInput input) const {
+		return keys[int(input)].held;
+	}
+
+	/// nextDeadline returns the tick of the next key to be
+	/// released, or never if no key is held.
+	uint64_t nextDeadline() const;
+}; // class hacktile::terminal::holdTracker
+
+} // namespace hacktile::terminal
+} // namespace hacktile
@@ -0,0 +1,126 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file latency.hpp
+ * @brief latency instrumentation of the interactive path.
+ * @author aegistudio
+ *
+ * This file provides the latency histogram and the monitor
+ * measuring the latency from reading the input to the model
+ * events dispatched, the frame rendered and the frame
+ * written to the terminal, so that the regressions of the
+ * interactive path could be caught.
+ */
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+
+namespace hacktile {
+namespace terminal {
+
+/**
+ * @brief latencyHistogram records the latencies in buckets
+ * of bounded relative error, as the HDR histogram does.
+ *
+ * The values below 128 are recorded exactly, and larger
+ * values are recorded with 7 significant bits, which is an
+ * error below 1.6%. Values larger than maxValue are recorded
+ * as maxValue. Recording never allocates.
+ */
+class latencyHistogram {
+public:
+	/// subBits is the number of significant bits recorded.
+	static constexpr int subBits = 7;
+
+	/// maxValue is the largest value recorded.
+	static constexpr uint64_t maxValue = (uint64_t(1) << 40) - 1;
+
+	/// numBuckets is the number of buckets up to maxValue.
+	static constexpr size_t numBuckets =
+		(40 - subBits + 1) * (1 << (subBits - 1)) + (1 << (subBits - 1));
+private:
+	uint64_t counts[numBuckets];
+	uint64_t total, maximum;
+
+	// indexOf returns the bucket of the value.
+	static size_t indexOf(uint64_t value);
+
+	// highestOf returns the highest value in the bucket.
+	static uint64_t highestOf(size_t index);
+public:
+	latencyHistogram() { reset(); }
+
+	/// record adds the value to the histogram.
+	void record(uint64_t value);
+
+	/// reset removes all values.
+	void reset();
+
+	/// count returns the number of values recorded.
+	uint64_t count() const { return total; }
+
+	/// max returns the largest value recorded.
+	uint64_t max() const { return maximum; }
+
+	/// percentile returns the value that the fraction of
+	/// the values are equal to or below, or 0 if empty.
+	uint64_t percentile(double fraction) const;
+}; // class hacktile::terminal::latencyHistogram
+
+/**
+ * @brief latencyStage is the stage the latency is measured
+ * until since the input.
+ */
+enum class latencyStage {
+	dispatch,
+	render,
+	flush,
+	numStages,
+};
+
+/**
+ * @brief latencyMonitor measures the latency of the input
+ * through the stages, with the monotonic time provided
+ * by the caller in nanoseconds.
+ *
+ * The input is tracked from the earliest input not yet
+ * written to the terminal, and the stages are recorded
+ * for their first occurrence since then. The input is
+ * forgotten if it causes no model event.
+ */
+class latencyMonitor {
+	latencyHistogram histograms[size_t(latencyStage::numStages)];
+	uint64_t inputTime;
+	bool pending, dispatched, rendered;
+public:
+	latencyMonitor(): inputTime(0),
+		pending(false), dispatched(false), rendered(false) {}
+
+	/// input marks the input read at the time.
+	void input(uint64_t time);
+
+	/// dispatch marks a model event dispatched.
+	void dispatch(uint64_t time);
+
+	/// render marks a frame rendered.
+	void render(uint64_t time);
+
+	/// flush marks the frame written to the terminal.
+	void flush(uint64_t time);
+
+	/// idle marks no model event will be caused by the
+	/// inputs so far, which are forgotten if none has.
+	void idle();
+
+	/// histogram returns the histogram of the stage.
+	const latencyHistogram& histogram(latencyStage stage) const {
+		return histograms[size_t(stage)];
+	}
+
+	/// report writes the percentiles of the stages in
+	/// microseconds.
+	void report(std::ostream&) const;
+}; // class hacktile::terminal::latencyMonitor
+
+} // namespace hacktile::terminal
+} // namespace hacktile
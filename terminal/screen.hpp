@@ -0,0 +1,124 @@
+#pragma once
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file screen.hpp
+ * @brief double buffered cell grid of the terminal.
+ * @author aegistudio
+ *
+ * This file provides the screen model of the terminal, which
+ * keeps a back buffer of the cells to display and a front
+ * buffer of the cells displayed. Only the cells differing
+ * between them are rendered, so the views are free to paint
+ * the same content again without generating any output.
+ */
+#include "terminal/terminal.hpp"
+#include "terminal/buffer.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+namespace hacktile {
+namespace terminal {
+
+/**
+ * @brief cell is the content of a single column in the
+ * screen, with the glyph and the attributes to display.
+ */
+struct cell {
+	/// glyph is the UTF-8 encoded character, which must
+	/// take up one column, with unused bytes zeroed.
+	char glyph[4];
+
+	/// foreground and background are the colors of the
+	/// cell, and the background is only used if the
+	/// hasBackground is set.
+	uint8_t foreground, background;
+
+	/// decoration is the style of the cell.
+	style decoration;
+
+	/// hasBackground is whether the background is set.
+	bool hasBackground;
+
+	/// cell creates a blank cell, as the cleared screen.
+	cell(): glyph{' ', 0, 0, 0}, foreground(color::white),
+		background(color::black), decoration(style::reset),
+		hasBackground(false) {}
+
+	bool operator==(const cell& c) const {
+		return ::memcmp(this, &c, sizeof(cell)) == 0;
+	}
+
+	bool operator!=(const cell& c) const {
+		return !(*this == c);
+	}
+
+	/// sameAttributes is whether the cells are displayed
+	/// with the same colors and style.
+	bool sameAttributes(const cell& c) const {
+		return ::memcmp(&foreground, &c.foreground,
+			sizeof(cell) - sizeof(glyph)) == 0;
+	}
+};
+static_assert(sizeof(cell) == 8, "cell must be packed");
+
+/**
+ * @brief screen is the double buffered cell grid, whose
+ * coordinates are zero based, from the top left corner.
+ *
+ * The rows are tracked with the range of columns modified
+ * since the last render, so that rendering only compares
+ * the cells in the ranges. The cursor movements and style
+ * sequences are selected by the number of bytes to emit.
+ *
+ * The grid grows when cells outside are written, and the
+ * new cells are blank, as the screen is cleared initially.
+ */
+class screen {
+	int width, height;
+	std::vector<cell> front, back;
+
+	// The range of columns modified in each row, which is
+	// empty when dirtyBegin >= dirtyEnd.
+	std::vector<int> dirtyBegin, dirtyEnd;
+
+	// The cursor and attributes of the terminal, which are
+	// unknown if cursorValid or penValid is not set.
+	int cursorX, cursorY;
+	bool cursorValid, penValid;
+	cell pen;
+
+	void resize(int w, int h);
+	void moveCursor(outputBuffer& output, int x, int y);
+	void updatePen(outputBuffer& output, const cell& c);
+public:
+	/// screen creates the grid of specified size, which
+	/// is assumed to be cleared with the cursor at (0, 0).
+	screen(int width = 80, int height = 25);
+
+	/// getWidth and getHeight returns the size of the grid.
+	int getWidth() const { return width; }
+	int getHeight() const { return height; }
+
+	/// put updates the cell in the back buffer, and cells
+	/// at negative coordinates are discarded.
+	void put(int x, int y, const cell& c);
+
+	/// at returns the cell in the back buffer.
+	const cell& at(int x, int y) const {
+		return back[y * width + x];
+	}
+
+	/// render appends the sequences updating the terminal
+	/// from the front buffer to the back buffer, and the
+	/// front buffer is updated as rendered.
+	void render(outputBuffer& output);
+
+	/// invalidate forgets the content, cursor and style of
+	/// the terminal, so that the next render will repaint
+	/// every cell, e.g. after the terminal is garbled.
+	void invalidate();
+}; // class hacktile::terminal::screen
+
+} // namespace hacktile::terminal
+} // namespace hacktile
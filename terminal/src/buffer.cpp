@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file buffer.cpp
+ * @brief Implementation of the output buffer.
+ * @author aegistudio
+ *
+ * This file implements the output buffer, which moves the
+ * pending bytes to the front before growing the storage,
+ * and retries the short writes until the file would block.
+ */
+#include "terminal/buffer.hpp"
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace hacktile {
+namespace terminal {
+
+char* outputBuffer::reserve(size_t n) {
+	if(tail + n <= storage.size()) return &storage[tail];
+
+	// Reuse the space of the bytes written first, and only
+	// grow the storage when it is still not enough.
+	if(head > 0) {
+		std::memmove(storage.data(), storage.data() + head, tail - head);
+		tail -= head;
+		head = 0;
+	}
+	if(tail + n > storage.size()) {
+		size_t capacity = storage.size() * 2;
+		if(capacity < tail + n) capacity = tail + n;
+		storage.resize(capacity);
+	}
+	return &storage[tail];
+}
+
+void outputBuffer::append(const char* s, size_t n) {
+	if(n == 0) return;
+	std::memcpy(reserve(n), s, n);
+	tail += n;
+}
+
+bool outputBuffer::writeTo(int fd) {
+	while(head < tail) {
+		ssize_t written = ::write(fd, storage.data() + head, tail - head);
+		if(written < 0) {
+			if(errno == EINTR) continue;
+			if(errno == EAGAIN || errno == EWOULDBLOCK) return false;
+			std::stringstream error;
+			error << "cannot write to terminal: " << strerror(errno);
+			throw std::runtime_error(error.str());
+		}
+		head += size_t(written);
+	}
+	head = tail = 0;
+	return true;
+}
+
+} // namespace hacktile::terminal
+} // namespace hacktile
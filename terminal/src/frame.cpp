@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file frame.cpp
+ * @brief Implementation of the frame scheduler.
+ * @author aegistudio
+ *
+ * This file implements the frame scheduler with the timerfd
+ * of the monotonic clock, which is armed with the absolute
+ * time of the next frame only when a frame is deferred.
+ */
+#include "terminal/frame.hpp"
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <time.h>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace hacktile {
+namespace terminal {
+
+uint64_t frameScheduler::now() {
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec);
+}
+
+frameScheduler::frameScheduler(int refreshRate):
+	timer(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK|TFD_CLOEXEC)),
+	interval(1000000000ull / uint64_t(refreshRate > 0? refreshRate : 1)),
+	lastFrame(0), pending(false), armed(false) {
+	if(timer < 0) {
+		std::stringstream error;
+		error << "cannot create frame timer: " << strerror(errno);
+		throw std::runtime_error(error.str());
+	}
+}
+
+frameScheduler::~frameScheduler() {
+	close(timer);
+}
+
+void frameScheduler::arm(uint64_t time) {
+	itimerspec spec;
+	std::memset(&spec, 0, sizeof(spec));
+	spec.it_value.tv_sec = time_t(time / 1000000000ull);
+	spec.it_value.tv_nsec = long(time % 1000000000ull);
+	timerfd_settime(timer, TFD_TIMER_ABSTIME, &spec, nullptr);
+	armed = time != 0;
+}
+
+bool frameScheduler::ready() {
+	// Consume the expiration so that the timer will not be
+	// readable until it is armed again.
+	uint64_t expirations;
+	if(read(timer, &expirations, sizeof(expirations)) > 0) armed = false;
+	if(!pending) return false;
+	uint64_t current = now();
+	uint64_t due = lastFrame + interval;
+	if(current >= due) return true;
+	if(!armed) arm(due);
+	return false;
+}
+
+void frameScheduler::presented() {
+	lastFrame = now();
+	pending = false;
+	if(armed) arm(0);
+}
+
+} // namespace hacktile::terminal
+} // namespace hacktile
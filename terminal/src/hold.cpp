@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file hold.cpp
+ * @brief Implementation of the held keys inference.
+ * @author aegistudio
+ *
+ * This file implements the tracker holding the inputs of
+ * the timing engine until their keys stop repeating.
+ */
+#include "terminal/hold.hpp"
+#include <algorithm>
+
+namespace hacktile {
+namespace terminal {
+
+constexpr int holdTracker::numInputs;
+constexpr uint64_t holdTracker::never;
+
+holdTracker::holdTracker(model::timingEngine& engine,
+	const holdConfig& config): engine(engine), config(config) {
+	for(heldKey& k : keys) {
+		k.key = '\0';
+		k.held = false;
+		k.releaseAt = never;
+	}
+}
+
+void holdTracker::bind(char key, model::timingInput input) {
+	keys[int(input)].key = key;
+}
+
+bool holdTracker::press(char key, uint64_t tick) {
+	for(int i = 0; i < numInputs; ++ i) {
+		heldKey& k = keys[i];
+		if(k.key == '\0' || k.key != key) continue;
+
+		// The key arriving while held is a repeat, and will
+		// be repeated again sooner than the first time.
+		if(k.held) {
+			k.releaseAt = tick + config.interval;
+		} else {
+			engine.press(model::timingInput(i), tick);
+			k.held = true;
+			k.releaseAt = tick + config.delay;
+		}
+		return true;
+	}
+	return false;
+}
+
+void holdTracker::release(uint64_t tick) {
+	// Release the earliest key first, since the engine must
+	// not go back in time.
+	for(;;) {
+		int earliest = -1;
+		for(int i = 0; i < numInputs; ++ i) {
+			if(!keys[i].held || keys[i].releaseAt > tick) continue;
+			if(earliest < 0 || keys[i].releaseAt <
+				keys[earliest].releaseAt) earliest = i;
+		}
+		if(earliest < 0) break;
+		heldKey& k = keys[earliest];
+		engine.release(model::timingInput(earliest), k.releaseAt);
+		k.held = false;
+		k.releaseAt = never;
+	}
+}
+
+uint64_t holdTracker::nextDeadline() const {
+	uint64_t deadline = never;
+	for(const heldKey& k : keys)
+		if(k.held) deadline = std::min(deadline, k.releaseAt);
+	return deadline;
+}
+
+} // namespace hacktile::terminal
+} // namespace hacktile
@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file latency.cpp
+ * @brief Implementation of the latency instrumentation.
+ * @author aegistudio
+ *
+ * This file implements the log linear buckets of the latency
+ * histogram, and the tracking of the input through stages.
+ */
+#include "terminal/latency.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+
+namespace hacktile {
+namespace terminal {
+
+constexpr int latencyHistogram::subBits;
+constexpr uint64_t latencyHistogram::maxValue;
+constexpr size_t latencyHistogram::numBuckets;
+
+size_t latencyHistogram::indexOf(uint64_t value) {
+	// The values of 2^(e+6) to 2^(e+7) are in the buckets of
+	// exponent e, with 64 buckets per exponent.
+	const uint64_t half = uint64_t(1) << (subBits - 1);
+	if(value < (half << 1)) return size_t(value);
+	int exponent = 64 - __builtin_clzll(value) - subBits;
+	return size_t(exponent * half + (value >> exponent));
+}
+
+uint64_t latencyHistogram::highestOf(size_t index) {
+	const uint64_t half = uint64_t(1) << (subBits - 1);
+	if(index < (half << 1)) return index;
+	int exponent = int(index / half) - 1;
+	uint64_t mantissa = index - exponent * half;
+	return ((mantissa + 1) << exponent) - 1;
+}
+
+void latencyHistogram::record(uint64_t value) {
+	value = std::min(value, maxValue);
+	++ counts[indexOf(value)];
+	++ total;
+	maximum = std::max(maximum, value);
+}
+
+void latencyHistogram::reset() {
+	std::memset(counts, 0, sizeof(counts));
+	total = 0;
+	maximum = 0;
+}
+
+uint64_t latencyHistogram::percentile(double fraction) const {
+	if(total == 0) return 0;
+	uint64_t target = uint64_t(std::ceil(fraction * total));
+	if(target < 1) target = 1;
+	uint64_t seen = 0;
+	for(size_t i = 0; i < numBuckets; ++ i) {
+		seen += counts[i];
+		if(seen >= target) return std::min(highestOf(i), maximum);
+	}
+	return maximum;
+}
+
+void latencyMonitor::input(uint64_t time) {
+	if(pending) return;
+	pending = true;
+	dispatched = false;
+	rendered = false;
+	inputTime = time;
+}
+
+void latencyMonitor::dispatch(uint64_t time) {
+	if(!pending || dispatched) return;
+	histograms[size_t(latencyStage::dispatch)].record(time - inputTime);
+	dispatched = true;
+}
+
+void latencyMonitor::render(uint64_t time) {
+	if(!pending || !dispatched || rendered) return;
+	histograms[size_t(latencyStage::render)].record(time - inputTime);
+	rendered = true;
+}
+
+void latencyMonitor::flush(uint64_t time) {
+	if(!pending || !rendered) return;
+	histograms[size_t(latencyStage::flush)].record(time - inputTime);
+	pending = false;
+}
+
+void latencyMonitor::idle() {
+	if(pending && !dispatched) pending = false;
+}
+
+void latencyMonitor::report(std::ostream& out) const {
+	static const char* names[] = { "dispatch", "render", "flush" };
+	out << "stage       count     p50(us)   p99(us)   p999(us)  max(us)\n";
+	for(size_t i = 0; i < size_t(latencyStage::numStages); ++ i) {
+		const latencyHistogram& h = histograms[i];
+		out << std::left << std::setw(12) << names[i]
+			<< std::setw(10) << h.count() << std::fixed << std::setprecision(1)
+			<< std::setw(10) << h.percentile(0.5) / 1000.0
+			<< std::setw(10) << h.percentile(0.99) / 1000.0
+			<< std::setw(10) << h.percentile(0.999) / 1000.0
+			<< h.max() / 1000.0 << "\n";
+	}
+}
+
+} // namespace hacktile::terminal
+} // namespace hacktile
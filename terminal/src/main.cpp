@@ -15,14 +15,21 @@
 #include "model/tile.hpp"
 #include "model/generator.hpp"
 #include "model/playground.hpp"
+#include "model/timing.hpp"
+#include "util/defer.hpp"
 #include "terminal/terminal.hpp"
+#include "terminal/frame.hpp"
+#include "terminal/latency.hpp"
+#include "terminal/hold.hpp"
 #include "terminal/view/tile.hpp"
 #include <signal.h>
 #include <poll.h>
 #include <termios.h>
 #include <unistd.h>
 #include <cstring>
+#include <cstdlib>
 #include <iostream>
+#include <fstream>
 #include <memory>
 #include <random>
 #include <algorithm>
@@ -36,14 +43,18 @@ class mainPlaygroundView : public playgroundListener {
 	view::miniTileRenderer& preview;
 	terminal& term;
 	playground& play;
+	frameScheduler& frames;
+
+	// The sections changed since the last frame, which are
+	// repainted when the frame is composed.
+	bool fieldChanged, swapChanged, previewChanged;
 
 	void repaintOutline();
 	void repaintRangedField(uint8_t low, uint8_t high);
-	void repaintTileField(const tile&, tileState);
-	void repaintNewField(const tile&, tileState, tileState);
 	void repaintField() {
 		repaintRangedField(0, 20);
 	}
+	void repaintCurrentTile();
 	void repaintSwap();
 	void repaintPreview();
 public:
@@ -51,40 +62,45 @@ public:
 		view::fullTileRenderer& current,
 		view::fullTileRenderer& shadow,
 		view::miniTileRenderer& preview,
-		terminal& term, playground& play):
+		terminal& term, playground& play,
+		frameScheduler& frames):
 		current(current), shadow(shadow), preview(preview),
-		term(term), play(play) {
+		term(term), play(play), frames(frames),
+		fieldChanged(true), swapChanged(true), previewChanged(true) {
 		repaintOutline();
-		repaintField();
-		repaintSwap();
-		repaintPreview();
+		frames.request();
+	}
+
+	/// compose repaints the sections changed since the last
+	/// frame, with the latest state of the playground.
+	void compose() {
+		if(fieldChanged) {
+			repaintField();
+			repaintCurrentTile();
+		}
+		if(swapChanged) repaintSwap();
+		if(previewChanged) repaintPreview();
+		fieldChanged = swapChanged = previewChanged = false;
 	}
 
-	void tileSpawn(const tileSpawnEvent& event) {
-		repaintPreview();
-		repaintSwap();
-		repaintNewField(event.type,
-			event.location, event.locationShadow);
+	void tileSpawn(const tileSpawnEvent&) {
+		fieldChanged = swapChanged = previewChanged = true;
+		frames.request();
 	}
 
-	void tileSwap(const tileSwapEvent& event) {
-		repaintTileField(event.type, event.location);
-		repaintTileField(event.type, event.locationShadow);
-		repaintPreview();
-		repaintSwap();
+	void tileSwap(const tileSwapEvent&) {
+		fieldChanged = swapChanged = previewChanged = true;
+		frames.request();
 	}
 
 	void tileLock(const tileLockEvent&) {
-		repaintField();
-		repaintPreview();
-		repaintSwap();
+		fieldChanged = swapChanged = previewChanged = true;
+		frames.request();
 	}
 
-	void tileMove(const tileMoveEvent& event) {
-		repaintTileField(event.type, event.before);
-		repaintTileField(event.type, event.beforeShadow);
-		repaintNewField(event.type,
-			event.after, event.afterShadow);
+	void tileMove(const tileMoveEvent&) {
+		fieldChanged = true;
+		frames.request();
 	}
 };
 
@@ -200,42 +216,112 @@ void mainPlaygroundView::repaintRangedField(
 	current.renderField(term, play.getField(), low, high);
 }
 
-void mainPlaygroundView::repaintTileField(
-	const tile& type, tileState state) {
-	tileCoord leftBottom, rightTop;
-	type.retrieveBoundingBox(state.dir, leftBottom, rightTop);
-	repaintRangedField(state.y + leftBottom.y, state.y + rightTop.y);
-}
-
-void mainPlaygroundView::repaintNewField(
-	const tile& type, tileState state, tileState stateShadow) {
-	repaintTileField(type, state);
-	repaintTileField(type, stateShadow);
+void mainPlaygroundView::repaintCurrentTile() {
 	// TODO: move the relocating algorithm to another view.
+	const tile* type = play.getCurrentTile();
+	if(type == nullptr) return;
+	tileState stateShadow = play.getShadowState();
+	tileState state = play.getCurrentState();
 	term << pos(26+2*stateShadow.x, 24-stateShadow.y);
-	shadow.renderTile(term, type, stateShadow.dir, true);
+	shadow.renderTile(term, *type, stateShadow.dir, true);
 	term << pos(26+2*state.x, 24-state.y);
-	current.renderTile(term, type, state.dir, true);
+	current.renderTile(term, *type, state.dir, true);
 }
 
-int main(int argc, char** argv) {
-	// Initialize the terminal object for displaying.
-	terminal term(1);
+static void usage(const char* program) {
+	std::cerr << "Usage: " << program << " [options]\n"
+		"  -f <rate>       refresh rate in frames per second\n"
+		"  -l <level>      level of the gravity, or 0 for none\n"
+		"  -d <millis>     delayed auto shift\n"
+		"  -a <millis>     auto repeat rate, or 0 for instant\n"
+		"  -r <millis>     hold a key pressed until repeated for,\n"
+		"                  longer than the key repeat delay\n"
+		"  -i <millis>     hold a key repeated until repeated\n"
+		"                  again for, longer than the interval\n"
+		"  -m <file>       report input latency to the file on\n"
+		"                  exit and on SIGUSR1\n";
+}
 
-	// Initialize the tiles, in the order of the enum.
-	std::vector<tile> tiles;
-	for(uint8_t i = 1; i <= 7; ++ i) {
-		tileData data;
-		createTetrominoTileData(data, tetromino(i));
-		tileRotationTable kick;
-		createTetrominoRotation(kick, tetromino(i));
-		tiles.emplace_back(tile(data, kick));
+// latencyListener marks the model events dispatched.
+struct latencyListener : public playgroundListener {
+	latencyMonitor& monitor;
+	latencyListener(latencyMonitor& monitor): monitor(monitor) {}
+	void tileSpawn(const tileSpawnEvent&) { dispatched(); }
+	void tileMove(const tileMoveEvent&) { dispatched(); }
+	void tileLock(const tileLockEvent&) { dispatched(); }
+	void tileSwap(const tileSwapEvent&) { dispatched(); }
+	void dispatched() { monitor.dispatch(frameScheduler::now()); }
+};
+
+// reportRequested is set by SIGUSR1 for reporting latency.
+static volatile sig_atomic_t reportRequested = 0;
+static void requestReport(int) {
+	reportRequested = 1;
+}
+
+// writeReport writes the latency report to the file.
+static void writeReport(const latencyMonitor& monitor, const char* path) {
+	std::ofstream out(path, std::ios::trunc);
+	monitor.report(out);
+}
+
+// armTimer arms the timer at the absolute monotonic time
+// in nanoseconds, or disarms it if the time is 0.
+static void armTimer(int timer, uint64_t time) {
+	itimerspec spec;
+	memset(&spec, 0, sizeof(spec));
+	spec.it_value.tv_sec = time_t(time / 1000000000ull);
+	spec.it_value.tv_nsec = long(time % 1000000000ull);
+	timerfd_settime(timer, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+int main(int argc, char** argv) {
+	// Parse the options from the command line.
+	int refreshRate = 60;
+	int level = 1;
+	timingConfig timing;
+	holdConfig hold;
+	const char* reportPath = nullptr;
+	int opt;
+	while((opt = getopt(argc, argv, "f:l:d:a:r:i:m:h")) != -1) {
+		switch(opt) {
+		case 'f': refreshRate = atoi(optarg); break;
+		case 'l': level = atoi(optarg); break;
+		case 'd': timing.das = strtoull(optarg, nullptr, 0) * 1000; break;
+		case 'a': timing.arr = strtoull(optarg, nullptr, 0) * 1000; break;
+		case 'r': hold.delay = strtoull(optarg, nullptr, 0) * 1000; break;
+		case 'i': hold.interval = strtoull(optarg, nullptr, 0) * 1000; break;
+		case 'm': reportPath = optarg; break;
+		default:
+			usage(argv[0]);
+			return opt == 'h'? 0 : 1;
+		}
 	}
-	std::vector<const tile*> tilePointers;
-	for(uint8_t i = 1; i <= 7; ++ i) {
-		tilePointers.emplace_back(&tiles[i-1]);
+	if(refreshRate <= 0 || level < 0) {
+		usage(argv[0]);
+		return 1;
+	}
+	timing.gravity = level > 0? gravityOfLevel(level) : 0;
+	timing.softDropGravity = std::max(gravityOfLevel(level) / 20, uint64_t(1));
+
+	// Initialize the latency monitor, which reports after
+	// the terminal has been restored.
+	latencyMonitor monitor;
+	hacktile::util::defer reportOnExit([&] {
+		if(reportPath != nullptr) writeReport(monitor, reportPath);
+	});
+	if(reportPath != nullptr) {
+		struct sigaction action;
+		memset(&action, 0, sizeof(action));
+		action.sa_handler = requestReport;
+		sigaction(SIGUSR1, &action, nullptr);
 	}
 
+	// Initialize the terminal object for displaying, and
+	// the scheduler of the frames displayed.
+	terminal term(1);
+	frameScheduler frames(refreshRate);
+
 	// Initialize the tiles' palette, but viewed from the
 	// data in tile, not type of tile itself.
 	uint8_t paletteColor[8];
@@ -260,50 +346,115 @@ int main(int argc, char** argv) {
 	view::miniTileRenderer preview(paletteColor, 8);
 
 	// Initialize the game playground model for game.
-	tilePermutator permutator(tilePointers.data(), 7, 0);
+	tilePermutator permutator(tetrominoTiles(), 7, 0);
 	playground play(&permutator);
 
 	// Initialize the playground view of the game.
-	mainPlaygroundView playView(current, shadow, preview, term, play);
+	mainPlaygroundView playView(
+		current, shadow, preview, term, play, frames);
 	auto subscription = play.subscribe(&playView);
+	latencyListener latency(monitor);
+	auto latencySubscription = play.subscribe(&latency);
 
-	// Execute the main loop of the game.
+	// Initialize the timing engine driving the game, with
+	// the ticks counted from the start of the game.
 	play.start();
+	timingEngine engine(play, timing);
+	uint64_t startTime = frameScheduler::now();
+	auto currentTick = [&]() -> uint64_t {
+		return (frameScheduler::now() - startTime) / 1000;
+	};
+	int gameTimer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK|TFD_CLOEXEC);
+	if(gameTimer < 0) return -errno;
+	hacktile::util::defer closeGameTimer([&] { close(gameTimer); });
+	holdTracker holds(engine, hold);
+	holds.bind('4', timingInput::left);
+	holds.bind('6', timingInput::right);
+	holds.bind('8', timingInput::softDrop);
+
+	// Execute the main loop of the game.
 	while(1) {
-		// Flush out the content from terminal.
-		term.flush();
+		// Release the keys not repeated, and process the
+		// events of the timing engine until now.
+		uint64_t tick = currentTick();
+		holds.release(tick);
+		engine.advance(tick);
+
+		// Compose the frame once it is ready, so that all
+		// events since the last frame are rendered at once,
+		// and wait for the terminal to drain if it would
+		// block while flushing.
+		bool flushed = true;
+		if(frames.ready()) {
+			playView.compose();
+			monitor.render(frameScheduler::now());
+			frames.presented();
+			flushed = term.flush();
+		} else if(term.isPending()) flushed = term.flush();
+		if(flushed) monitor.flush(frameScheduler::now());
+
+		// Arm the game timer at the next event of the timing
+		// engine or the next key to release.
+		uint64_t deadline = std::min(
+			engine.nextDeadline(), holds.nextDeadline());
+		armTimer(gameTimer, deadline == timingEngine::never?
+			0 : startTime + deadline * 1000);
 
 		// Initialize the poll descriptor, including the
-		// user input and the timer.
-		pollfd fds[1];
+		// user input and the timers.
+		pollfd fds[3];
 		fds[0].fd = 1;
-		fds[0].events = POLLIN;
+		fds[0].events = flushed? POLLIN : POLLIN|POLLOUT;
 		fds[0].revents = 0;
+		fds[1].fd = frames.getFd();
+		fds[1].events = POLLIN;
+		fds[1].revents = 0;
+		fds[2].fd = gameTimer;
+		fds[2].events = POLLIN;
+		fds[2].revents = 0;
 
-		// Poll for more events in the loop.
-		if(poll(fds, 1, -1) < 0) return -errno;
+		// Poll for more events in the loop, which might be
+		// interrupted for reporting the latency.
+		if(poll(fds, 3, -1) < 0) {
+			if(errno != EINTR) return -errno;
+			if(reportRequested != 0 && reportPath != nullptr)
+				writeReport(monitor, reportPath);
+			reportRequested = 0;
+			continue;
+		}
+		if((fds[2].revents & POLLIN) != 0) {
+			uint64_t expirations;
+			read(gameTimer, &expirations, sizeof(expirations));
+		}
 
-		// Attempt to accept input from the input.
+		// Attempt to accept input from the input, and mark
+		// each key read for the latency, which is forgotten
+		// if it causes no model event.
 		if((fds[0].revents & POLLIN) != 0) {
 			char c[2048];
 			ssize_t len = read(1, c, sizeof(c));
-			if(len < 0) return -errno;
+			if(len < 0 && errno != EAGAIN && errno != EINTR)
+				return -errno;
+			if(len <= 0) continue;
+			uint64_t readTime = frameScheduler::now();
+			tick = currentTick();
+			holds.release(tick);
+			engine.advance(tick);
 			for(ssize_t i = 0; i < len; i ++) {
 				char k = c[i];
 				if(k == '\3') return 0; // Ctrl+C
-				switch(k) {
+				monitor.input(readTime);
+				if(!holds.press(k, tick)) switch(k) {
 				case 'q': play.swapTile(); break;
 				case 'd': play.rotateCW(); break;
 				case 'a': play.rotateCCW(); break;
 				case 'w': play.halfTurn(); break;
-				case '4': play.move(-1); break;
-				case '6': play.move(+1); break;
 				case '7': play.move(-10); break;
 				case '9': play.move(+10); break;
 				case '5': play.drop(+20); break;
-				case '8': play.drop(+1); break;
 				case 's': play.hardDrop(); break;
 				}
+				if(!frames.isPending()) monitor.idle();
 			}
 		}
 	}
@@ -0,0 +1,252 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/**
+ * @file screen.cpp
+ * @brief Implementation of the screen model.
+ * @author aegistudio
+ *
+ * This file implements the rendering of the screen, which
+ * compares the modified cells of both buffers and emits the
+ * changed ones, moving the cursor and updating the style in
+ * the cheapest way known to the renderer. The sequences are
+ * encoded right into the output buffer without formatting.
+ */
+#include "terminal/screen.hpp"
+#include <algorithm>
+
+namespace hacktile {
+namespace terminal {
+
+// digitsOf evaluates the number of decimal digits.
+static int digitsOf(int value) {
+	int digits = 1;
+	while(value >= 10) {
+		value /= 10;
+		++ digits;
+	}
+	return digits;
+}
+
+// decimalPairs is the digits of every two digit number,
+// for converting two digits at a time.
+static const char decimalPairs[] =
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+// writeDecimal writes the decimal of the non-negative value
+// and returns the end of the digits.
+static char* writeDecimal(char* p, int value) {
+	char* end = p + digitsOf(value);
+	char* q = end;
+	while(value >= 100) {
+		int pair = (value % 100) * 2;
+		value /= 100;
+		*(-- q) = decimalPairs[pair + 1];
+		*(-- q) = decimalPairs[pair];
+	}
+	if(value >= 10) {
+		*(-- q) = decimalPairs[value * 2 + 1];
+		*(-- q) = decimalPairs[value * 2];
+	} else *(-- q) = char('0' + value);
+	return end;
+}
+
+// appendSequence appends the control sequence with the
+// parameter, where the parameter 1 is omitted as default.
+static void appendSequence(outputBuffer& output,
+	int value, char command) {
+	char* begin = output.reserve(16);
+	char* p = begin;
+	*(p ++) = '\033';
+	*(p ++) = '[';
+	if(value != 1) p = writeDecimal(p, value);
+	*(p ++) = command;
+	output.commit(p - begin);
+}
+
+// sequenceLength evaluates the bytes of appendSequence.
+static int sequenceLength(int value) {
+	return value == 1? 3 : 3 + digitsOf(value);
+}
+
+// glyphLength evaluates the bytes of the glyph.
+static int glyphLength(const cell& c) {
+	int len = 0;
+	while(len < 4 && c.glyph[len] != 0) ++ len;
+	return len;
+}
+
+screen::screen(int width, int height): width(0), height(0),
+	cursorX(0), cursorY(0), cursorValid(true), penValid(false) {
+	resize(width, height);
+}
+
+void screen::resize(int w, int h) {
+	if(w <= width && h <= height) return;
+	w = std::max(w, width);
+	h = std::max(h, height);
+	std::vector<cell> newFront(w * h), newBack(w * h);
+	for(int y = 0; y < height; ++ y) {
+		std::copy(&front[y * width], &front[(y + 1) * width], &newFront[y * w]);
+		std::copy(&back[y * width], &back[(y + 1) * width], &newBack[y * w]);
+	}
+	front.swap(newFront);
+	back.swap(newBack);
+	dirtyBegin.resize(h, w);
+	dirtyEnd.resize(h, 0);
+	width = w;
+	height = h;
+}
+
+void screen::put(int x, int y, const cell& c) {
+	if(x < 0 || y < 0) return;
+	if(x >= width || y >= height) {
+		// Grow by half at least, so that writing the cells
+		// from left to right will not copy every time.
+		resize(x < width? width : std::max(x + 1, width + width / 2),
+			y < height? height : std::max(y + 1, height + height / 2));
+	}
+	// The foreground of the blank cells is invisible, so they
+	// are considered the same regardless of the foreground.
+	cell& target = back[y * width + x];
+	cell normalized = c;
+	if(c.glyph[0] == ' ' && c.glyph[1] == 0 && !c.hasBackground &&
+		(c.decoration == style::reset || c.decoration == style::highlight))
+		normalized.foreground = color::white;
+	if(target == normalized) return;
+	target = normalized;
+	dirtyBegin[y] = std::min(dirtyBegin[y], x);
+	dirtyEnd[y] = std::max(dirtyEnd[y], x + 1);
+}
+
+void screen::invalidate() {
+	// The blank glyph is never written by the views, so
+	// every cell will be considered changed.
+	cell unknown;
+	unknown.glyph[0] = 0;
+	std::fill(front.begin(), front.end(), unknown);
+	std::fill(dirtyBegin.begin(), dirtyBegin.end(), 0);
+	std::fill(dirtyEnd.begin(), dirtyEnd.end(), width);
+	cursorValid = false;
+	penValid = false;
+}
+
+void screen::moveCursor(outputBuffer& output, int x, int y) {
+	if(cursorValid && cursorX == x && cursorY == y) return;
+
+	// The absolute position omits the column when it is
+	// the first column.
+	int absolute = x == 0? 3 + digitsOf(y + 1) :
+		4 + digitsOf(y + 1) + digitsOf(x + 1);
+
+	// The relative movement might return to the first
+	// column with a carriage return, or overwrite the cells
+	// in between with their content when moving forward.
+	int dx = x - cursorX, dy = y - cursorY;
+	int vertical = dy == 0? 0 : sequenceLength(dy < 0? -dy : dy);
+	int horizontal = dx == 0? 0 : sequenceLength(dx < 0? -dx : dx);
+	if(x == 0 && dx != 0) horizontal = 1;
+	int overwrite = -1;
+	if(cursorValid && dy == 0 && dx > 0 && penValid) {
+		overwrite = 0;
+		for(int i = cursorX; i < x && overwrite >= 0; ++ i) {
+			const cell& c = front[y * width + i];
+			if(!c.sameAttributes(pen) || c.glyph[0] == 0) overwrite = -1;
+			else overwrite += glyphLength(c);
+		}
+	}
+	if(overwrite >= 0 && overwrite < horizontal) {
+		for(int i = cursorX; i < x; ++ i) {
+			const cell& c = front[y * width + i];
+			output.append(c.glyph, glyphLength(c));
+		}
+	} else if(cursorValid && vertical + horizontal <= absolute) {
+		if(dy != 0) appendSequence(output,
+			dy < 0? -dy : dy, dy < 0? 'A' : 'B');
+		if(x == 0 && dx != 0) output.push('\r');
+		else if(dx != 0) appendSequence(output,
+			dx < 0? -dx : dx, dx < 0? 'D' : 'C');
+	} else {
+		char* begin = output.reserve(32);
+		char* p = begin;
+		*(p ++) = '\033';
+		*(p ++) = '[';
+		p = writeDecimal(p, y + 1);
+		if(x > 0) {
+			*(p ++) = ';';
+			p = writeDecimal(p, x + 1);
+		}
+		*(p ++) = 'H';
+		output.commit(p - begin);
+	}
+	cursorX = x;
+	cursorY = y;
+	cursorValid = true;
+}
+
+void screen::updatePen(outputBuffer& output, const cell& c) {
+	if(penValid && pen.sameAttributes(c)) return;
+
+	// The attributes are reset when the style changes or
+	// the background is removed, otherwise only the colors
+	// changed are updated.
+	bool reset = !penValid || pen.decoration != c.decoration ||
+		(pen.hasBackground && !c.hasBackground);
+	char* buf = output.reserve(32);
+	int len = 0;
+	buf[len ++] = '\033';
+	buf[len ++] = '[';
+	if(reset) {
+		buf[len ++] = '0';
+		buf[len ++] = ';';
+		if(c.decoration != style::reset) {
+			buf[len ++] = '0' + uint8_t(c.decoration);
+			buf[len ++] = ';';
+		}
+	}
+	if(reset || pen.foreground != c.foreground) {
+		buf[len ++] = (c.foreground&color::bright)? '9' : '3';
+		buf[len ++] = '0' + (c.foreground & 0b0111);
+		buf[len ++] = ';';
+	}
+	if(c.hasBackground && (reset || !pen.hasBackground ||
+		pen.background != c.background)) {
+		if(c.background&color::bright) {
+			buf[len ++] = '1';
+			buf[len ++] = '0';
+		} else buf[len ++] = '4';
+		buf[len ++] = '0' + (c.background & 0b0111);
+		buf[len ++] = ';';
+	}
+	buf[len - 1] = 'm';
+	output.commit(len);
+	pen = c;
+	penValid = true;
+}
+
+void screen::render(outputBuffer& output) {
+	for(int y = 0; y < height; ++ y) {
+		for(int x = dirtyBegin[y]; x < dirtyEnd[y]; ++ x) {
+			cell& displayed = front[y * width + x];
+			const cell& c = back[y * width + x];
+			if(displayed == c) continue;
+			moveCursor(output, x, y);
+			updatePen(output, c);
+			output.append(c.glyph, glyphLength(c));
+			displayed = c;
+
+			// The cursor stays at the last column pending
+			// a wrap, where the terminals differ in moving
+			// it, so it is unknown until moved absolutely.
+			if(x + 1 >= width) cursorValid = false;
+			else ++ cursorX;
+		}
+		dirtyBegin[y] = width;
+		dirtyEnd[y] = 0;
+	}
+}
+
+} // namespace hacktile::terminal
+} // namespace hacktile
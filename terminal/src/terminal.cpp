@@ -10,13 +10,17 @@
  *
  * Currently a relatively naive interface is implemented,
  * which will provides a writer interface to flush the
- * current content out every loop, and the caller is able
- * to write out control characters on content. We might
+ * current content out every loop. The content is painted
+ * onto the screen model, which generates the control
+ * characters for the changed cells on flush. We might
  * switch to libuv in the future.
  */
 #include "util/defer.hpp"
 #include "terminal/terminal.hpp"
+#include "terminal/screen.hpp"
 #include <unistd.h>
+#include <fcntl.h>
+#include <algorithm>
 #include <sstream>
 #include <cstring>
 #include <stdexcept>
@@ -43,7 +47,8 @@ initializedTerminal::~initializedTerminal() {
 	tcsetattr(term, TCSANOW, &terminalMode);
 }
 
-newTerminal::newTerminal(int term): initializedTerminal(term) {
+newTerminal::newTerminal(int term):
+	initializedTerminal(term), output(-1) {
 	// Attempt to copy and modify the console mode.
 	termios newTerminalMode;
 	memcpy(&newTerminalMode, &terminalMode, sizeof(termios));
@@ -59,6 +64,23 @@ newTerminal::newTerminal(int term): initializedTerminal(term) {
 			<< strerror(errno);
 		throw std::runtime_error(error.str());
 	}
+
+	// Open the terminal again for non-blocking output, so
+	// that flushing to a slow terminal returns instead of
+	// stalling the game. The flags of the descriptor passed
+	// in are shared with the shell and left untouched.
+	const char* path = ttyname(term);
+	if(path != nullptr) output = open(path,
+		O_WRONLY|O_NOCTTY|O_NONBLOCK|O_CLOEXEC);
+	if(output < 0) {
+		std::stringstream error;
+		error << "cannot open terminal for output: "
+			<< strerror(errno);
+		throw std::runtime_error(error.str());
+	}
+}
+newTerminal::~newTerminal() {
+	close(output);
 }
 
 clearScreen::clearScreen(int term): newTerminal(term) {
@@ -73,131 +95,88 @@ clearScreen::clearScreen(int term): newTerminal(term) {
 	}
 }
 clearScreen::~clearScreen() {
-	// Clear screen data and reset the pointer.
+	// Clear screen data and reset the pointer, which is
+	// written in blocking mode so that it is not dropped.
 	char resetPointer[] = control "0;0H" control "?25h" control "2J";
 	write(term, resetPointer, sizeof(resetPointer));
 }
 }
 
 terminal::terminal(int term): clearScreen(term),
+	display(new screen()), cursorX(0), cursorY(0),
 	foregroundColor(color::white), backgroundColor(color::black),
-	currentStyle(style::reset), styleUpdated(true), hasBackground(false) {}
-
-void terminal::appendStyleSequence() {
-	char buf[15];
-	buf[0] = '\033';
-	buf[1] = '[';
-	buf[2] = '0' + uint8_t(currentStyle);
-	buf[3] = ';';
-	buf[4] = (foregroundColor&color::bright)? '9' : '3';
-	buf[5] = '0' + (foregroundColor & 0b0111);
-
-	// Terminate the case when there's no background.
-	if(!hasBackground) {
-		buf[6] = 'm';
-		buffer.insert(buffer.end(), &buf[0], &buf[7]);
-		return;
-	}
-	buf[6] = ';';
-
-	// Depending on whether the background is dark, we
-	// will append different sequence.
-	if(backgroundColor&color::bright) {
-		buf[7] = '1';
-		buf[8] = '0';
-		buf[9] = '0' + (backgroundColor & 0b0111);
-		buf[10] = 'm';
-		buffer.insert(buffer.end(), &buf[0], &buf[11]);
-	} else {
-		buf[7] = '4';
-		buf[8] = '0' + (backgroundColor & 0b0111);
-		buf[9] = 'm';
-		buffer.insert(buffer.end(), &buf[0], &buf[10]);
-	}
-}
+	currentStyle(style::reset), hasBackground(false) {}
+
+terminal::~terminal() {}
 
 terminal& terminal::operator<<(foreground fg) {
-	if(foregroundColor != fg.value) {
-		foregroundColor = fg.value;
-		styleUpdated = true;
-	}
+	foregroundColor = fg.value;
 	return *this;
 }
 
 terminal& terminal::operator<<(background bg) {
-	if(!hasBackground || backgroundColor != bg.value) {
-		backgroundColor = bg.value;
-		hasBackground = true;
-		styleUpdated = true;
-	}
+	backgroundColor = bg.value;
+	hasBackground = true;
 	return *this;
 }
 
 terminal& terminal::operator<<(style s) {
 	if(s == style::reset) {
-		if(hasBackground || foregroundColor != color::white) {
-			*this << "\033[0m"; // Simplify the reset precedure.
-			hasBackground = false;
-			backgroundColor = color::black;
-			foregroundColor = color::white;
-			styleUpdated = false;
-		}
-	}
-	if(currentStyle != s) {
-		currentStyle = s;
-		styleUpdated = true;
+		hasBackground = false;
+		backgroundColor = color::black;
+		foregroundColor = color::white;
 	}
+	currentStyle = s;
 	return *this;
 }
 
 terminal& terminal::operator<<(move m) {
-	if(m.x != 0) {
-		char buf[256];
-		buf[0] = '\033';
-		buf[1] = '[';
-		int len = snprintf(&buf[2], sizeof(buf)-2, "%d%c",
-			m.x < 0? -m.x:m.x, m.x < 0? 'D':'C');
-		buffer.insert(buffer.end(), &buf[0], &buf[len+2]);
-	}
-	if(m.y != 0) {
-		char buf[256];
-		buf[0] = '\033';
-		buf[1] = '[';
-		int len = snprintf(&buf[2], sizeof(buf)-2, "%d%c",
-			m.y < 0? -m.y:m.y, m.y < 0? 'A':'B');
-		buffer.insert(buffer.end(), &buf[0], &buf[len+2]);
-	}
+	// The cursor stops at the border as the terminal does.
+	cursorX = std::max(cursorX + m.x, 0);
+	cursorY = std::max(cursorY + m.y, 0);
 	return *this;
 }
 
 terminal& terminal::operator<<(pos p) {
-	if(p.x < 0) p.x = 0;
-	if(p.y < 0) p.y = 0;
-	char buf[256];
-	buf[0] = '\033';
-	buf[1] = '[';
-	int len = snprintf(&buf[2], sizeof(buf)-2,
-		"%d;%dH", p.y, p.x);
-	buffer.insert(buffer.end(), &buf[0], &buf[len+2]);
+	// The screen is zero based, while the terminal is one
+	// based and takes 0 as 1.
+	cursorX = std::max(p.x - 1, 0);
+	cursorY = std::max(p.y - 1, 0);
 	return *this;
 }
 
 void terminal::append(const char* s, size_t length) {
-	if(styleUpdated) {
-		appendStyleSequence();
-		styleUpdated = false;
+	cell c;
+	c.foreground = foregroundColor;
+	c.background = hasBackground? backgroundColor : uint8_t(color::black);
+	c.decoration = currentStyle;
+	c.hasBackground = hasBackground;
+	size_t i = 0;
+	while(i < length) {
+		// Decode the length of the UTF-8 character from its
+		// leading byte, and skip the control characters.
+		uint8_t lead = uint8_t(s[i]);
+		size_t n = lead < 0x80? 1 : lead < 0xe0? 2 : lead < 0xf0? 3 : 4;
+		if(lead < 0x20 || lead == 0x7f || i + n > length) {
+			++ i;
+			continue;
+		}
+		std::memset(c.glyph, 0, sizeof(c.glyph));
+		std::memcpy(c.glyph, &s[i], n);
+		display->put(cursorX, cursorY, c);
+		++ cursorX;
+		i += n;
 	}
-	buffer.insert(buffer.end(), &s[0], &s[length]);
 }
 
-void terminal::flush() {
-	if(write(term, buffer.data(), buffer.size()) != buffer.size()) {
-		std::stringstream error;
-		error << "cannot write to terminal: " << strerror(errno);
-		throw std::runtime_error(error.str());
-	} else {
-		buffer = std::vector<char>();
-	}
+bool terminal::flush() {
+	if(!buffer.writeTo(output)) return false;
+	display->render(buffer);
+	return buffer.writeTo(output);
+}
+
+void terminal::repaint() {
+	display->invalidate();
 }
 
 } // namespace hacktile::terminal
@@ -14,7 +14,9 @@
 #include <cstdint>
 #include <string>
 #include <cstring>
+#include <memory>
 #include <termios.h>
+#include "terminal/buffer.hpp"
 
 namespace hacktile {
 namespace terminal {
@@ -87,6 +89,8 @@ struct pos {
 	constexpr pos(int x, int y): x(x), y(y) {}
 };
 
+class screen;
+
 namespace details {
 struct initializedTerminal {
 	termios terminalMode;
@@ -95,7 +99,11 @@ struct initializedTerminal {
 	~initializedTerminal();
 };
 struct newTerminal: initializedTerminal {
+	// output is the terminal opened again for writing in
+	// non-blocking mode, whose flags are not shared.
+	int output;
 	newTerminal(int term);
+	~newTerminal();
 };
 struct clearScreen: newTerminal {
 	clearScreen(int term);
@@ -110,15 +118,23 @@ struct clearScreen: newTerminal {
  * This class initializes the screen subsystem, change the
  * current output style and location, and finally synchronize
  * the update to the player screen.
+ *
+ * The content is written into the screen model rather than
+ * the terminal, and only the cells changed since the last
+ * flush are sent to the terminal, so that repainting the
+ * same content is free. Each character must take up one
+ * column, and control characters are ignored.
  */
 class terminal: private details::clearScreen {
-	std::vector<char> buffer;
+	outputBuffer buffer;
+	std::unique_ptr<screen> display;
+	int cursorX, cursorY;
 	uint8_t foregroundColor, backgroundColor;
 	style currentStyle;
-	bool styleUpdated, hasBackground;
-	void appendStyleSequence();
+	bool hasBackground;
 public:
 	terminal(int term);
+	~terminal();
 	terminal& operator<<(foreground);
 	terminal& operator<<(background);
 	terminal& operator<<(move);
@@ -145,7 +161,23 @@ public:
 		return *this;
 	}
 
-	void flush();
+	/// flush sends the changed cells to the terminal, and
+	/// returns false if the terminal would block. The bytes
+	/// not written are sent first in the next flush, and
+	/// the cells are not rendered until then, so that the
+	/// frames are merged while the terminal is slow.
+	bool flush();
+
+	/// isPending returns whether there're bytes not written
+	/// in the last flush, and the caller should wait for the
+	/// terminal to be writable before flushing again.
+	bool isPending() const {
+		return !buffer.empty();
+	}
+
+	/// repaint sends every cell at the next flush, which
+	/// recovers the terminal garbled by other programs.
+	void repaint();
 };
 
 } // namespace hacktile::terminal
@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <gtest/gtest.h>
+#include "terminal/buffer.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+using namespace hacktile::terminal;
+
+TEST(Buffer, RetainCapacity) {
+	outputBuffer buffer(16);
+	std::string content(100, 'x');
+	buffer.append(content.data(), content.size());
+	buffer.push('y');
+	EXPECT_EQ(buffer.size(), 101);
+	size_t capacity = buffer.capacity();
+	EXPECT_GE(capacity, 101);
+
+	// Writing out the buffer must keep the storage.
+	int fds[2];
+	ASSERT_EQ(pipe(fds), 0);
+	EXPECT_TRUE(buffer.writeTo(fds[1]));
+	EXPECT_TRUE(buffer.empty());
+	EXPECT_EQ(buffer.capacity(), capacity);
+	std::vector<char> received(101);
+	ASSERT_EQ(read(fds[0], received.data(), received.size()), 101);
+	EXPECT_EQ(received.back(), 'y');
+	close(fds[0]);
+	close(fds[1]);
+}
+
+TEST(Buffer, WouldBlock) {
+	int fds[2];
+	ASSERT_EQ(pipe(fds), 0);
+	ASSERT_EQ(fcntl(fds[1], F_SETFL, O_NONBLOCK), 0);
+	int size = fcntl(fds[1], F_GETPIPE_SZ);
+	ASSERT_GT(size, 0);
+
+	// Fill more than the pipe could hold, and the bytes
+	// not written are kept in order.
+	outputBuffer buffer;
+	std::string content;
+	for(int i = 0; i < size + 1000; ++ i) content.push_back(char('a' + i % 26));
+	buffer.append(content.data(), content.size());
+	EXPECT_FALSE(buffer.writeTo(fds[1]));
+	EXPECT_EQ(buffer.size(), 1000);
+	buffer.append("!", 1);
+
+	// Drain the pipe and write the remaining bytes.
+	std::string received(size, 0);
+	ASSERT_EQ(read(fds[0], &received[0], size), size);
+	EXPECT_TRUE(buffer.writeTo(fds[1]));
+	std::string rest(1001, 0);
+	ASSERT_EQ(read(fds[0], &rest[0], 1001), 1001);
+	EXPECT_EQ(received + rest, content + "!");
+	close(fds[0]);
+	close(fds[1]);
+}
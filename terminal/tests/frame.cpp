@@ -0,0 +1,34 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <gtest/gtest.h>
+#include "terminal/frame.hpp"
+#include <poll.h>
+using namespace hacktile::terminal;
+
+TEST(Frame, Deferred) {
+	frameScheduler frames(50);
+	EXPECT_FALSE(frames.ready());
+	frames.request();
+	EXPECT_TRUE(frames.ready());
+	frames.presented();
+	EXPECT_FALSE(frames.isPending());
+
+	// The frame requested right after the previous one is
+	// deferred to the timer, with the requests coalesced.
+	frames.request();
+	frames.request();
+	uint64_t begin = frameScheduler::now();
+	EXPECT_FALSE(frames.ready());
+	pollfd fd;
+	fd.fd = frames.getFd();
+	fd.events = POLLIN;
+	fd.revents = 0;
+	ASSERT_EQ(poll(&fd, 1, 1000), 1);
+	EXPECT_TRUE(frames.ready());
+	EXPECT_GE(frameScheduler::now() - begin, 10000000ull);
+	frames.presented();
+
+	// The timer is not readable once the frame is presented.
+	fd.revents = 0;
+	EXPECT_EQ(poll(&fd, 1, 0), 0);
+	EXPECT_FALSE(frames.ready());
+}
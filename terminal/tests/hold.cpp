@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <gtest/gtest.h>
+#include "model/tetromino.hpp"
+#include "model/generator.hpp"
+#include "model/playground.hpp"
+#include "model/timing.hpp"
+#include "terminal/hold.hpp"
+using namespace hacktile::model;
+using namespace hacktile::terminal;
+
+// holdGame is the playground whose tile only shifts.
+struct holdGame {
+	tilePermutator permutator;
+	playground play;
+	std::unique_ptr<timingEngine> engine;
+
+	holdGame(): permutator(tetrominoTiles(), 7, 0),
+		play(&permutator) {
+		timingConfig config;
+		config.gravity = 0;
+		config.softDropGravity = 0;
+		config.das = 100000;
+		config.arr = 50000;
+		play.start();
+		engine.reset(new timingEngine(play, config));
+	}
+};
+
+TEST(Hold, RepeatGap) {
+	holdGame game;
+	holdConfig config;
+	config.delay = 650000;
+	config.interval = 100000;
+	holdTracker tracker(*game.engine, config);
+	tracker.bind('6', timingInput::right);
+	int8_t x = game.play.getCurrentState().x;
+	EXPECT_FALSE(tracker.press('5', 0));
+	EXPECT_EQ(tracker.nextDeadline(), holdTracker::never);
+
+	// The key is held through the delay of the OS before
+	// repeating, and shifts the tile after the das.
+	EXPECT_TRUE(tracker.press('6', 0));
+	EXPECT_EQ(game.play.getCurrentState().x, x + 1);
+	EXPECT_EQ(tracker.nextDeadline(), 650000);
+	tracker.release(400000);
+	game.engine->advance(400000);
+	EXPECT_TRUE(tracker.isHeld(timingInput::right));
+	EXPECT_NE(game.engine->nextDeadline(), timingEngine::never);
+	EXPECT_GT(game.play.getCurrentState().x, x + 1);
+
+	// The repeats keep the key held for the interval.
+	for(uint64_t tick = 400000; tick < 500000; tick += 33000) {
+		tracker.release(tick);
+		EXPECT_TRUE(tracker.press('6', tick));
+	}
+	EXPECT_EQ(tracker.nextDeadline(), 499000 + 100000);
+	tracker.release(598999);
+	EXPECT_TRUE(tracker.isHeld(timingInput::right));
+
+	// The key is released once the repeats stop, and the
+	// tile stops shifting.
+	tracker.release(700000);
+	EXPECT_FALSE(tracker.isHeld(timingInput::right));
+	EXPECT_EQ(tracker.nextDeadline(), holdTracker::never);
+	EXPECT_EQ(game.engine->getTime(), 599000);
+	EXPECT_EQ(game.engine->nextDeadline(), timingEngine::never);
+
+	// The key pressed again is not a repeat.
+	int8_t stopped = game.play.getCurrentState().x;
+	game.play.move(-stopped + x);
+	EXPECT_TRUE(tracker.press('6', 800000));
+	EXPECT_EQ(game.play.getCurrentState().x, x + 1);
+	EXPECT_EQ(tracker.nextDeadline(), 800000 + 650000);
+}
@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <gtest/gtest.h>
+#include "terminal/latency.hpp"
+#include <sstream>
+using namespace hacktile::terminal;
+
+TEST(Latency, Histogram) {
+	latencyHistogram h;
+	EXPECT_EQ(h.percentile(0.5), 0);
+	for(uint64_t v = 1; v <= 100000; ++ v) h.record(v * 1000);
+	EXPECT_EQ(h.count(), 100000);
+	EXPECT_EQ(h.max(), 100000000);
+
+	// The percentiles are within the relative error.
+	auto near = [](uint64_t actual, double expected) {
+		return std::abs(double(actual) - expected) <= expected / 64;
+	};
+	EXPECT_TRUE(near(h.percentile(0.5), 50000000.0));
+	EXPECT_TRUE(near(h.percentile(0.99), 99000000.0));
+	EXPECT_TRUE(near(h.percentile(0.999), 99900000.0));
+	EXPECT_EQ(h.percentile(1.0), 100000000);
+
+	// The small values are exact, and the large clamped.
+	latencyHistogram small;
+	for(uint64_t v = 0; v < 128; ++ v) small.record(v);
+	EXPECT_EQ(small.percentile(0.5), 63);
+	small.record(uint64_t(1) << 50);
+	EXPECT_EQ(small.max(), latencyHistogram::maxValue);
+	EXPECT_EQ(small.percentile(1.0), latencyHistogram::maxValue);
+	h.reset();
+	EXPECT_EQ(h.count(), 0);
+}
+
+TEST(Latency, Monitor) {
+	latencyMonitor m;
+	m.input(1000);
+	m.input(2000);
+	m.dispatch(3000);
+	m.dispatch(4000);
+	m.render(5000);
+	m.flush(9000);
+	EXPECT_EQ(m.histogram(latencyStage::dispatch).max(), 2000);
+	EXPECT_EQ(m.histogram(latencyStage::render).max(), 4000);
+	EXPECT_EQ(m.histogram(latencyStage::flush).max(), 8000);
+
+	// The input causing no event is forgotten, and events
+	// without input are not recorded.
+	m.input(10000);
+	m.idle();
+	m.dispatch(20000);
+	m.render(20000);
+	m.flush(20000);
+	EXPECT_EQ(m.histogram(latencyStage::flush).count(), 1);
+
+	std::stringstream report;
+	m.report(report);
+	EXPECT_NE(report.str().find("flush"), std::string::npos);
+}
@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+#include <gtest/gtest.h>
+#include "terminal/screen.hpp"
+#include <string>
+#include <vector>
+using namespace hacktile::terminal;
+
+// glyphCell creates the cell of the glyph and foreground.
+static cell glyphCell(const char* glyph, uint8_t fg = color::white) {
+	cell c;
+	std::memset(c.glyph, 0, sizeof(c.glyph));
+	std::memcpy(c.glyph, glyph, std::strlen(glyph));
+	c.foreground = fg;
+	return c;
+}
+
+// renderOf renders the screen into a string.
+static std::string renderOf(screen& s) {
+	outputBuffer output;
+	s.render(output);
+	return std::string(output.data(), output.size());
+}
+
+TEST(Screen, UnchangedCells) {
+	screen s;
+	EXPECT_EQ(renderOf(s), "");
+	s.put(0, 0, glyphCell("a"));
+	s.put(1, 0, glyphCell("b"));
+	EXPECT_EQ(renderOf(s), "\033[0;37mab");
+
+	// Painting the same content generates no output.
+	s.put(0, 0, glyphCell("a"));
+	s.put(1, 0, glyphCell("b"));
+	EXPECT_EQ(renderOf(s), "");
+
+	// Changing a cell and back generates no output.
+	s.put(0, 0, glyphCell("c"));
+	s.put(0, 0, glyphCell("a"));
+	EXPECT_EQ(renderOf(s), "");
+}
+
+TEST(Screen, CursorMovement) {
+	screen s;
+	s.put(0, 0, glyphCell("a"));
+	EXPECT_EQ(renderOf(s), "\033[0;37ma");
+
+	// Skipping a blank cell overwrites it.
+	s.put(2, 0, glyphCell("b"));
+	EXPECT_EQ(renderOf(s), " b");
+
+	// Moving far away uses the shorter sequence.
+	s.put(40, 0, glyphCell("c"));
+	EXPECT_EQ(renderOf(s), "\033[37Cc");
+	s.put(40, 1, glyphCell("d"));
+	EXPECT_EQ(renderOf(s), "\033[B\033[Dd");
+	s.put(0, 2, glyphCell("e"));
+	EXPECT_EQ(renderOf(s), "\033[B\re");
+	s.put(30, 20, glyphCell("f"));
+	EXPECT_EQ(renderOf(s), "\033[21;31Hf");
+
+	// The cursor is unknown after the last column.
+	s.put(s.getWidth() - 1, 21, glyphCell("g"));
+	s.put(0, 22, glyphCell("h"));
+	EXPECT_EQ(renderOf(s), "\033[B\033[48Cg\033[23Hh");
+
+	// The cursor is unknown after invalidating.
+	s.invalidate();
+	std::string output = renderOf(s);
+	EXPECT_EQ(output.substr(0, 11), "\033[1H\033[0;37m");
+	EXPECT_EQ(renderOf(s), "");
+}
+
+TEST(Screen, Attributes) {
+	screen s;
+	s.put(0, 0, glyphCell("\xe2\x96\x88", color::red));
+	s.put(1, 0, glyphCell("\xe2\x96\x88", color::bright|color::red));
+	cell c = glyphCell("\xe2\x96\x84", color::red);
+	c.hasBackground = true;
+	c.background = color::blue;
+	s.put(2, 0, c);
+	s.put(3, 0, glyphCell("x", color::red));
+	EXPECT_EQ(renderOf(s),
+		"\033[0;31m\xe2\x96\x88"
+		"\033[91m\xe2\x96\x88"
+		"\033[31;44m\xe2\x96\x84"
+		"\033[0;31mx");
+}
+
+TEST(Screen, Growing) {
+	screen s(4, 2);
+	s.put(9, 5, glyphCell("a"));
+	EXPECT_GE(s.getWidth(), 10);
+	EXPECT_GE(s.getHeight(), 6);
+	EXPECT_EQ(s.at(9, 5), glyphCell("a"));
+	EXPECT_EQ(s.at(0, 0), cell());
+	s.put(-1, 0, glyphCell("b"));
+	EXPECT_EQ(renderOf(s), "\033[6;10H\033[0;37ma");
+}
+
+TEST(Screen, Encoding) {
+	screen s;
+	s.put(0, 149, glyphCell("a"));
+	EXPECT_EQ(renderOf(s), "\033[149B\033[0;37ma");
+	s.put(1235, 149, glyphCell("b"));
+	EXPECT_EQ(renderOf(s), "\033[1234Cb");
+	s.put(5, 9, glyphCell("c"));
+	EXPECT_EQ(renderOf(s), "\033[10;6Hc");
+	s.put(99, 99, glyphCell("d"));
+	EXPECT_EQ(renderOf(s), "\033[90B\033[93Cd");
+}
+
+TEST(Screen, BlankCells) {
+	screen s;
+	s.put(0, 0, glyphCell(" ", color::red));
+	EXPECT_EQ(renderOf(s), "");
+	EXPECT_EQ(s.at(0, 0), cell());
+}
@@ -26,7 +26,9 @@ class eventRegistry;
  * XXX: This class is not multithread safe, and since
  * hacktile is not designed for working under multithreaded
  * environment, it is safe for now (actually it is hard to
- * write this class in multithreaded manner).
+ * write this class in multithreaded manner). Registries and
+ * subscriptions confined to a single thread, e.g. those of
+ * the simulation workers, are still safe to use.
  */
 template<typename handlerType>
 class eventSubscription {